@@ -8,6 +8,7 @@
 // ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 #include "CBlockReader.h"
 #include "CParseCSV.h"
+#include "CTelemetryRecorder.h"
 #include <cmath>
 #include "DebugLog.hpp"
 
@@ -85,6 +86,7 @@ void CBlockReader::LoadImgFromFile(string imagePath)
 	else
 	{
 		resize(image_fullsize, m_Image, Size(), 0.2, 0.2, INTER_AREA);
+		CTelemetryRecorder::NoteCameraFrame(imagePath);
 	}
 }
 
@@ -0,0 +1,123 @@
+/*
+ * CBoundedQueue.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CBOUNDEDQUEUE_H_
+#define SRC_CBOUNDEDQUEUE_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a first in, first out queue for passing items between threads, holding at most a fixed
+ * number of items.
+ *
+ * Push blocks while the queue is full and Pop blocks while it is empty, so a producer can never get
+ * more than the capacity ahead of its consumer. Once the queue is closed nothing more can be pushed,
+ * and Pop returns false when the remaining items have been taken.
+ *
+ * The whole class is in the header because it is templated.
+ *
+ * Public Constructors:
+ *    - CBoundedQueue(capacity) - An empty queue holding at most capacity (at least one) items.
+ *
+ * Public Methods:
+ *    - Push(item) - Adds an item, waiting for space. Returns false if the queue is closed.
+ *    - Pop(item) - Takes the oldest item, waiting for one. Returns false if the queue is closed
+ *    	and empty.
+ *    - TryPop(item) - As Pop, but returns false straight away if the queue is empty.
+ *    - Close() - Closes the queue and wakes everything waiting on it.
+ *    - Size/GetCapacity/IsClosed - The state of the queue.
+ *
+ */
+template<typename T>
+class CBoundedQueue
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CBoundedQueue(std::size_t capacity)
+			: m_capacity { capacity > 0 ? capacity : 1 }, m_closed { false }
+	{
+	}
+
+	CBoundedQueue(const CBoundedQueue&) = delete;
+	CBoundedQueue& operator=(const CBoundedQueue&) = delete;
+
+	// === Public Functions =========================================================================
+	bool Push(T item)
+	{
+		std::unique_lock<std::mutex> lock { m_mutex };
+		m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+		if (m_closed)
+			return false;
+
+		m_items.push_back(std::move(item));
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	bool Pop(T& item)
+	{
+		std::unique_lock<std::mutex> lock { m_mutex };
+		m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+		return Take(item);
+	}
+
+	bool TryPop(T& item)
+	{
+		std::lock_guard<std::mutex> lock { m_mutex };
+		return Take(item);
+	}
+
+	void Close()
+	{
+		std::lock_guard<std::mutex> lock { m_mutex };
+		m_closed = true;
+		m_notFull.notify_all();
+		m_notEmpty.notify_all();
+	}
+
+	// Access functions
+	std::size_t Size() const
+	{
+		std::lock_guard<std::mutex> lock { m_mutex };
+		return m_items.size();
+	}
+	std::size_t GetCapacity() const {return m_capacity;}
+	bool IsClosed() const
+	{
+		std::lock_guard<std::mutex> lock { m_mutex };
+		return m_closed;
+	}
+
+private:
+	// === Private Functions ========================================================================
+	// Takes the oldest item, if there is one. The mutex must be held.
+	bool Take(T& item)
+	{
+		if (m_items.empty())
+			return false;
+
+		item = std::move(m_items.front());
+		m_items.pop_front();
+		m_notFull.notify_one();
+		return true;
+	}
+
+	// === Member Variables =========================================================================
+	const std::size_t m_capacity;
+	std::deque<T> m_items;
+	bool m_closed;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_notFull;
+	std::condition_variable m_notEmpty;
+};
+
+#endif /* SRC_CBOUNDEDQUEUE_H_ */
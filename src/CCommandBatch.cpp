@@ -0,0 +1,167 @@
+/*
+ * CCommandBatch.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CCommandBatch.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CCommandBatch::CCommandBatch()
+		: m_resultLength { 0 }, m_sent { false }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds a command to the batch, with the same arguments as its own frame.
+ *
+ * INPUTS:
+ * command          - The command to add.
+ * arg1, arg2, arg3 - Its arguments.
+ *
+ * OUTPUT:
+ * The index of the command in the batch, for GetResult.
+ *
+ * Throws Exception_NotBatchable if the command does not reply at once, and Exception_BatchFull if
+ * the batch already has PIC_BATCH_LENGTH commands.
+ *
+ */
+unsigned int CCommandBatch::Add(command_t command, uint16_t arg1, uint16_t arg2, uint16_t arg3)
+{
+	DEBUG_METHOD();
+
+	bool isState = static_cast<int>(command) >= STOPPED && static_cast<int>(command) <= PSNS_REV_RIGHT;
+	if (isState || command == WRITE_ROUTE || command == FLUSH_MOTIONS || command == BATCH)
+		throw Exception_NotBatchable(command);
+
+	// Adding to a batch already sent starts a new one
+	if (m_sent)
+		Clear();
+	if (GetCount() >= PIC_BATCH_LENGTH)
+		throw Exception_BatchFull(GetCount());
+
+	m_commands.insert(m_commands.end(), { static_cast<uint16_t>(command), arg1, arg2, arg3 });
+	m_resultOffsets.push_back(m_resultLength);
+	m_resultLengths.push_back(ResultLength(command, arg1));
+	m_resultLength += m_resultLengths.back();
+
+	return GetCount() - 1;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds the commands to set the speed of both motors.
+ */
+void CCommandBatch::SetMotorSpeeds(uint16_t leftSpeed, motor_direction_t leftDirection, uint16_t rightSpeed, motor_direction_t rightDirection)
+{
+	DEBUG_METHOD();
+
+	Add(WRITE_MOTOR_LEFT, leftSpeed, leftDirection);
+	Add(WRITE_MOTOR_RIGHT, rightSpeed, rightDirection);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds the command to read an encoder (as pic_read_encoder_left/right), giving its
+ * index. The result is the count as an int16_t.
+ */
+unsigned int CCommandBatch::ReadEncoder(bool left, bool reset)
+{
+	DEBUG_METHOD();
+
+	return Add(left ? READ_ECDR1_SUM : READ_ECDR2_SUM, reset ? 1 : 0);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds the command to read the compass, giving its index.
+ */
+unsigned int CCommandBatch::ReadCompass()
+{
+	DEBUG_METHOD();
+
+	return Add(READ_COMP);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function sends the batch to the PIC in one transaction and reads the results. Sending an
+ * empty batch does nothing.
+ */
+void CCommandBatch::Send()
+{
+	DEBUG_METHOD();
+
+	m_results.assign(m_resultLength, 0);
+	if (GetCount() > 0)
+		pic_write_batch(m_commands.data(), GetCount(), m_results.data(), m_resultLength);
+	m_sent = true;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function gives a result word of the command at index. Throws Exception_NoResult if the
+ * batch has not been sent, or the command has no such word.
+ */
+uint16_t CCommandBatch::GetResult(unsigned int index, unsigned int word) const
+{
+	DEBUG_METHOD();
+
+	if (!m_sent || index >= GetCount() || word >= m_resultLengths[index])
+		throw Exception_NoResult(index);
+
+	return m_results[m_resultOffsets[index] + word];
+}
+
+void CCommandBatch::Clear()
+{
+	DEBUG_METHOD();
+
+	m_commands.clear();
+	m_resultOffsets.clear();
+	m_resultLengths.clear();
+	m_resultLength = 0;
+	m_results.clear();
+	m_sent = false;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function gives the number of result words a command reads: arg1 samples for the
+ * photosensors, the status and words completed for the route progress, a whole sensor frame,
+ * one word for the other reads and none for writes.
+ */
+unsigned int CCommandBatch::ResultLength(command_t command, uint16_t arg1)
+{
+	switch (command)
+	{
+	case READ_GRABBER:
+	case READ_MOTOR_LEFT:
+	case READ_MOTOR_RIGHT:
+	case READ_ECDR1:
+	case READ_ECDR1_SUM:
+	case READ_ECDR2:
+	case READ_ECDR2_SUM:
+	case READ_COMP:
+	case READ_DIP:
+	case READ_ROOM:
+		return 1;
+	case READ_PSNS1:
+	case READ_PSNS2:
+	case READ_PSNS3:
+	case READ_PSNS4:
+	case READ_PSNS5:
+	case READ_PSNS6:
+	case READ_PSNSFNT:
+	case READ_PSNSCBE:
+		return arg1;
+	case READ_ROUTE_PROGRESS:
+		return 2;
+	case READ_SENSOR_FRAME:
+		return SENSOR_FRAME_WORDS;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,94 @@
+/*
+ * CCommandBatch.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CCOMMANDBATCH_H_
+#define SRC_CCOMMANDBATCH_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "pic_enums.h"
+#include "pi_spi.h"
+#include <cstdint>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to send several PIC commands in one SPI transaction (a BATCH), rather than one
+ * handshake each.
+ *
+ * A control cycle such as setting both motors, reading both encoders and reading the compass is
+ * five handshakes (21 transfers) sent one at a time, but one handshake (6 transfers) as a batch.
+ * The PIC runs the commands in the order they were added, and the results of all the reads come
+ * back together.
+ *
+ * Only commands which reply at once can be batched: motions (states), routes, FLUSH_MOTIONS and
+ * batches themselves cannot.
+ *
+ * Public Methods:
+ *    - Add(command, arg1, arg2, arg3) - Adds a command, giving its index in the batch.
+ *    - SetMotorSpeeds(...), ReadEncoder(...), ReadCompass() - Add the usual commands.
+ *    - Send() - Sends the batch and reads the results.
+ *    - GetResult(index, word) - A result word of the command at index, once sent.
+ *    - Clear() - Empties the batch, so it can be filled again.
+ *    - GetCount/GetResultLength - The commands added and the result words they will read.
+ *    - ResultLength(command, arg1) - The result words read by a command.
+ *
+ */
+class CCommandBatch
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CCommandBatch();
+
+	// === Public Functions =========================================================================
+	unsigned int Add(command_t command, uint16_t arg1 = 0, uint16_t arg2 = 0, uint16_t arg3 = 0);
+	void SetMotorSpeeds(uint16_t leftSpeed, motor_direction_t leftDirection, uint16_t rightSpeed, motor_direction_t rightDirection);
+	unsigned int ReadEncoder(bool left, bool reset);
+	unsigned int ReadCompass();
+	void Send();
+	uint16_t GetResult(unsigned int index, unsigned int word = 0) const;
+	void Clear();
+	static unsigned int ResultLength(command_t command, uint16_t arg1);
+
+	// Access functions
+	unsigned int GetCount() const {return m_resultOffsets.size();}
+	unsigned int GetResultLength() const {return m_resultLength;}
+
+	// === Exceptions ===============================================================================
+	struct Exception_NotBatchable
+	{
+		uint16_t mm_command;
+		explicit Exception_NotBatchable(uint16_t command)
+				: mm_command { command }
+		{
+		}
+	};
+	struct Exception_BatchFull
+	{
+		unsigned int mm_length;
+		explicit Exception_BatchFull(unsigned int length)
+				: mm_length { length }
+		{
+		}
+	};
+	struct Exception_NoResult
+	{
+		unsigned int mm_index;
+		explicit Exception_NoResult(unsigned int index)
+				: mm_index { index }
+		{
+		}
+	};
+
+private:
+	// === Member Variables =========================================================================
+	std::vector<uint16_t> m_commands;				// 4 words per command
+	std::vector<unsigned int> m_resultOffsets;		// First result word of each command
+	std::vector<unsigned int> m_resultLengths;		// Result words of each command
+	unsigned int m_resultLength;					// Result words of the whole batch
+	std::vector<uint16_t> m_results;
+	bool m_sent;
+};
+
+#endif /* SRC_CCOMMANDBATCH_H_ */
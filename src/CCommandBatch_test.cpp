@@ -0,0 +1,134 @@
+/*
+ * CCommandBatch_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CCommandBatch.h"
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include "pi_spi.h"
+#include <cstdint>
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that a control cycle (set both motors, read both encoders and the compass) sent as one batch
+// gives the same results as sending each command on its own, in fewer transfers, and that commands
+// which cannot be batched are refused
+int CCommandBatch_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CCommandBatch_test--\n\n";
+
+	int result = 0;
+
+	CPicEmulator pic;
+	pic.Attach();
+
+	// Move the encoders and compass away from zero
+	CGoodsOut::Forward(600, false);
+	CGoodsOut::TurnRight90();
+
+	// -- One command at a time -- //
+	unsigned int transfers = pic.GetTransferCount();
+	reset_spi_latency_stats();
+	pic_set_left_motor_speed(300, MOT_FWD);
+	pic_set_right_motor_speed(250, MOT_REV);
+	int32_t left = pic_read_encoder_left(0);
+	int32_t right = pic_read_encoder_right(0);
+	float compass = pic_read_compass();
+	unsigned int singleTransfers = pic.GetTransferCount() - transfers;
+	unsigned int singleHandshakes = get_spi_latency_stats(WRITE_MOTOR_LEFT).count + get_spi_latency_stats(WRITE_MOTOR_RIGHT).count
+			+ get_spi_latency_stats(READ_ECDR1_SUM).count + get_spi_latency_stats(READ_ECDR2_SUM).count
+			+ get_spi_latency_stats(READ_COMP).count;
+
+	// -- The same cycle as one batch -- //
+	pic_set_left_motor_speed(0, MOT_FWD);
+	pic_set_right_motor_speed(0, MOT_FWD);
+	transfers = pic.GetTransferCount();
+	reset_spi_latency_stats();
+
+	CCommandBatch batch;
+	batch.SetMotorSpeeds(300, MOT_FWD, 250, MOT_REV);
+	unsigned int leftIndex = batch.ReadEncoder(true, false);
+	unsigned int rightIndex = batch.ReadEncoder(false, false);
+	unsigned int compassIndex = batch.ReadCompass();
+	batch.Send();
+	unsigned int batchTransfers = pic.GetTransferCount() - transfers;
+	unsigned int batchHandshakes = get_spi_latency_stats(BATCH).count;
+
+	if (pic.GetMotorSpeed(true) != 300 || pic.GetMotorSpeed(false) != -250)
+	{
+		cout << "Motor speeds were not set by the batch\n";
+		result = 1;
+	}
+	if (static_cast<int16_t>(batch.GetResult(leftIndex)) != left || static_cast<int16_t>(batch.GetResult(rightIndex)) != right
+			|| batch.GetResult(compassIndex) != compass || left != 100)
+	{
+		cout << "Batch results did not match the single reads\n";
+		result = 1;
+	}
+	if (batchTransfers >= singleTransfers || batchHandshakes != 1)
+	{
+		cout << "Batch did not save transfers\n";
+		result = 1;
+	}
+	cout << "Control cycle: " << singleTransfers << " transfers in " << singleHandshakes << " handshakes one at a time, "
+			<< batchTransfers << " transfers in " << batchHandshakes << " as a batch\n";
+
+	// A batch of writes only is answered with DONE
+	batch.Clear();
+	batch.Add(WRITE_LED, GREEN, 0);
+	batch.Send();
+	if (pic.GetLed() != GREEN || batch.GetResultLength() != 0)
+	{
+		cout << "Batch of writes failed\n";
+		result = 1;
+	}
+
+	// -- Refused commands -- //
+	try
+	{
+		batch.Add(FLUSH_MOTIONS);
+		cout << "FLUSH_MOTIONS was batched\n";
+		result = 1;
+	}
+	catch (CCommandBatch::Exception_NotBatchable& e)
+	{
+	}
+
+	batch.Clear();
+	try
+	{
+		for (unsigned int i = 0; i <= PIC_BATCH_LENGTH; ++i)
+			batch.ReadCompass();
+		cout << "Batch was overfilled\n";
+		result = 1;
+	}
+	catch (CCommandBatch::Exception_BatchFull& e)
+	{
+	}
+
+	try
+	{
+		batch.GetResult(0);
+		cout << "Result was read before sending\n";
+		result = 1;
+	}
+	catch (CCommandBatch::Exception_NoResult& e)
+	{
+	}
+
+	pic.Detach();
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,233 @@
+/*
+ * CCostModel.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CCostModel.h"
+#include "CParseCSV.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+
+// -/-/-/-/-/-/-/ SMotionProfile /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+SMotionProfile::SMotionProfile(double maxSpeed, double acceleration, double turnDuration, double commandOverhead)
+		: m_maxSpeed { maxSpeed }, m_acceleration { acceleration }, m_turnDuration { turnDuration },
+		  m_commandOverhead { commandOverhead }
+{
+}
+
+
+// -/-/-/-/-/-/-/ CCostModel /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+const CCostModel& CCostModel::Default()
+{
+	static const CUnitCostModel unitCostModel;
+	return unitCostModel;
+}
+
+
+// -/-/-/-/-/-/-/ CMotionTimeCostModel /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CMotionTimeCostModel::CMotionTimeCostModel(const SMotionProfile& profile)
+		: m_profile { profile }
+{
+	DEBUG_METHOD();
+}
+
+double CMotionTimeCostModel::StraightCost() const
+{
+	return ROOMLENGTH / m_profile.m_maxSpeed;
+}
+
+double CMotionTimeCostModel::CornerCost() const
+{
+	// A run driven from rest to rest takes its length at cruising speed, plus the time lost speeding
+	// up and slowing down, plus the overhead of its command; each corner ends one run
+	double runEnd = m_profile.m_maxSpeed/m_profile.m_acceleration + m_profile.m_commandOverhead;
+
+	return HALFROOMLENGTH/m_profile.m_maxSpeed + runEnd
+			+ CommandTime({ EMotion_Forward, HALFROOMLENGTH, true }) + CommandTime({ EMotion_TurnLeft90, 0, false });
+}
+
+double CMotionTimeCostModel::SpotTurnCost() const
+{
+	return CommandTime({ EMotion_TurnLeft90, 0, false });
+}
+
+double CMotionTimeCostModel::CommandTime(const SMotion& motion) const
+{
+	if (motion.m_type == EMotion_Forward)
+		return m_profile.m_commandOverhead + RestToRestTime(motion.m_distance, m_profile.m_maxSpeed, m_profile.m_acceleration);
+
+	return m_profile.m_commandOverhead + m_profile.m_turnDuration;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function fits a motion profile to recorded motion commands.
+ *
+ * The command overhead is the mean gap and the turn duration the mean duration of the turns. The
+ * speed and acceleration are fitted to the durations of the forward moves by least squares, with a
+ * search over a grid (in log space) which is narrowed around the best point each round. Anything
+ * with no records keeps its value from the default profile.
+ */
+SMotionProfile CMotionTimeCostModel::Fit(const vector<STelemetryRecord>& telemetry)
+{
+	DEBUG_METHOD();
+
+	SMotionProfile profile;
+
+	double gapSum = 0, turnSum = 0;
+	unsigned int turnCount = 0;
+	vector<STelemetryRecord> forwards;
+	for (unsigned int i = 0; i < telemetry.size(); ++i)
+	{
+		gapSum += telemetry[i].m_gap;
+		if (telemetry[i].m_type == EMotion_Forward)
+			forwards.push_back(telemetry[i]);
+		else
+		{
+			turnSum += telemetry[i].m_duration;
+			++turnCount;
+		}
+	}
+	if (!telemetry.empty())
+		profile.m_commandOverhead = gapSum / telemetry.size();
+	if (turnCount > 0)
+		profile.m_turnDuration = turnSum / turnCount;
+	if (forwards.empty())
+		return profile;
+
+	auto squaredError = [&](double maxSpeed, double acceleration) {
+		double error = 0;
+		for (unsigned int i = 0; i < forwards.size(); ++i)
+		{
+			double difference = RestToRestTime(forwards[i].m_distance, maxSpeed, acceleration) - forwards[i].m_duration;
+			error += difference*difference;
+		}
+		return error;
+	};
+
+	// Grid over log(speed) and log(acceleration), starting from 1/100 to 100 times the defaults. The
+	// grid must be fine, since the error has a narrow valley along speed/acceleration.
+	const int GRID_POINTS = 41;
+	double logSpeed = log(profile.m_maxSpeed), logAcceleration = log(profile.m_acceleration);
+	double halfWidth = log(100.0);
+	for (int round = 0; round < 40; ++round)
+	{
+		double bestError = squaredError(exp(logSpeed), exp(logAcceleration));
+		double bestLogSpeed = logSpeed, bestLogAcceleration = logAcceleration;
+		for (int i = 0; i < GRID_POINTS; ++i)
+		{
+			for (int j = 0; j < GRID_POINTS; ++j)
+			{
+				double candidateLogSpeed = logSpeed + halfWidth*(2.0*i/(GRID_POINTS - 1) - 1);
+				double candidateLogAcceleration = logAcceleration + halfWidth*(2.0*j/(GRID_POINTS - 1) - 1);
+				double error = squaredError(exp(candidateLogSpeed), exp(candidateLogAcceleration));
+				if (error < bestError)
+				{
+					bestError = error;
+					bestLogSpeed = candidateLogSpeed;
+					bestLogAcceleration = candidateLogAcceleration;
+				}
+			}
+		}
+
+		logSpeed = bestLogSpeed;
+		logAcceleration = bestLogAcceleration;
+		halfWidth *= 0.7;
+	}
+
+	profile.m_maxSpeed = exp(logSpeed);
+	profile.m_acceleration = exp(logAcceleration);
+
+	return profile;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function reads recorded motion commands from a csv file, one command per line:
+ *     motion (0 forward, 1 left, 2 right, as EMotion), distance, duration (s), gap (s)
+ */
+vector<STelemetryRecord> CMotionTimeCostModel::ReadTelemetry(const string& filePath)
+{
+	DEBUG_METHOD();
+
+	vector<vector<double> > lines = CParseCSV::ReadCSV_double(filePath);
+
+	vector<STelemetryRecord> telemetry;
+	for (unsigned int i = 0; i < lines.size(); ++i)
+	{
+		if (lines[i].size() != 4 || lines[i][0] < static_cast<double>(EMotion_Forward) || lines[i][0] > static_cast<double>(EMotion_TurnRight90))
+			throw Exception_InvalidTelemetry { i + 1 };
+
+		telemetry.push_back({ static_cast<EMotion>(static_cast<int>(lines[i][0])), lines[i][1], lines[i][2], lines[i][3] });
+	}
+
+	return telemetry;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function reads the motion commands noted in a telemetry log. A motion is noted when it
+ * finishes, so it started its duration before the time of the record; the gap is from then to the
+ * start of the next motion. The last motion is left out, as there is nothing to measure its gap to.
+ */
+vector<STelemetryRecord> CMotionTimeCostModel::ReadTelemetry(const CTelemetryLog& log)
+{
+	DEBUG_METHOD();
+
+	vector<STelemetryRecord> telemetry;
+	double previousFinishTime = 0;
+	size_t offset = 0;
+	STelemetryEntry entry;
+	while (log.Read(offset, entry))
+	{
+		if (entry.m_type != ETelemetry_Motion || entry.m_length != 4 + 2*sizeof(double))
+			continue;
+
+		int32_t type;
+		STelemetryRecord record;
+		memcpy(&type, entry.m_data, 4);
+		memcpy(&record.m_distance, entry.m_data + 4, sizeof(double));
+		memcpy(&record.m_duration, entry.m_data + 4 + sizeof(double), sizeof(double));
+		if (type < EMotion_Forward || type > EMotion_TurnRight90)
+			continue;
+		record.m_type = static_cast<EMotion>(type);
+		record.m_gap = 0;
+
+		double finishTime = entry.m_time/1e9;
+		if (!telemetry.empty())
+			telemetry.back().m_gap = max(0.0, finishTime - record.m_duration - previousFinishTime);
+		telemetry.push_back(record);
+		previousFinishTime = finishTime;
+	}
+
+	if (!telemetry.empty())
+		telemetry.pop_back();
+	return telemetry;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+// The time to drive a distance starting and finishing at rest, reaching maxSpeed if there is room
+double CMotionTimeCostModel::RestToRestTime(double distance, double maxSpeed, double acceleration)
+{
+	if (distance >= maxSpeed*maxSpeed/acceleration)
+		return distance/maxSpeed + maxSpeed/acceleration;
+
+	return 2*sqrt(distance/acceleration);
+}
+
+// The time to drive a distance starting at maxSpeed and finishing at rest (or the reverse). If the
+// distance is too short to stop in, the robot is taken to arrive at the speed it can stop from.
+double CMotionTimeCostModel::CruiseToRestTime(double distance, double maxSpeed, double acceleration)
+{
+	double stoppingDistance = maxSpeed*maxSpeed/(2*acceleration);
+	if (distance >= stoppingDistance)
+		return (distance - stoppingDistance)/maxSpeed + maxSpeed/acceleration;
+
+	return sqrt(2*distance/acceleration);
+}
@@ -0,0 +1,149 @@
+/*
+ * CCostModel.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CCOSTMODEL_H_
+#define SRC_CCOSTMODEL_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "Manouvre.h"
+#include "CTelemetryLog.h"
+#include <string>
+#include <vector>
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// How the robot moves. Distances are in the same units as ROOMLENGTH.
+struct SMotionProfile
+{
+	double m_maxSpeed;			// Cruising speed (distance per second)
+	double m_acceleration;		// Acceleration and deceleration (distance per second squared)
+	double m_turnDuration;		// Time for a 90 degree turn (COMP_LEFT/COMP_RIGHT) (seconds)
+	double m_commandOverhead;	// Time between one command finishing and the next starting, i.e. the
+								// DONE handshake and the Pi sending the next command (seconds)
+
+	SMotionProfile(double maxSpeed = ROOMLENGTH/1.5, double acceleration = 2*ROOMLENGTH, double turnDuration = 1.0,
+			double commandOverhead = 0.5);
+};
+
+// One motion command recorded on a run: what was sent, how long the PIC took to reply DONE, and
+// how long after that the next command was sent
+struct STelemetryRecord
+{
+	EMotion m_type;
+	double m_distance;
+	double m_duration;
+	double m_gap;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is an interface for the costs of the edges of the maze graph: crossing a room straight, or
+ * turning through it. The planners (CExplorationSession, CMapSnapshot::DistanceMatrix) minimise the
+ * total cost, so the cost model decides what they optimise.
+ *
+ * SpotTurnCost is the cost of a quarter turn on the spot, which CExplorationSession adds (twice) to
+ * a route setting off away from the way the robot faces. It is zero unless a model says otherwise.
+ *
+ * Default() is the original unit cost model (STRAIGHT_PATH_WEIGHT, CORNER_PATH_WEIGHT).
+ *
+ */
+class CCostModel
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	virtual ~CCostModel() {}
+
+	// === Public Functions =========================================================================
+	virtual double StraightCost() const = 0;
+	virtual double CornerCost() const = 0;
+	virtual double SpotTurnCost() const {return 0;}
+
+	static const CCostModel& Default();
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is the cost model with fixed weights for straights and corners.
+ */
+class CUnitCostModel : public CCostModel
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CUnitCostModel(double straightCost = STRAIGHT_PATH_WEIGHT, double cornerCost = CORNER_PATH_WEIGHT)
+			: m_straightCost { straightCost }, m_cornerCost { cornerCost }
+	{
+	}
+
+	// === Public Functions =========================================================================
+	double StraightCost() const override {return m_straightCost;}
+	double CornerCost() const override {return m_cornerCost;}
+
+private:
+	// === Member Variables =========================================================================
+	double m_straightCost;
+	double m_cornerCost;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is the cost model giving the expected time in seconds to drive each edge, from a motion
+ * profile.
+ *
+ * Forward moves driven the same way are joined up (CManouvre::FuseMotions), and each command is
+ * driven from rest to rest. A run of straights is driven as one command, so a straight costs its
+ * length at cruising speed. A corner costs what it adds to the commands driven: the half room after
+ * it at cruising speed, the stop and start which end one run and begin the next (with a command
+ * overhead), the watched half room approaching it (a command of its own), and the turn. This is
+ * exact for runs long enough to reach cruising speed.
+ *
+ * A quarter turn on the spot costs a turn command.
+ *
+ * Public Methods:
+ *    - CommandTime(motion) - The time for one motion command from rest to rest, plus its overhead.
+ *    - Fit(telemetry) - Fits a motion profile to recorded motion commands.
+ *    - ReadTelemetry(filePath) - Reads recorded motion commands from a csv file with the columns
+ *    	motion (EMotion), distance, duration, gap; or from the motions noted in a telemetry log of a
+ *    	run (see CTelemetryRecorder::NoteMotion).
+ *
+ * Exceptions:
+ * 	- Exception_InvalidTelemetry - Thrown by ReadTelemetry for a line which is not a motion command.
+ *
+ */
+class CMotionTimeCostModel : public CCostModel
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMotionTimeCostModel(const SMotionProfile& profile = SMotionProfile());
+
+	// === Public Functions =========================================================================
+	double StraightCost() const override;
+	double CornerCost() const override;
+	double SpotTurnCost() const override;
+	double CommandTime(const SMotion& motion) const;
+
+	const SMotionProfile& GetProfile() const {return m_profile;}
+
+	static SMotionProfile Fit(const std::vector<STelemetryRecord>& telemetry);
+	static std::vector<STelemetryRecord> ReadTelemetry(const std::string& filePath);
+	static std::vector<STelemetryRecord> ReadTelemetry(const CTelemetryLog& log);
+
+	// === Exceptions ===============================================================================
+	struct Exception_InvalidTelemetry
+	{
+		unsigned int mm_line;
+		explicit Exception_InvalidTelemetry(unsigned int line)
+				: mm_line { line }
+		{
+		}
+	};
+
+private:
+	// === Private Functions ========================================================================
+	static double RestToRestTime(double distance, double maxSpeed, double acceleration);
+	static double CruiseToRestTime(double distance, double maxSpeed, double acceleration);
+
+	// === Member Variables =========================================================================
+	SMotionProfile m_profile;
+};
+
+#endif /* SRC_CCOSTMODEL_H_ */
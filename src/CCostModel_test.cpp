@@ -0,0 +1,136 @@
+/*
+ * CCostModel_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CCostModel.h"
+#include "CExplorationSimulator.h"
+#include "CMazeGenerator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test the unit and motion time cost models, fitting a motion profile to telemetry (also read from
+// a telemetry log), and exploring mazes with routes planned by time, which must drive for no longer
+// than routes planned by distance
+int CCostModel_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CCostModel_test--\n\n";
+
+	int result = 0;
+
+	// The default model has the original weights
+	if (CCostModel::Default().StraightCost() != STRAIGHT_PATH_WEIGHT || CCostModel::Default().CornerCost() != CORNER_PATH_WEIGHT)
+	{
+		cout << "The default cost model does not have the original weights\n";
+		result = 1;
+	}
+
+	// Stopping to turn costs more than driving straight through a room
+	SMotionProfile profile { 1.6, 2.5, 0.8, 0.3 };
+	CMotionTimeCostModel timeModel { profile };
+	cout << "Straight " << timeModel.StraightCost() << "s, corner " << timeModel.CornerCost() << "s\n";
+	if (!(timeModel.CornerCost() > timeModel.StraightCost()))
+	{
+		cout << "A corner is cheaper than a straight\n";
+		result = 1;
+	}
+
+	// Fitting telemetry recorded from the profile (with a little noise) recovers the profile
+	vector<STelemetryRecord> telemetry;
+	for (int i = 1; i <= 12; ++i)
+	{
+		double noise = 0.01*((i % 3) - 1);
+		SMotion forward { EMotion_Forward, i*HALFROOMLENGTH, false };
+		SMotion turn { (i % 2) ? EMotion_TurnLeft90 : EMotion_TurnRight90, 0, false };
+		telemetry.push_back({ forward.m_type, forward.m_distance, timeModel.CommandTime(forward) - profile.m_commandOverhead + noise, profile.m_commandOverhead - noise });
+		telemetry.push_back({ turn.m_type, turn.m_distance, profile.m_turnDuration + noise, profile.m_commandOverhead + noise });
+	}
+	SMotionProfile fitted = CMotionTimeCostModel::Fit(telemetry);
+	cout << "Fitted speed " << fitted.m_maxSpeed << ", acceleration " << fitted.m_acceleration << ", turn "
+			<< fitted.m_turnDuration << "s, overhead " << fitted.m_commandOverhead << "s\n";
+	if (fabs(fitted.m_maxSpeed - profile.m_maxSpeed) > 0.05*profile.m_maxSpeed
+			|| fabs(fitted.m_acceleration - profile.m_acceleration) > 0.1*profile.m_acceleration
+			|| fabs(fitted.m_turnDuration - profile.m_turnDuration) > 0.01
+			|| fabs(fitted.m_commandOverhead - profile.m_commandOverhead) > 0.01)
+	{
+		cout << "The fitted profile is not the one the telemetry was recorded from\n";
+		result = 1;
+	}
+
+	// The same motions noted in a telemetry log of a run (as CTelemetryRecorder::NoteMotion does,
+	// each when it finishes) read back with their gaps, all but the last
+	const string logPath = "TestData/motions.log";
+	{
+		CTelemetryLog log;
+		log.Create(logPath, 4096);
+		double time = 0;
+		for (unsigned int i = 0; i < telemetry.size(); ++i)
+		{
+			time += telemetry[i].m_duration;
+			unsigned char record[4 + 2*sizeof(double)];
+			int32_t type = telemetry[i].m_type;
+			memcpy(record, &type, 4);
+			memcpy(record + 4, &telemetry[i].m_distance, sizeof(double));
+			memcpy(record + 4 + sizeof(double), &telemetry[i].m_duration, sizeof(double));
+			log.Append(ETelemetry_Motion, static_cast<uint64_t>(llround(time*1e9)), record, sizeof(record));
+			log.Append(ETelemetry_Decision, static_cast<uint64_t>(llround(time*1e9)), "next", 4);
+			time += telemetry[i].m_gap;
+		}
+	}
+	CTelemetryLog log;
+	log.Open(logPath);
+	vector<STelemetryRecord> logged = CMotionTimeCostModel::ReadTelemetry(log);
+	bool sameLogged = (logged.size() == telemetry.size() - 1);
+	for (unsigned int i = 0; sameLogged && i < logged.size(); ++i)
+	{
+		sameLogged = logged[i].m_type == telemetry[i].m_type && logged[i].m_distance == telemetry[i].m_distance
+				&& logged[i].m_duration == telemetry[i].m_duration && fabs(logged[i].m_gap - telemetry[i].m_gap) < 1e-6;
+	}
+	if (!sameLogged)
+	{
+		cout << "Motions noted in a telemetry log were not read back\n";
+		result = 1;
+	}
+	log.Close();
+	remove(logPath.c_str());
+
+	// Exploring with routes planned by time still explores everything, legally, and drives for no
+	// longer than with routes planned by distance
+	vector<CMapSnapshot> corpus;
+	vector<vector<vector<ERoom> > > braidedMazes = CMazeGenerator::GenerateCorpus(8, 10, 10, 101, 0.5);
+	for (unsigned int i = 0; i < braidedMazes.size(); ++i)
+		corpus.push_back(CMapSnapshot(braidedMazes[i], {}));
+
+	CExplorationSimulator distanceSimulator { 0, nullptr, profile };
+	CExplorationSimulator timeSimulator { 0, make_shared<CMotionTimeCostModel>(profile), profile };
+	SSimulationResult distanceTotal = CExplorationSimulator::Total(distanceSimulator.RunAll(corpus));
+	SSimulationResult timeTotal = CExplorationSimulator::Total(timeSimulator.RunAll(corpus));
+	cout << "Planned by distance: " << distanceTotal << '\n';
+	cout << "Planned by time: " << timeTotal << '\n';
+	if (timeTotal.m_illegalMoves != 0 || timeTotal.m_incomplete != 0)
+	{
+		cout << "Routes planned by time drove through a wall or left rooms unexplored\n";
+		result = 1;
+	}
+	if (timeTotal.m_driveTime > distanceTotal.m_driveTime || timeTotal.m_fusedDriveTime > distanceTotal.m_fusedDriveTime)
+	{
+		cout << "Routes planned by time took longer to drive than routes planned by distance\n";
+		result = 1;
+	}
+
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
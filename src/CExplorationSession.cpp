@@ -0,0 +1,210 @@
+/*
+ * CExplorationSession.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CExplorationSession.h"
+#include "CMapSnapshot.h"
+#include <chrono>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (constructor) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This constructor starts a session with a map of unknown rooms. The robot starts at the entrance
+ * vertex, so the first target will be the entrance vertex itself.
+ */
+CExplorationSession::CExplorationSession(int room_height, int room_width)
+		: m_map { room_height, room_width }, m_mapper { &m_map }, m_planner { 0 },
+		  m_pCostModel { make_shared<CUnitCostModel>() }, m_facingRow { -1 }, m_facingCol { -1 },
+		  m_totalTravel { 0 }, m_pendingLatency { 0 },
+		  m_lastStepLatency { 0 }, m_totalPlanningTime { 0 }, m_stepCount { 0 }
+{
+	DEBUG_METHOD();
+
+	RebuildGraph();
+}
+
+
+// -/-/-/-/-/-/-/ OBSERVATION FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function records the type of a room.
+ *
+ * Usually the room was of unknown type, in which case its edges are simply added to the graph. If
+ * the room was already known with a different type (i.e. the robot has changed its mind) then
+ * edges may need removing, so the graph is rebuilt from the map. Either way only the vertices on
+ * the walls of the room are rechecked for exploring.
+ *
+ * The robot looks into a room to observe it, so it is taken to face the room until it moves.
+ *
+ * The time taken is added to the latency of the next step.
+ *
+ */
+void CExplorationSession::ObserveRoom(int row, int col, ERoom roomType)
+{
+	DEBUG_METHOD();
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	if (row < 0 || row >= m_map.GetRoomHeight() || col < 0 || col >= m_map.GetRoomWidth())
+		throw Exception_RoomOutOfRange { row, col };
+
+	ERoom oldRoomType = m_map.GetRoomType(row, col);
+	if (oldRoomType != roomType)
+	{
+		m_map.SetRoomType(row, col, roomType);
+
+		if (oldRoomType == ERoom_Unknown)
+			AddRoomEdges(row, col);
+		else
+			RebuildGraph();
+
+		m_mapper.UpdateRoom(row, col);
+	}
+	m_facingRow = row;
+	m_facingCol = col;
+
+	m_pendingLatency += chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds the room of unknown type on one side of a vertex. This is the room which
+ * the robot should look into when it reaches a vertex returned by ComputeNextTarget. See
+ * CMazeMapper::RoomToExplore.
+ *
+ * INPUTS:
+ * vertex - The vertex.
+ *
+ * OUTPUTS:
+ * row, col - The room of unknown type next to the vertex.
+ *
+ * RETURNS:
+ * true if there is a room of unknown type next to the vertex, and false otherwise (in which case
+ * row and col are not changed).
+ *
+ */
+bool CExplorationSession::RoomBeyondVertex(int vertex, int& row, int& col) const
+{
+	DEBUG_METHOD();
+
+	return m_mapper.RoomToExplore(vertex, row, col);
+}
+
+
+// -/-/-/-/-/-/-/ PLANNING FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function computes the route from the current vertex to the next vertex to explore, using
+ * the graph and mapper kept by the session. See CLookaheadPlanner::ComputeNextVertex (which is
+ * CMazeMapper::ComputeNextVertex when the planning budget is zero).
+ *
+ * The time taken (plus the time spent in ObserveRoom since the last call) is recorded as the
+ * latency of this step.
+ *
+ */
+bool CExplorationSession::ComputeNextTarget(vector<int>& outputRoute)
+{
+	DEBUG_METHOD();
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	// Turning round on the spot to set off is part of the route, as is driving it
+	SRouteChoice choice;
+	choice.m_tieMargin = m_pCostModel->StraightCost();
+	choice.m_turnBack = 2*m_pCostModel->SpotTurnCost();
+	choice.m_facingRow = m_facingRow;
+	choice.m_facingCol = m_facingCol;
+
+	int currentVertex = m_map.GetCurrentVertex();
+	bool isNextVertex = m_planner.ComputeNextVertex(m_graph, m_map, m_mapper, currentVertex, outputRoute, choice, *m_pCostModel);
+
+	m_lastStepLatency = m_pendingLatency
+			+ chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+	m_pendingLatency = 0;
+	m_totalPlanningTime += m_lastStepLatency;
+	++m_stepCount;
+
+	// The Dijkstra results for this route are already saved in the graph
+	if (isNextVertex && outputRoute.size() > 1)
+	{
+		vector<int> route;
+		m_totalTravel += m_graph.ShortestDistance(currentVertex, outputRoute.back(), route);
+	}
+
+	DEBUG_VALUE_OF_LOCATION(m_lastStepLatency);
+
+	return isNextVertex;
+}
+
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function moves the robot to a vertex. Once it has moved it no longer faces the room it
+ * last observed.
+ */
+void CExplorationSession::SetCurrentVertex(int vertex)
+{
+	if (vertex != m_map.GetCurrentVertex())
+	{
+		m_facingRow = -1;
+		m_facingCol = -1;
+	}
+	m_map.SetCurrentVertex(vertex);
+}
+
+
+// -/-/-/-/-/-/-/ COST FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function sets the cost model for the edges of the graph. All of the edge weights change, so
+ * the graph is rebuilt.
+ */
+void CExplorationSession::SetCostModel(shared_ptr<const CCostModel> pCostModel)
+{
+	DEBUG_METHOD();
+
+	m_pCostModel = pCostModel;
+	RebuildGraph();
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds the edges of a room to the graph, with the weights of the cost model (as
+ * CMap::populateDistanceMatrixFromArray).
+ */
+void CExplorationSession::AddRoomEdges(int row, int col)
+{
+	DEBUG_METHOD();
+
+	vector<int> roomExits = CMap::GetRoomVertices(m_map.GetRoomType(row, col));
+	vector<int> roomVertexLabels = m_map.CalculateRoomVertices(row, col);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = i + 1; j < 4; ++j)
+		{
+			if (roomExits[i] == 1 && roomExits[j] == 1)
+			{
+				double weight = (j == i + 2) ? m_pCostModel->StraightCost() : m_pCostModel->CornerCost();
+				m_graph.AddEdge(roomVertexLabels[i], roomVertexLabels[j], weight);
+			}
+		}
+	}
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function rebuilds the graph from the map, throwing away all saved Dijkstra results.
+ */
+void CExplorationSession::RebuildGraph()
+{
+	DEBUG_METHOD();
+
+	vector<vector<double> > distanceMatrix = CMapSnapshot(m_map).DistanceMatrix(*m_pCostModel);
+	vector<int> vertexLabels(distanceMatrix.size());
+	for (unsigned int i = 0; i < vertexLabels.size(); ++i)
+		vertexLabels[i] = i;
+
+	m_graph = CGraph { distanceMatrix, vertexLabels };
+}
@@ -0,0 +1,133 @@
+/*
+ * CExplorationSession.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CEXPLORATIONSESSION_H_
+#define SRC_CEXPLORATIONSESSION_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "CMap.h"
+#include "CGraph.h"
+#include "CMazeMapper.h"
+#include "CLookaheadPlanner.h"
+#include "CCostModel.h"
+#include <memory>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to hold the planning state for the whole of the exploration in challenge two.
+ *
+ * It owns the map being built, a CGraph of the known part of the map, and the CMazeMapper which
+ * chooses where to explore next. These live for the whole exploration, so nothing is rebuilt between
+ * steps: each room observed adds its edges to the graph (CGraph::AddEdge repairs the saved Dijkstra
+ * results rather than throwing them away) and updates the vertices to explore.
+ *
+ * The time spent planning each step (observing the rooms since the last step, then choosing the
+ * next target) is measured and can be read back for reporting.
+ *
+ * Public Constructors:
+ *    - CExplorationSession(room_height, room_width) - Starts a session with a map of unknown rooms,
+ *    	with the robot at the entrance vertex.
+ *
+ * Public Methods:
+ *    - ObserveRoom(...) - Records the type of a room. If the room was already known with a
+ *    	different type then the graph is rebuilt.
+ *    - RoomBeyondVertex(...) - Finds the room of unknown type on the other side of a vertex.
+ *    - ComputeNextTarget(...) - Finds the route from the current vertex to the next vertex to
+ *    	explore. Returns false when there is nothing left to explore. Routes which set off away from
+ *    	the room the robot faces cost a U-turn (see CCostModel::SpotTurnCost), and routes less
+ *    	than a straight apart are taken as tied (see CMazeMapper::ComputeNextVertex).
+ *    - SetPlanningBudget(...) - Sets the CPU budget for looking ahead at each step (see
+ *    	CLookaheadPlanner). The default of zero always takes the nearest vertex to explore.
+ *    - SetCostModel(...) - Sets the edge costs the routes minimise (see CCostModel) and rebuilds
+ *    	the graph. The default is CUnitCostModel.
+ *    - GetCurrentVertex/SetCurrentVertex - Read and write where the robot is. The robot is taken
+ *    	to face the room it last observed, until it moves.
+ *    - GetMap() - The map built so far. Room types should only be changed through ObserveRoom.
+ *    - GetTotalTravel() - The total cost of the routes returned by ComputeNextTarget.
+ *    - GetLastStepLatency/GetTotalPlanningTime/GetStepCount - Planning time statistics (in
+ *    	microseconds).
+ *
+ * Exceptions:
+ * 	- Exception_RoomOutOfRange - Thrown when a room outside the map is observed.
+ *
+ */
+class CExplorationSession
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CExplorationSession(int room_height, int room_width);
+
+	// The mapper holds a pointer to m_map, so sessions cannot be copied
+	CExplorationSession(const CExplorationSession&) = delete;
+	CExplorationSession& operator=(const CExplorationSession&) = delete;
+
+	// === Public Functions =========================================================================
+	// Observations
+	void ObserveRoom(int row, int col, ERoom roomType);
+	bool RoomBeyondVertex(int vertex, int& row, int& col) const;
+
+	// Planning
+	bool ComputeNextTarget(std::vector<int>& outputRoute);
+
+	// Access functions
+	int GetCurrentVertex() const {return m_map.GetCurrentVertex();}
+	void SetCurrentVertex(int vertex);
+	CMap& GetMap() {return m_map;}
+	const CMap& GetMap() const {return m_map;}
+	std::vector<int> GetVertsToExplore() const {return m_mapper.GetVertsToExplore();}
+
+	// Planning budget (microseconds per step, 0 for the greedy choice)
+	void SetPlanningBudget(double budget) {m_planner.SetBudget(budget);}
+	double GetPlanningBudget() const {return m_planner.GetBudget();}
+	const CLookaheadPlanner& GetPlanner() const {return m_planner;}
+
+	// Edge costs
+	void SetCostModel(std::shared_ptr<const CCostModel> pCostModel);
+	const CCostModel& GetCostModel() const {return *m_pCostModel;}
+
+	// Statistics
+	double GetTotalTravel() const {return m_totalTravel;}
+	double GetLastStepLatency() const {return m_lastStepLatency;}
+	double GetTotalPlanningTime() const {return m_totalPlanningTime;}
+	unsigned int GetStepCount() const {return m_stepCount;}
+
+	// === Exceptions ===============================================================================
+	struct Exception_RoomOutOfRange
+	{
+		int mm_row;
+		int mm_col;
+		Exception_RoomOutOfRange(int row, int col)
+				: mm_row { row }, mm_col { col }
+		{
+		}
+	};
+
+private:
+	// === Private Functions ========================================================================
+	void AddRoomEdges(int row, int col);
+	void RebuildGraph();
+
+	// === Member Variables =========================================================================
+	CMap m_map;
+	CGraph m_graph;
+	CMazeMapper m_mapper;
+	CLookaheadPlanner m_planner;
+	std::shared_ptr<const CCostModel> m_pCostModel;
+
+	// The room the robot faces (the last observed), or -1 once it has moved
+	int m_facingRow;
+	int m_facingCol;
+
+	// Statistics (latencies in microseconds)
+	double m_totalTravel;
+	double m_pendingLatency;
+	double m_lastStepLatency;
+	double m_totalPlanningTime;
+	unsigned int m_stepCount;
+};
+
+#endif /* SRC_CEXPLORATIONSESSION_H_ */
@@ -0,0 +1,122 @@
+/*
+ * CExplorationSession_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CExplorationSession.h"
+#include "CMapSnapshot.h"
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Explore trueMap with a session, checking each step against a CMazeMapper which rebuilds
+// everything from scratch. If compareWithGreedy then the targets must also match.
+static int ExploreMap(const CMap& trueMap, CExplorationSession& session, bool compareWithGreedy)
+{
+	DEBUG_METHOD();
+
+	int result = 0;
+
+	vector<int> route;
+	unsigned int maxSteps = trueMap.GetRoomHeight()*trueMap.GetRoomWidth() + 1;
+	while (session.ComputeNextTarget(route))
+	{
+		// Compare with planning from a cold start
+		CMazeMapper coldMapper { &session.GetMap() };
+		if (coldMapper.GetVertsToExplore() != session.GetVertsToExplore())
+		{
+			cout << "Step " << session.GetStepCount() << ": incremental vertices to explore differ from a cold start\n";
+			result = 1;
+			break;
+		}
+		vector<int> coldRoute;
+		if (compareWithGreedy
+				&& (!coldMapper.ComputeNextVertex(session.GetCurrentVertex(), coldRoute) || coldRoute.back() != route.back()))
+		{
+			cout << "Step " << session.GetStepCount() << ": session chose a different target to a cold start\n";
+			result = 1;
+			break;
+		}
+
+		// Move to the target and look at the room beyond it
+		session.SetCurrentVertex(route.back());
+		int row, col;
+		if (!session.RoomBeyondVertex(route.back(), row, col))
+		{
+			cout << "Step " << session.GetStepCount() << ": no unknown room beyond vertex " << route.back() << '\n';
+			result = 1;
+			break;
+		}
+		session.ObserveRoom(row, col, trueMap.GetRoomType(row, col));
+
+		if (session.GetStepCount() > maxSteps)
+		{
+			cout << "Exploration did not finish\n";
+			result = 1;
+			break;
+		}
+	}
+
+	return result;
+}
+
+// Test that a session explores the practice map, keeping the same vertices to explore and choosing
+// the same targets as a CMazeMapper which rebuilds everything from scratch every step
+int CExplorationSession_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CExplorationSession_test--\n\n";
+
+	int result = 0;
+
+	CMap trueMap { "TestData/PracticeMap.csv" };
+	CExplorationSession session { trueMap.GetRoomHeight(), trueMap.GetRoomWidth() };
+
+	if (ExploreMap(trueMap, session, true) != 0)
+		result = 1;
+
+	// Explore again, looking ahead
+	CExplorationSession lookaheadSession { trueMap.GetRoomHeight(), trueMap.GetRoomWidth() };
+	lookaheadSession.SetPlanningBudget(5000);
+	if (ExploreMap(trueMap, lookaheadSession, false) != 0)
+		result = 1;
+
+	// The explored map should give the same route through the maze as the true map
+	vector<vector<double> > trueDistanceMatrix = CMapSnapshot(trueMap).DistanceMatrix();
+	vector<vector<double> > exploredDistanceMatrix = CMapSnapshot(session.GetMap()).DistanceMatrix();
+	if (CMapSnapshot(lookaheadSession.GetMap()).DistanceMatrix() != exploredDistanceMatrix)
+	{
+		cout << "Greedy and lookahead explorations found different maps\n";
+		result = 1;
+	}
+	vector<int> vertexLabels(trueDistanceMatrix.size());
+	for (unsigned int i = 0; i < vertexLabels.size(); ++i)
+		vertexLabels[i] = i;
+	CGraph trueGraph { trueDistanceMatrix, vertexLabels };
+	CGraph exploredGraph { exploredDistanceMatrix, vertexLabels };
+
+	vector<int> trueRoute, exploredRoute;
+	int startVertex = trueMap.GetEntranceVertex();
+	double trueDistance = trueGraph.ShortestDistance(startVertex, trueMap.GetExitVertex(), trueRoute);
+	double exploredDistance = exploredGraph.ShortestDistance(startVertex, trueMap.GetExitVertex(), exploredRoute);
+
+	cout << "Greedy: explored in " << session.GetStepCount() << " steps, travel " << session.GetTotalTravel() << ", "
+			<< session.GetTotalPlanningTime() << "us planning (last step " << session.GetLastStepLatency() << "us)\n";
+	cout << "Lookahead: explored in " << lookaheadSession.GetStepCount() << " steps, travel " << lookaheadSession.GetTotalTravel()
+			<< ", " << lookaheadSession.GetTotalPlanningTime() << "us planning\n";
+	cout << "Distance through the maze: " << exploredDistance << " (true map " << trueDistance << ")\n";
+
+	if (trueDistance == -1 || exploredDistance != trueDistance)
+		result = 1;
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,334 @@
+/*
+ * CExplorationSimulator.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CExplorationSimulator.h"
+#include "CExplorationSession.h"
+#include "Instructions.h"
+#include "CMazeGeometry.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ DEFINITIONS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Steps to the neighbouring room through each side, in the order North East South West
+static const int ROW_STEP[4] = { -1, 0, 1, 0 };
+static const int COL_STEP[4] = { 0, 1, 0, -1 };
+
+
+// -/-/-/-/-/-/-/ SSimulationResult /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+SSimulationResult::SSimulationResult()
+		: m_maps { 0 }, m_travel { 0 }, m_straights { 0 }, m_turns { 0 }, m_roomsVisited { 0 },
+		  m_roomsKnown { 0 }, m_steps { 0 }, m_illegalMoves { 0 }, m_incomplete { 0 },
+		  m_commands { 0 }, m_fusedCommands { 0 }, m_driveTime { 0 }, m_fusedDriveTime { 0 },
+		  m_firstMotionTime { 0 }, m_batchFirstMotionTime { 0 },
+		  m_planningTime { 0 }, m_runTime { 0 }
+{
+}
+
+SSimulationResult& SSimulationResult::operator+=(const SSimulationResult& other)
+{
+	m_maps += other.m_maps;
+	m_travel += other.m_travel;
+	m_straights += other.m_straights;
+	m_turns += other.m_turns;
+	m_roomsVisited += other.m_roomsVisited;
+	m_roomsKnown += other.m_roomsKnown;
+	m_steps += other.m_steps;
+	m_illegalMoves += other.m_illegalMoves;
+	m_incomplete += other.m_incomplete;
+	m_commands += other.m_commands;
+	m_fusedCommands += other.m_fusedCommands;
+	m_driveTime += other.m_driveTime;
+	m_fusedDriveTime += other.m_fusedDriveTime;
+	m_firstMotionTime += other.m_firstMotionTime;
+	m_batchFirstMotionTime += other.m_batchFirstMotionTime;
+	m_planningTime += other.m_planningTime;
+	m_runTime += other.m_runTime;
+
+	return *this;
+}
+
+ostream& operator<<(ostream& stream, const SSimulationResult& result)
+{
+	stream << result.m_maps << " maps: travel " << result.m_travel
+			<< ", straights " << result.m_straights
+			<< ", turns " << result.m_turns
+			<< ", rooms visited " << result.m_roomsVisited
+			<< ", rooms known " << result.m_roomsKnown
+			<< ", steps " << result.m_steps
+			<< ", illegal moves " << result.m_illegalMoves
+			<< ", incomplete " << result.m_incomplete
+			<< ", commands " << result.m_commands << " (fused " << result.m_fusedCommands << ")"
+			<< ", drive time " << result.m_driveTime << "s (fused " << result.m_fusedDriveTime << "s)"
+			<< ", time to first motion " << result.m_firstMotionTime << "us (converted up front " << result.m_batchFirstMotionTime << "us)"
+			<< ", planning " << result.m_planningTime << "us"
+			<< ", run " << result.m_runTime << "us";
+
+	return stream;
+}
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CExplorationSimulator::CExplorationSimulator(double planningBudget, shared_ptr<const CCostModel> pCostModel, const SMotionProfile& profile)
+		: m_planningBudget { planningBudget }, m_pCostModel { pCostModel }, m_timeModel { profile }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ SIMULATION FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function simulates exploring one maze, as in CChallenges::ChallengeTwo.
+ *
+ * The robot starts at the entrance vertex facing North. For each target:
+ *   - The route is converted to CInstructions, the robot turns on the spot to face along the start
+ *     of the route, and then the instructions are 'driven'.
+ *   - At the target the robot turns to face the room beyond, and its type is read from trueMap.
+ *
+ */
+SSimulationResult CExplorationSimulator::Run(const CMapSnapshot& trueMap) const
+{
+	DEBUG_METHOD();
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+	SSimulationResult result;
+	result.m_maps = 1;
+
+	int height = trueMap.GetRoomHeight();
+	int width = trueMap.GetRoomWidth();
+
+	CExplorationSession session { height, width };
+	CMazeGeometry geometry { height, width };
+	session.SetPlanningBudget(m_planningBudget);
+	if (m_pCostModel)
+		session.SetCostModel(m_pCostModel);
+
+	EOrientation heading = EOrientation_North;
+	set<int> roomsVisited;
+	unsigned int maxSteps = 4*height*width + 1;
+
+	vector<int> route;
+	while (result.m_steps < maxSteps)
+	{
+		chrono::steady_clock::time_point planStart = chrono::steady_clock::now();
+		if (!session.ComputeNextTarget(route))
+			break;
+
+		++result.m_steps;
+		vector<SMotion> motions;
+
+		// -- Drive the route -- //
+		if (route.size() > 1)
+		{
+			// Time to first motion: streamed, the first manouvre is known once one step has been
+			// decoded; converted up front, only once the whole route has been
+			chrono::steady_clock::time_point planEnd = chrono::steady_clock::now();
+			CInstructionStream stream { geometry };
+			stream.Append(route);
+			SInstructionStep firstStep;
+			stream.Next(firstStep);
+			chrono::steady_clock::time_point streamFirstStep = chrono::steady_clock::now();
+			CInstructions instructions { route, geometry };
+			chrono::steady_clock::time_point batchEnd = chrono::steady_clock::now();
+
+			result.m_firstMotionTime += chrono::duration<double, micro>(streamFirstStep - planStart).count();
+			result.m_batchFirstMotionTime += chrono::duration<double, micro>((planEnd - planStart) + (batchEnd - streamFirstStep)).count();
+			vector<EInstruction> instructionList = instructions.GetInstructions();
+			vector<ERoom> roomList = instructions.GetRoomList();
+			vector<EOrientation> orientationList = instructions.GetOrientations();
+
+			result.m_turns += TurnsBetween(heading, orientationList.front());
+			AddSpotTurns(heading, orientationList.front(), motions);
+			vector<SMotion> routeMotions = CManouvre::InstructionsToMotions(instructionList);
+			motions.insert(motions.end(), routeMotions.begin(), routeMotions.end());
+
+			for (unsigned int i = 0; i < instructionList.size(); ++i)
+			{
+				if (instructionList[i] == EInstruction_Straight)
+				{
+					++result.m_straights;
+					result.m_travel += STRAIGHT_PATH_WEIGHT;
+				}
+				else
+				{
+					++result.m_turns;
+					result.m_travel += CORNER_PATH_WEIGHT;
+				}
+
+				// The room must have exits on the side we come in (opposite our heading) and the
+				// side we go out of
+				int room = static_cast<int>(roomList[i]);
+				vector<int> roomExits = CMap::GetRoomVertices(trueMap.GetRoomType(room));
+				if (roomExits[(orientationList[i] + 2) % 4] != 1 || roomExits[orientationList[i + 1]] != 1)
+					++result.m_illegalMoves;
+
+				roomsVisited.insert(room);
+			}
+
+			heading = orientationList.back();
+		}
+		session.SetCurrentVertex(route.back());
+
+		// -- Look into the room beyond -- //
+		int row, col;
+		if (!session.RoomBeyondVertex(route.back(), row, col))
+			break;
+
+		// Face the room: it is on the side of the vertex which the room's walls tell us
+		vector<int> roomVertexLabels = session.GetMap().CalculateRoomVertices(row, col);
+		for (int side = 0; side < 4; ++side)
+		{
+			if (roomVertexLabels[side] == route.back())
+			{
+				EOrientation facing = static_cast<EOrientation>((side + 2) % 4);
+				result.m_turns += TurnsBetween(heading, facing);
+				AddSpotTurns(heading, facing, motions);
+				heading = facing;
+			}
+		}
+
+		vector<SMotion> fusedMotions = CManouvre::FuseMotions(motions);
+		result.m_commands += motions.size();
+		result.m_fusedCommands += fusedMotions.size();
+		for (unsigned int i = 0; i < motions.size(); ++i)
+			result.m_driveTime += m_timeModel.CommandTime(motions[i]);
+		for (unsigned int i = 0; i < fusedMotions.size(); ++i)
+			result.m_fusedDriveTime += m_timeModel.CommandTime(fusedMotions[i]);
+
+		session.ObserveRoom(row, col, trueMap.GetRoomType(row, col));
+	}
+
+	// -- Tally up -- //
+	vector<vector<bool> > reachable = ReachableRooms(trueMap);
+	bool complete = true;
+	for (int i = 0; i < height; ++i)
+	{
+		for (int j = 0; j < width; ++j)
+		{
+			if (session.GetMap().GetRoomType(i, j) != ERoom_Unknown)
+				++result.m_roomsKnown;
+			else if (reachable[i][j])
+				complete = false;
+		}
+	}
+	result.m_incomplete = complete ? 0 : 1;
+	result.m_roomsVisited = roomsVisited.size();
+	result.m_planningTime = session.GetTotalPlanningTime();
+	result.m_runTime = chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+
+	return result;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function simulates exploring each of a list of mazes, using numThreads threads (or one per
+ * core if numThreads is zero). Each thread takes the next maze off the list until there are none
+ * left. The results are in the same order as the mazes.
+ */
+vector<SSimulationResult> CExplorationSimulator::RunAll(const vector<CMapSnapshot>& trueMaps, unsigned int numThreads) const
+{
+	DEBUG_METHOD();
+
+	if (numThreads == 0)
+		numThreads = max(1u, thread::hardware_concurrency());
+
+	vector<SSimulationResult> results(trueMaps.size());
+	atomic<unsigned int> nextMap { 0 };
+
+	vector<thread> threads;
+	for (unsigned int t = 0; t < numThreads && t < trueMaps.size(); ++t)
+	{
+		threads.push_back(thread([&]() {
+			DEBUG_MUTE_THREAD(true);
+			for (unsigned int i = nextMap++; i < trueMaps.size(); i = nextMap++)
+				results[i] = Run(trueMaps[i]);
+		}));
+	}
+	for (unsigned int t = 0; t < threads.size(); ++t)
+		threads[t].join();
+
+	return results;
+}
+
+SSimulationResult CExplorationSimulator::Total(const vector<SSimulationResult>& results)
+{
+	DEBUG_METHOD();
+
+	SSimulationResult total;
+	for (unsigned int i = 0; i < results.size(); ++i)
+		total += results[i];
+
+	return total;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+// The number of 90 degree turns on the spot to get from one heading to another
+unsigned int CExplorationSimulator::TurnsBetween(EOrientation from, EOrientation to)
+{
+	int difference = (to - from + 4) % 4;
+	return (difference == 3) ? 1 : difference;
+}
+
+// The motions for turning on the spot from one heading to another (a U-turn is two left turns, as
+// in CManouvre::ReverseAndUTurn)
+void CExplorationSimulator::AddSpotTurns(EOrientation from, EOrientation to, vector<SMotion>& motions)
+{
+	int difference = (to - from + 4) % 4;
+	if (difference == 1)
+		motions.push_back({ EMotion_TurnRight90, 0, false });
+	else
+	{
+		for (int i = 0; i < (4 - difference) % 4; ++i)
+			motions.push_back({ EMotion_TurnLeft90, 0, false });
+	}
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds the rooms of the true map which can be reached from the entrance room. Two
+ * neighbouring rooms are joined if both have an exit through the wall between them.
+ */
+vector<vector<bool> > CExplorationSimulator::ReachableRooms(const CMapSnapshot& trueMap)
+{
+	DEBUG_METHOD();
+
+	int height = trueMap.GetRoomHeight();
+	int width = trueMap.GetRoomWidth();
+
+	vector<vector<bool> > reachable(height, vector<bool>(width, false));
+	vector<pair<int, int> > toVisit { make_pair(height - 1, 0) };
+	reachable[height - 1][0] = true;
+	while (!toVisit.empty())
+	{
+		int row = toVisit.back().first;
+		int col = toVisit.back().second;
+		toVisit.pop_back();
+
+		vector<int> roomExits = CMap::GetRoomVertices(trueMap.GetRoomType(row, col));
+		for (int side = 0; side < 4; ++side)
+		{
+			int nextRow = row + ROW_STEP[side];
+			int nextCol = col + COL_STEP[side];
+			if (roomExits[side] != 1 || nextRow < 0 || nextRow >= height || nextCol < 0 || nextCol >= width
+					|| reachable[nextRow][nextCol])
+				continue;
+
+			if (CMap::GetRoomVertices(trueMap.GetRoomType(nextRow, nextCol))[(side + 2) % 4] == 1)
+			{
+				reachable[nextRow][nextCol] = true;
+				toVisit.push_back(make_pair(nextRow, nextCol));
+			}
+		}
+	}
+
+	return reachable;
+}
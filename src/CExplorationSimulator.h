@@ -0,0 +1,106 @@
+/*
+ * CExplorationSimulator.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CEXPLORATIONSIMULATOR_H_
+#define SRC_CEXPLORATIONSIMULATOR_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "CMapSnapshot.h"
+#include "Manouvre.h"
+#include "CCostModel.h"
+#include <memory>
+#include <vector>
+#include <iostream>
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The cost of exploring one maze (or the total over several mazes)
+struct SSimulationResult
+{
+	unsigned int m_maps;			// Number of mazes included
+	double m_travel;				// Total weight of the edges driven (as the distance matrix)
+	unsigned int m_straights;		// Straight instructions
+	unsigned int m_turns;			// Turns in rooms, plus turns on the spot (a U-turn counts as two)
+	unsigned int m_roomsVisited;	// Distinct rooms driven through
+	unsigned int m_roomsKnown;		// Rooms whose type was found
+	unsigned int m_steps;			// Targets planned
+	unsigned int m_illegalMoves;	// Instructions through walls of the true map (should be zero!)
+	unsigned int m_incomplete;		// Mazes in which a reachable room was left unexplored
+	unsigned int m_commands;		// Motion commands sent to the PIC, one manouvre per instruction
+	unsigned int m_fusedCommands;	// Motion commands sent after joining up forward moves
+	double m_driveTime;				// Estimated driving time with one manouvre per instruction (seconds)
+	double m_fusedDriveTime;		// Estimated driving time after joining up forward moves (seconds)
+	double m_firstMotionTime;		// Time from starting to plan each route to knowing its first manouvre, with
+									// CInstructionStream (microseconds)
+	double m_batchFirstMotionTime;	// The same, converting each whole route with CInstructions first
+	double m_planningTime;			// Time spent planning (microseconds)
+	double m_runTime;				// Time spent simulating, including planning (microseconds)
+
+	SSimulationResult();
+	SSimulationResult& operator+=(const SSimulationResult& other);
+};
+
+std::ostream& operator<<(std::ostream& stream, const SSimulationResult& result);
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to measure the cost of exploring mazes in challenge two without the robot.
+ *
+ * It runs the same loop as CChallenges::ChallengeTwo on a CExplorationSession, but DetectRoomType
+ * is answered from a true map and the CInstructions for each route are executed virtually: the
+ * simulator keeps track of which way the robot faces and adds up the distance, turns and rooms
+ * driven through. Each instruction is checked against the walls of the true map.
+ *
+ * The motion commands for each step are counted both as sent one manouvre per instruction and after
+ * CManouvre::FuseMotions, and each is given an estimated driving time from a CMotionTimeCostModel.
+ * Every command pays a fixed overhead for the robot stopping and the SPI handshake, which is what
+ * fusing saves.
+ *
+ * The routes are planned with the session's cost model, so the driving time of routes planned by
+ * distance (the default) can be compared with that of routes planned by time.
+ *
+ * The time to first motion of each route (planning it and decoding its first manouvre) is measured
+ * both streaming the instructions and converting the whole route up front.
+ *
+ * Mazes can be simulated in parallel, one maze per thread at a time. Logging is muted on the worker
+ * threads, since it would otherwise take far longer than the simulation.
+ *
+ * Public Constructors:
+ *    - CExplorationSimulator(planningBudget, pCostModel, profile) - The planning budget (microseconds
+ *    	per step) passed to each session (zero gives the greedy planner), the cost model the routes
+ *    	are planned with (null for the session default) and the motion profile driving times are
+ *    	estimated with.
+ *
+ * Public Methods:
+ *    - Run(trueMap) - Simulates exploring one maze.
+ *    - RunAll(trueMaps, numThreads) - Simulates exploring each maze, in parallel.
+ *    - Total(results) - Adds up a list of results.
+ *
+ */
+class CExplorationSimulator
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CExplorationSimulator(double planningBudget = 0, std::shared_ptr<const CCostModel> pCostModel = nullptr,
+			const SMotionProfile& profile = SMotionProfile());
+
+	// === Public Functions =========================================================================
+	SSimulationResult Run(const CMapSnapshot& trueMap) const;
+	std::vector<SSimulationResult> RunAll(const std::vector<CMapSnapshot>& trueMaps, unsigned int numThreads = 0) const;
+	static SSimulationResult Total(const std::vector<SSimulationResult>& results);
+
+private:
+	// === Private Functions ========================================================================
+	static unsigned int TurnsBetween(EOrientation from, EOrientation to);
+	static void AddSpotTurns(EOrientation from, EOrientation to, std::vector<SMotion>& motions);
+	static std::vector<std::vector<bool> > ReachableRooms(const CMapSnapshot& trueMap);
+
+	// === Member Variables =========================================================================
+	double m_planningBudget;
+	std::shared_ptr<const CCostModel> m_pCostModel;
+	CMotionTimeCostModel m_timeModel;
+};
+
+#endif /* SRC_CEXPLORATIONSIMULATOR_H_ */
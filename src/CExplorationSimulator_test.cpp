@@ -0,0 +1,115 @@
+/*
+ * CExplorationSimulator_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CExplorationSimulator.h"
+#include "CMazeGenerator.h"
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that generated mazes are explored completely without driving through walls, both greedily
+// and looking ahead, and report the cost of each
+int CExplorationSimulator_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CExplorationSimulator_test--\n\n";
+
+	int result = 0;
+
+	// A corpus of perfect mazes and braided (looped) mazes
+	vector<CMapSnapshot> corpus;
+	vector<vector<vector<ERoom> > > perfectMazes = CMazeGenerator::GenerateCorpus(8, 10, 10, 1);
+	vector<vector<vector<ERoom> > > braidedMazes = CMazeGenerator::GenerateCorpus(8, 10, 10, 101, 0.5);
+	for (unsigned int i = 0; i < perfectMazes.size(); ++i)
+		corpus.push_back(CMapSnapshot(perfectMazes[i], {}));
+	for (unsigned int i = 0; i < braidedMazes.size(); ++i)
+		corpus.push_back(CMapSnapshot(braidedMazes[i], {}));
+
+	// The same seed gives the same maze
+	if (CMazeGenerator::Generate(10, 10, 1) != perfectMazes[0])
+	{
+		cout << "The same seed gave different mazes\n";
+		result = 1;
+	}
+
+	// Joining up forward moves: two straights, a left turn and a straight are one line-following move
+	// of four half rooms, the half room into the junction watching the encoders, the turn, and one
+	// move of three half rooms out of it
+	vector<SMotion> fusedMotions = CManouvre::FuseMotions(CManouvre::InstructionsToMotions(
+			{ EInstruction_Straight, EInstruction_Straight, EInstruction_TurnLeft, EInstruction_Straight }));
+	vector<SMotion> expectedFused = {
+			{ EMotion_Forward, 4*HALFROOMLENGTH, false },
+			{ EMotion_Forward, HALFROOMLENGTH, true },
+			{ EMotion_TurnLeft90, 0, false },
+			{ EMotion_Forward, 3*HALFROOMLENGTH, false } };
+	if (fusedMotions != expectedFused)
+	{
+		cout << "Forward moves were not joined up correctly\n";
+		result = 1;
+	}
+
+	// A line-following straight is not joined to the encoder approach to a junction after it
+	vector<SMotion> mixedMotions = { { EMotion_Forward, ROOMLENGTH, false }, { EMotion_Forward, HALFROOMLENGTH, true } };
+	if (CManouvre::FuseMotions(mixedMotions) != mixedMotions)
+	{
+		cout << "Moves driven different ways were joined into one\n";
+		result = 1;
+	}
+
+	// Simulate, in parallel, with and without looking ahead. The lookahead budget is far more than a
+	// decision takes, so that every search finishes and the results do not depend on the machine.
+	CExplorationSimulator greedySimulator;
+	CExplorationSimulator lookaheadSimulator { 1e6 };
+	vector<SSimulationResult> greedyResults = greedySimulator.RunAll(corpus);
+	vector<SSimulationResult> lookaheadResults = lookaheadSimulator.RunAll(corpus);
+
+	// Running one maze on this thread gives the same as running it on a worker
+	SSimulationResult single = greedySimulator.Run(corpus.back());
+	if (single.m_travel != greedyResults.back().m_travel || single.m_turns != greedyResults.back().m_turns)
+	{
+		cout << "Serial and parallel simulations differ\n";
+		result = 1;
+	}
+
+	SSimulationResult greedyTotal = CExplorationSimulator::Total(greedyResults);
+	SSimulationResult lookaheadTotal = CExplorationSimulator::Total(lookaheadResults);
+	cout << "Greedy: " << greedyTotal << '\n';
+	cout << "Lookahead: " << lookaheadTotal << '\n';
+
+	if (greedyTotal.m_maps != corpus.size() || lookaheadTotal.m_maps != corpus.size())
+		result = 1;
+	if (greedyTotal.m_fusedCommands >= greedyTotal.m_commands || greedyTotal.m_fusedDriveTime >= greedyTotal.m_driveTime)
+	{
+		cout << "Joining up forward moves did not save any commands\n";
+		result = 1;
+	}
+	if (greedyTotal.m_illegalMoves != 0 || lookaheadTotal.m_illegalMoves != 0)
+	{
+		cout << "Drove through a wall\n";
+		result = 1;
+	}
+	if (greedyTotal.m_incomplete != 0 || lookaheadTotal.m_incomplete != 0)
+	{
+		cout << "Left reachable rooms unexplored\n";
+		result = 1;
+	}
+	if (lookaheadTotal.m_travel > greedyTotal.m_travel || lookaheadTotal.m_driveTime > greedyTotal.m_driveTime
+			|| lookaheadTotal.m_fusedDriveTime > greedyTotal.m_fusedDriveTime)
+	{
+		cout << "Looking ahead travelled further than taking the nearest vertex\n";
+		result = 1;
+	}
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
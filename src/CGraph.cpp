@@ -9,6 +9,8 @@
 #include "CGraph.h"
 #include <limits>
 #include <stdexcept>
+#include <queue>
+#include <functional>
 #include "DebugLog.hpp"
 
 // ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -274,6 +276,47 @@ double CGraph::ShortestDistance(const int& startVertex, const int& endVertex, ve
 }
 
 
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function returns the vertex after vertex on a shortest route from vertex to endVertex, read
+ * from the tree of shortest routes from endVertex (Dijkstra is run from endVertex if it has not
+ * been already). The edges are the same both ways, so the parent of a vertex in that tree is its
+ * next hop.
+ *
+ * INPUTS:
+ * vertex    = An integer representing the vertex to find the next hop of.
+ * endVertex = An integer representing the vertex at the end of the route.
+ *
+ * RETURNS:
+ * The next vertex on the route, or -1 if vertex is endVertex or is not connected to it.
+ *
+ */
+int CGraph::NextHop(const int& vertex, const int& endVertex)
+{
+	DEBUG_METHOD();
+
+	// Convert to internal vertex numbering (and check valid vertices)
+	unsigned int iVertex, iEndVertex;
+	try
+	{
+		iVertex = ExternalToInternal(vertex);
+		iEndVertex = ExternalToInternal(endVertex);
+	}
+	catch (out_of_range& e)
+	{
+		throw ShortestDistance_InvalidVertex { vertex, endVertex };
+	}
+
+	if (m_DijkstraStartVertices.count(iEndVertex) == 0)
+		InternalDijkstra(iEndVertex);
+	unsigned int index = m_DijkstraStartVertices[iEndVertex];
+
+	if (iVertex == iEndVertex || m_DijkstraShortestDistances[index][iVertex] == -1)
+		return -1;
+
+	return InternalToExternal(m_DijkstraOutputRoutes[index][iVertex]);
+}
+
+
 /* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * This function is a wrapper for Dijkstra's algorithm.
  * It returns the shortest distance between two specified vertices, and an example shortest route
@@ -487,6 +530,130 @@ unsigned int CGraph::InternalDijkstra(const unsigned int& startVertex)
 }
 
 
+// -/-/-/-/-/-/-/ MODIFICATION FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function adds an (undirected) edge to the graph, or sets the length of an existing one.
+ *
+ * Adding or shortening an edge can only make shortest distances shorter, so the saved Dijkstra
+ * results are repaired in place by InternalRepairDijkstra instead of being thrown away. This is
+ * much cheaper than running Dijkstra again when the graph grows a few edges at a time.
+ *
+ * If the edge already exists with the distance supplied then nothing is done. If it exists with a
+ * shorter distance than the one supplied then the edge is lengthened and the saved Dijkstra results
+ * are thrown away, since they cannot be repaired cheaply.
+ *
+ * Inputs use the external vertex numbering.
+ *
+ * INPUTS:
+ * vertexA, vertexB = The vertices at either end of the edge. These must be distinct.
+ * distance         = The length of the edge. This must be >= 0.
+ *
+ */
+void CGraph::AddEdge(const int& vertexA, const int& vertexB, const double& distance)
+{
+	DEBUG_METHOD();
+
+	// Convert to internal vertex numbering (and check the edge is valid)
+	unsigned int iVertexA, iVertexB;
+	try
+	{
+		iVertexA = ExternalToInternal(vertexA);
+		iVertexB = ExternalToInternal(vertexB);
+	}
+	catch (out_of_range& e)
+	{
+		throw AddEdge_InvalidEdge { vertexA, vertexB, distance };
+	}
+	if (iVertexA == iVertexB || distance < 0)
+		throw AddEdge_InvalidEdge { vertexA, vertexB, distance };
+
+	double oldDistance = m_DistanceMatrix[iVertexA][iVertexB];
+	if (oldDistance == distance)
+		return;
+
+	m_DistanceMatrix[iVertexA][iVertexB] = distance;
+	m_DistanceMatrix[iVertexB][iVertexA] = distance;
+	m_AdjacencyMatrix[iVertexA][iVertexB] = true;
+	m_AdjacencyMatrix[iVertexB][iVertexA] = true;
+
+	if (oldDistance != -1 && oldDistance < distance)
+	{
+		// The edge got longer. Forget the saved Dijkstra results.
+		m_DijkstraOutputRoutes.clear();
+		m_DijkstraShortestDistances.clear();
+		m_DijkstraStartVertices.clear();
+	}
+	else
+	{
+		for (auto it = m_DijkstraStartVertices.begin(); it != m_DijkstraStartVertices.end(); ++it)
+			InternalRepairDijkstra(it->first, it->second, iVertexA, iVertexB);
+	}
+}
+
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function repairs one set of saved Dijkstra results after the edge between vertexA and
+ * vertexB has been added or shortened.
+ *
+ * If the new edge gives a shorter route to one of its ends then that end is updated, and the
+ * improvement is pushed outwards through the graph, closest vertex first. Only the vertices whose
+ * shortest distance actually improves are visited, so adding an edge on the far side of the graph
+ * from startVertex costs next to nothing.
+ *
+ * INPUTS:
+ * startVertex      = The start vertex of the saved Dijkstra results.
+ * index            = The index of the results in m_DijkstraOutputRoutes and
+ *                    m_DijkstraShortestDistances.
+ * vertexA, vertexB = The ends of the edge which has been added.
+ *
+ */
+void CGraph::InternalRepairDijkstra(const unsigned int& startVertex, const unsigned int& index, const unsigned int& vertexA, const unsigned int& vertexB)
+{
+	DEBUG_METHOD();
+
+	vector<double>& shortestDistances = m_DijkstraShortestDistances[index];
+	vector<unsigned int>& outputRoutes = m_DijkstraOutputRoutes[index];
+
+	// The start vertex is at distance zero, whatever the diagonal of the distance matrix says
+	auto distanceTo = [&](unsigned int vertex) { return (vertex == startVertex) ? 0 : shortestDistances[vertex]; };
+
+	// Min-heap of (distance, vertex) pairs whose improvement has not been passed on yet
+	typedef pair<double, unsigned int> QueueEntry;
+	priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry> > toUpdate;
+
+	auto relax = [&](unsigned int from, unsigned int to) {
+		if (distanceTo(from) == -1 || to == startVertex)
+			return;
+		double newDistance = distanceTo(from) + m_DistanceMatrix[from][to];
+		if (shortestDistances[to] == -1 || newDistance < shortestDistances[to])
+		{
+			shortestDistances[to] = newDistance;
+			outputRoutes[to] = from;
+			toUpdate.push(QueueEntry(newDistance, to));
+		}
+	};
+
+	relax(vertexA, vertexB);
+	relax(vertexB, vertexA);
+
+	while (!toUpdate.empty())
+	{
+		QueueEntry next = toUpdate.top();
+		toUpdate.pop();
+
+		// Skip entries which have since been improved on
+		if (next.first > shortestDistances[next.second])
+			continue;
+
+		for (unsigned int i = 0; i < m_Order; ++i)
+		{
+			if (m_AdjacencyMatrix[next.second][i])
+				relax(next.second, i);
+		}
+	}
+}
+
+
 // -/-/-/-/-/-/-/ HELPER FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
 /* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * This function can be used to determine the format of a distance matrix. If the format is not
@@ -32,6 +32,14 @@
  *                       [This function is public interface for InternalShortestDistance.
  *                       It converts the inputs and outputs between the internal vertex numbering
  *                       and the external numbering, using internalShortestDistance to do the work.]
+ *  - NextHop          = A function to return the vertex after a given vertex on a shortest route
+ *                       from it to a supplied end vertex. After the first call for an end vertex
+ *                       this only reads the saved tree of shortest routes, so the next hops of every
+ *                       vertex cost one run of Dijkstra between them.
+ *  - AddEdge          = A function to add an edge of the graph, or set the length of an existing
+ *                       one. Unless an edge is lengthened, saved Dijkstra results are repaired
+ *                       rather than thrown away, so a graph which grows a few edges at a time (e.g.
+ *                       while exploring the maze) keeps its shortest path trees warm.
  *
  * Private Member Functions:
  *  - InternalToExternal        = A function to relabel vertex labels from internal to external.
@@ -39,6 +47,8 @@
  *  - InternalDijkstra          = An implementation of Dijkstra's algorithm.
  *                                https://en.wikipedia.org/wiki/Dijkstra's_algorithm
  *                                Results are saved in the member variables beginning 'm_Dijkstra'.
+ *  - InternalRepairDijkstra    = Repairs one set of saved Dijkstra results after an edge has been
+ *                                added or shortened.
  *  - InternalShortestDistance  = Calls InternalDijkstra if necessary (or just reads the relevant
  *                                member variables) to compute the shortest distance between two
  *                                supplied points.
@@ -85,6 +95,8 @@
  *                                      contain a repeat.
  *  - ShortestDistance_InvalidVertex  = Thrown when ShortestDistance is called with in invalid start
  *                                      vertex.
+ *  - AddEdge_InvalidEdge             = Thrown when AddEdge is called with an invalid vertex or a
+ *                                      negative distance.
  *  - InternalException               = Thrown with a string message when the code is internally
  *                                      broken.
  *
@@ -103,6 +115,10 @@ public:
 	// Dijkstra functions
 	double ShortestDistance(const int& startVertex, const int& endVertex, std::vector<int>& outputRoute);
 	double ShortestDistance(const int& startVertex, const int& endVertex, const bool& preferStartVertex, std::vector<int>& outputRoute);
+	int NextHop(const int& vertex, const int& endVertex);
+
+	// Modification functions
+	void AddEdge(const int& vertexA, const int& vertexB, const double& distance);
 
 	// === Exceptions ===============================================================================
 	// TODO Derive these exceptions from a standard exception so they can be caught by generic exception handlers?
@@ -157,6 +173,17 @@ public:
 		{
 		}
 	};
+	struct AddEdge_InvalidEdge
+	{
+		// The mm_vertexA and mm_vertexB here use the external labelling
+		int mm_vertexA;
+		int mm_vertexB;
+		double mm_distance;
+		AddEdge_InvalidEdge(int vertexA, int vertexB, double distance)
+				: mm_vertexA { vertexA }, mm_vertexB { vertexB }, mm_distance { distance }
+		{
+		}
+	};
 	struct InternalException
 	{
 		std::string mm_message;
@@ -181,6 +208,7 @@ private:
 	// Dijkstra functions
 	void InternalShortestDistance(const unsigned int& startVertex, const unsigned int& endVertex, const bool& preferStartVertex, double& shortestDistance, std::vector<unsigned int>& outputRoute);
 	unsigned int InternalDijkstra(const unsigned int& startVertex);
+	void InternalRepairDijkstra(const unsigned int& startVertex, const unsigned int& index, const unsigned int& vertexA, const unsigned int& vertexB);
 
 	// Helper functions
 	DistMatCheckResult CheckInput_DistMat(const std::vector<std::vector<double> >& distanceMatrix) const;
@@ -280,6 +280,11 @@ int CGraph_test2()
 	if (expected_shortestDistances != shortestDistances)
 		success = false;
 
+	// Next hops are read from the tree of shortest routes to the end vertex
+	if (exampleGraph.NextHop(-1, 3) != 1 || exampleGraph.NextHop(6, 3) != 2 || exampleGraph.NextHop(3, 3) != -1
+			|| exampleGraph.NextHop(8, 1) != -1 || exampleGraph.NextHop(8, 7) != 7)
+		success = false;
+
 	// -Display output-
 	cout << "--CGraph_test2--\n\n";
 
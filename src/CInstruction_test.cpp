@@ -1,14 +1,184 @@
+/*
+ * CInstruction_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
 #include "Instructions.h"
-#include<iostream>
-#include<fstream>
-#include<vector>
-#include "EnumsHeader.h"
+#include "CMazeGeometry.h"
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <random>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that routes are converted to the right instructions, rooms and orientations: a short route
+// worked by hand (also streamed), and long random routes through an open maze. The long routes are
+// also timed.
+int CInstruction_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CInstruction_test--\n\n";
+
+	int result = 0;
+
+	// -- Hand worked route on a 10 x 10 map -- //
+	// From the entrance North through room (9, 0), then right through room (8, 0) to its East vertex
+	CInstructions handInstructions { { 211, 190, 170 }, 10 };
+	if (handInstructions.GetInstructions() != vector<EInstruction> { EInstruction_Straight, EInstruction_TurnRight }
+			|| handInstructions.GetRoomList() != vector<ERoom> { static_cast<ERoom>(90), static_cast<ERoom>(80) }
+			|| handInstructions.GetOrientations() != vector<EOrientation> { EOrientation_North, EOrientation_North, EOrientation_East })
+	{
+		cout << "Hand worked route decoded wrongly\n";
+		result = 1;
+	}
+
+	// Vertices which do not share a room
+	try
+	{
+		CInstructions invalidInstructions { { 211, 213 }, 10 };
+		cout << "Invalid route was not rejected\n";
+		result = 1;
+	}
+	catch (CInstructions::Exception_InvalidRoute& e)
+	{
+	}
+
+	// -- Streaming -- //
+	// The route is extended one vertex at a time; each instruction is available as soon as both of
+	// its vertices are
+	CMazeGeometry smallGeometry { 10, 10 };
+	CInstructionStream stream { smallGeometry };
+	vector<EInstruction> streamed;
+	SInstructionStep step;
+	vector<int> handRoute = { 211, 190, 170 };
+	for (unsigned int i = 0; i < handRoute.size(); ++i)
+	{
+		if (stream.Next(step))
+		{
+			cout << "Stream gave an instruction before its vertices were known\n";
+			result = 1;
+		}
+		stream.Append(handRoute[i]);
+		if (i > 0 && stream.Next(step))
+			streamed.push_back(step.m_instruction);
+	}
+	stream.Close();
+	if (streamed != handInstructions.GetInstructions() || !stream.IsFinished())
+	{
+		cout << "Streamed instructions differ from converting the whole route\n";
+		result = 1;
+	}
+	try
+	{
+		stream.Append(169);
+		cout << "Closed stream was extended\n";
+		result = 1;
+	}
+	catch (CInstructionStream::Exception_StreamClosed& e)
+	{
+	}
+
+	// The same route read on another thread, waiting for each vertex as the planner would
+	CInstructionStream sharedStream { smallGeometry };
+	future<vector<EInstruction> > reader = async(launch::async, [&sharedStream]() {
+		vector<EInstruction> read;
+		SInstructionStep readStep;
+		while (sharedStream.WaitNext(readStep))
+			read.push_back(readStep.m_instruction);
+		return read;
+	});
+	for (unsigned int i = 0; i < handRoute.size(); ++i)
+		sharedStream.Append(handRoute[i]);
+	sharedStream.Close();
+	if (reader.get() != handInstructions.GetInstructions() || !sharedStream.IsFinished())
+	{
+		cout << "Stream read on another thread differs from converting the whole route\n";
+		result = 1;
+	}
+
+	// -- Long random routes -- //
+	// Each step goes into the room on the far side of the current vertex and leaves through a random
+	// other side, so the expected room and sides are known.
+	const int height = 50;
+	const int width = 50;
+	const unsigned int routeLength = 5000;
+	const unsigned int numRoutes = 20;
+	CMazeGeometry geometry { height, width };
+	mt19937 generator { 7 };
+
+	double totalTime = 0;
+	for (unsigned int r = 0; r < numRoutes && result == 0; ++r)
+	{
+		vector<int> route { geometry.RoomVertex((height - 1)*width, EOrientation_South) };
+		vector<ERoom> expectedRooms;
+		vector<EInstruction> expectedInstructions;
+		int room = (height - 1)*width;
+		EOrientation entrySide = EOrientation_South;
+		while (route.size() < routeLength)
+		{
+			int row = room / width;
+			int col = room % width;
+			EOrientation exitSide = static_cast<EOrientation>((entrySide + 1 + uniform_int_distribution<int>(0, 2)(generator)) % 4);
+
+			// Stay in the maze
+			if ((exitSide == EOrientation_North && row == 0) || (exitSide == EOrientation_South && row == height - 1)
+					|| (exitSide == EOrientation_West && col == 0) || (exitSide == EOrientation_East && col == width - 1))
+				continue;
+
+			int turn = (exitSide - (entrySide + 2) + 4) % 4;
+			expectedInstructions.push_back(turn == 0 ? EInstruction_Straight : (turn == 1 ? EInstruction_TurnRight : EInstruction_TurnLeft));
+			expectedRooms.push_back(static_cast<ERoom>(room));
+			route.push_back(geometry.RoomVertex(room, exitSide));
+
+			const int rowStep[4] = { -1, 0, 1, 0 };
+			const int colStep[4] = { 0, 1, 0, -1 };
+			room = (row + rowStep[exitSide])*width + col + colStep[exitSide];
+			entrySide = static_cast<EOrientation>((exitSide + 2) % 4);
+		}
+
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		CInstructions instructions { route, geometry };
+		totalTime += chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+
+		if (instructions.GetInstructions() != expectedInstructions || instructions.GetRoomList() != expectedRooms)
+		{
+			cout << "Random route " << r << " decoded wrongly\n";
+			result = 1;
+		}
 
-// TODO Write test once function generate inputs is complete.
+		// The orientation after each instruction is the orientation before the next
+		vector<EOrientation> orientations = instructions.GetOrientations();
+		for (unsigned int i = 0; i + 1 < expectedInstructions.size(); ++i)
+		{
+			int turn = (orientations[i + 1] - orientations[i] + 4) % 4;
+			if (turn != (expectedInstructions[i] == EInstruction_Straight ? 0 : (expectedInstructions[i] == EInstruction_TurnRight ? 1 : 3)))
+			{
+				cout << "Random route " << r << " has inconsistent orientations at step " << i << '\n';
+				result = 1;
+				break;
+			}
+		}
 
-	std::vector<ERoom> roomList;
+		// Building the geometry from the map width gives the same result
+		if (r == 0 && CInstructions(route, width).GetInstructions() != expectedInstructions)
+		{
+			cout << "Random route decoded differently without a precomputed geometry\n";
+			result = 1;
+		}
+	}
 
-	std::vector<EInstruction> instructionList;
+	cout << "Converted " << numRoutes << " routes of " << routeLength << " vertices in " << totalTime << "us ("
+			<< totalTime*1000/(numRoutes*routeLength) << "ns per vertex)\n";
 
-	std::vector<EOrientation> orientationList;
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
 
+	return result;
+}
@@ -0,0 +1,293 @@
+/*
+ * CLookaheadPlanner.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CLookaheadPlanner.h"
+#include "CMapSnapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CLookaheadPlanner::CLookaheadPlanner(double budget, unsigned int maxCandidates)
+		: m_budget { budget }, m_maxCandidates { maxCandidates }, m_lastDepth { 0 },
+		  m_lastToursEvaluated { 0 }, m_lastBudgetExceeded { false }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ PLANNING FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function computes the route to the next vertex to explore, looking ahead at tours of the
+ * nearest vertices to explore.
+ *
+ * The greedy choice of CMazeMapper::ComputeNextVertex is computed first, so that there is always
+ * an answer. Then, while there is budget left:
+ *   - The nearest m_maxCandidates reachable vertices to explore are taken as candidates. The
+ *     distance to each is found in the graph of the known map (it is the route driven next), but
+ *     the distances between them are found in a graph of the map with every unknown room taken to
+ *     be a crossroads. The rooms explored on the way to one candidate often open a shorter way on
+ *     to the next, and measuring the later legs through the known map alone favours tours which
+ *     stay in explored rooms over those which open up the maze.
+ *   - Tours of 1, 2, 3, ... candidates are searched (branch and bound), in score order. The best
+ *     tour of each length is the one with least expected travel, with ties (as choice.m_tieMargin)
+ *     going to the tour with the most gain (see VertexGain), and then to the first found. Tours
+ *     visiting two vertices into the same room are skipped, since the second vertex reveals nothing.
+ * The clock is checked after each candidate is found, after the open graph is built, after each
+ * row of distances, and every few tours. If the budget runs out before the tours are searched the
+ * greedy choice is returned; otherwise, when it runs out the first vertex of the best tour of the
+ * longest fully searched length is returned (or the greedy choice if there is none).
+ *
+ *	INPUTS:
+ *	graph         - A graph of the known part of the map (see CExplorationSession).
+ *	map           - The map.
+ *	mapper        - The CMazeMapper holding the vertices to explore for the map.
+ *	currentVertex - The current vertex in the maze.
+ *	choice        - How routes are compared (see CMazeMapper::RouteCost). Each candidate's distance
+ *		includes the cost of turning back to set off towards it.
+ *	costModel     - The edge costs of the graph, used for the distances between candidates.
+ *
+ *	OUTPUTS:
+ *	outputRoute - This will be populated with a fastest route from the current vertex to the next
+ *		vertex to explore.
+ *
+ *	RETURNS:
+ *	false if there are no more (reachable) vertices to explore, and true otherwise.
+ *
+ */
+bool CLookaheadPlanner::ComputeNextVertex(CGraph& graph, const CMap& map, const CMazeMapper& mapper, const int& currentVertex, vector<int>& outputRoute,
+		const SRouteChoice& choice, const CCostModel& costModel)
+{
+	DEBUG_METHOD();
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+	auto elapsed = [&]() { return chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count(); };
+
+	m_lastDepth = 0;
+	m_lastToursEvaluated = 0;
+	m_lastBudgetExceeded = false;
+
+	// Greedy choice first, so that we can stop at any time
+	if (!mapper.ComputeNextVertex(graph, currentVertex, outputRoute, choice))
+		return false;
+	if (m_budget <= 0 || mapper.CountVertsToExplore() < 2)
+		return true;
+
+	// -- Candidates -- //
+	// The nearest reachable vertices to explore. The vertices come in score order, and the sort is
+	// stable, so ties in distance are broken in the same way as the greedy choice.
+	struct SCandidate
+	{
+		int m_vertex;
+		int m_row;
+		int m_col;
+		double m_distance;
+		double m_gain;
+		unsigned int m_order;
+	};
+	vector<SCandidate> candidates;
+	vector<int> vertsToExplore = mapper.GetVertsToExplore();
+	for (unsigned int i = 0; i < vertsToExplore.size(); ++i)
+	{
+		SCandidate candidate;
+		candidate.m_vertex = vertsToExplore[i];
+		candidate.m_order = i;
+
+		vector<int> route;
+		candidate.m_distance = (candidate.m_vertex == currentVertex) ? 0
+				: graph.ShortestDistance(currentVertex, candidate.m_vertex, true, route);
+		if (candidate.m_distance == -1 || !mapper.RoomToExplore(candidate.m_vertex, candidate.m_row, candidate.m_col))
+			continue;
+		candidate.m_distance = mapper.RouteCost(route, candidate.m_distance, choice);
+
+		candidate.m_gain = VertexGain(map, candidate.m_row, candidate.m_col);
+		candidates.push_back(candidate);
+
+		// Each candidate costs a Dijkstra run, so on a large map the budget can go here
+		if (elapsed() > m_budget)
+		{
+			m_lastBudgetExceeded = true;
+			return true;
+		}
+	}
+	stable_sort(candidates.begin(), candidates.end(),
+			[](const SCandidate& a, const SCandidate& b) { return a.m_distance < b.m_distance; });
+	if (candidates.size() > m_maxCandidates)
+		candidates.resize(m_maxCandidates);
+
+	// Tours are searched in score order, so that tours which are tied (see SRouteChoice) start at the
+	// vertex the greedy choice would take
+	sort(candidates.begin(), candidates.end(),
+			[](const SCandidate& a, const SCandidate& b) { return a.m_order < b.m_order; });
+	if (candidates.size() < 2)
+		return true;
+
+	// -- Distances between candidates -- //
+	// Unknown rooms are taken to be crossroads, so these are the shortest the later legs can be
+	CMapSnapshot openMap { map };
+	for (int row = 0; row < map.GetRoomHeight(); ++row)
+	{
+		for (int col = 0; col < map.GetRoomWidth(); ++col)
+		{
+			if (openMap.GetRoomType(row, col) == ERoom_Unknown)
+				openMap.SetRoomType(row, col, ERoom_Cross);
+		}
+	}
+	vector<vector<double> > openMatrix = openMap.DistanceMatrix(costModel);
+	vector<int> openLabels(openMatrix.size());
+	for (unsigned int i = 0; i < openLabels.size(); ++i)
+		openLabels[i] = i;
+	CGraph openGraph { openMatrix, openLabels };
+
+	if (elapsed() > m_budget)
+	{
+		m_lastBudgetExceeded = true;
+		return true;
+	}
+
+	unsigned int numCandidates = candidates.size();
+	vector<vector<double> > between(numCandidates, vector<double>(numCandidates, 0));
+	for (unsigned int i = 0; i < numCandidates; ++i)
+	{
+		for (unsigned int j = i + 1; j < numCandidates; ++j)
+		{
+			vector<int> route;
+			between[i][j] = between[j][i] = openGraph.ShortestDistance(candidates[i].m_vertex, candidates[j].m_vertex, true, route);
+		}
+
+		if (elapsed() > m_budget)
+		{
+			m_lastBudgetExceeded = true;
+			return true;
+		}
+	}
+
+	// -- Iterative deepening over tours -- //
+	// The best tour of each length is the one with least travel, with ties going to the tour with
+	// the most gain. As in CMazeMapper::ComputeNextVertex, a tour shorter than the best by less than
+	// choice.m_tieMargin is tied with it. Only the best tour of the longest fully searched length is
+	// used.
+	int bestFirst { -1 };
+	double bestTravel { -1 };
+	double bestGain { -1 };
+	vector<unsigned int> tour;
+	vector<bool> inTour(numCandidates, false);
+
+	// Extends the tour to the given length, scoring each complete tour. Returns false if the budget
+	// has run out. (No DEBUG_METHOD here: it is called for every partial tour.)
+	function<bool(unsigned int, double, double)> search = [&](unsigned int length, double travel, double gain) -> bool
+	{
+		if (tour.size() == length)
+		{
+			++m_lastToursEvaluated;
+			double saving = bestTravel - travel;
+			bool tied = (saving == 0) || fabs(saving) < choice.m_tieMargin;
+			if (bestFirst == -1 || (saving > 0 && !tied) || (tied && gain > bestGain))
+			{
+				bestTravel = travel;
+				bestGain = gain;
+				bestFirst = tour[0];
+			}
+			return (m_lastToursEvaluated % 64 != 0) || elapsed() <= m_budget;
+		}
+
+		for (unsigned int i = 0; i < numCandidates; ++i)
+		{
+			if (inTour[i])
+				continue;
+
+			bool sameRoom = false;
+			for (unsigned int k = 0; k < tour.size(); ++k)
+			{
+				if (candidates[tour[k]].m_row == candidates[i].m_row && candidates[tour[k]].m_col == candidates[i].m_col)
+					sameRoom = true;
+			}
+			if (sameRoom || (!tour.empty() && between[tour.back()][i] == -1))
+				continue;
+
+			double step = tour.empty() ? candidates[i].m_distance : between[tour.back()][i];
+
+			// Prune tours which are already longer than the best tour of this length
+			if (bestFirst != -1 && travel + step > bestTravel + choice.m_tieMargin)
+				continue;
+
+			inTour[i] = true;
+			tour.push_back(i);
+			bool inBudget = search(length, travel + step, gain + candidates[i].m_gain);
+			tour.pop_back();
+			inTour[i] = false;
+
+			if (!inBudget)
+				return false;
+		}
+
+		return true;
+	};
+
+	int bestCompleteFirst { -1 };
+	for (unsigned int length = 1; length <= numCandidates; ++length)
+	{
+		bestFirst = -1;
+		if (!search(length, 0, 0))
+		{
+			m_lastBudgetExceeded = true;
+			break;
+		}
+
+		// There are no tours of this length if several candidates lead into the same room
+		if (bestFirst == -1)
+			break;
+
+		m_lastDepth = length;
+		bestCompleteFirst = bestFirst;
+	}
+
+	DEBUG_VALUE_OF(m_lastDepth);
+	DEBUG_VALUE_OF(m_lastToursEvaluated);
+
+	// -- Route to the first vertex of the best tour -- //
+	if (bestCompleteFirst != -1 && candidates[bestCompleteFirst].m_vertex != outputRoute.back())
+	{
+		if (candidates[bestCompleteFirst].m_vertex == currentVertex)
+			outputRoute = { currentVertex };
+		else
+			graph.ShortestDistance(currentVertex, candidates[bestCompleteFirst].m_vertex, true, outputRoute);
+	}
+
+	return true;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function estimates the information gained by exploring a room of unknown type: one for the
+ * room itself, plus one for each neighbouring room of unknown type (which the room may lead on to).
+ */
+double CLookaheadPlanner::VertexGain(const CMap& map, int row, int col) const
+{
+	DEBUG_METHOD();
+
+	const int rowStep[4] = { -1, 0, 1, 0 };
+	const int colStep[4] = { 0, 1, 0, -1 };
+
+	double gain = 1;
+	for (int side = 0; side < 4; ++side)
+	{
+		int otherRow = row + rowStep[side];
+		int otherCol = col + colStep[side];
+		if (otherRow >= 0 && otherRow < map.GetRoomHeight() && otherCol >= 0 && otherCol < map.GetRoomWidth()
+				&& map.GetRoomType(otherRow, otherCol) == ERoom_Unknown)
+			gain += 1;
+	}
+
+	return gain;
+}
@@ -0,0 +1,78 @@
+/*
+ * CLookaheadPlanner.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CLOOKAHEADPLANNER_H_
+#define SRC_CLOOKAHEADPLANNER_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "CMap.h"
+#include "CGraph.h"
+#include "CMazeMapper.h"
+#include "CCostModel.h"
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to choose the next vertex to explore in challenge two by looking several vertices
+ * ahead, rather than just going to the nearest one (as CMazeMapper does).
+ *
+ * On mazes with loops the nearest vertex often leads away from other unexplored rooms, and the
+ * robot has to come back for them later. The planner instead looks at tours of the nearest few
+ * vertices to explore, and heads for the start of the tour with the least expected travel. The
+ * legs of a tour after the first are measured as if the unknown rooms were all open, since the
+ * rooms explored on the way may well open a shorter way than the known map allows. Ties are
+ * broken by the expected information gain: one for each room explored plus one for each unknown
+ * room next to it, since such rooms are likely to lead on to more of the maze.
+ *
+ * The planner is 'anytime'. It first finds the greedy (nearest) vertex, then searches tours of
+ * length 1, 2, 3, ... (iterative deepening) until the CPU budget runs out, and returns the first
+ * vertex of the best of the longest tours it finished searching. With a budget of zero it is
+ * exactly the greedy choice.
+ *
+ * Public Constructors:
+ *    - CLookaheadPlanner(budget, maxCandidates) - Budget in microseconds per decision, and the
+ *    	number of nearest vertices to explore which are considered for tours.
+ *
+ * Public Methods:
+ *    - ComputeNextVertex(...) - As CMazeMapper::ComputeNextVertex, but looking ahead.
+ *    - SetBudget/GetBudget - The CPU budget per decision, in microseconds.
+ *    - GetLastDepth() - The longest tour length fully searched in the last decision.
+ *    - GetLastToursEvaluated() - The number of tours evaluated in the last decision.
+ *    - WasLastBudgetExceeded() - Whether the last decision ran out of time.
+ *
+ */
+class CLookaheadPlanner
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CLookaheadPlanner(double budget = 5000, unsigned int maxCandidates = 6);
+
+	// === Public Functions =========================================================================
+	bool ComputeNextVertex(CGraph& graph, const CMap& map, const CMazeMapper& mapper, const int& currentVertex, std::vector<int>& outputRoute,
+			const SRouteChoice& choice = SRouteChoice(), const CCostModel& costModel = CCostModel::Default());
+
+	// Access functions
+	void SetBudget(double budget) {m_budget = budget;}
+	double GetBudget() const {return m_budget;}
+	unsigned int GetLastDepth() const {return m_lastDepth;}
+	unsigned int GetLastToursEvaluated() const {return m_lastToursEvaluated;}
+	bool WasLastBudgetExceeded() const {return m_lastBudgetExceeded;}
+
+private:
+	// === Private Functions ========================================================================
+	double VertexGain(const CMap& map, int row, int col) const;
+
+	// === Member Variables =========================================================================
+	double m_budget;
+	unsigned int m_maxCandidates;
+
+	// Statistics of the last decision
+	unsigned int m_lastDepth;
+	unsigned int m_lastToursEvaluated;
+	bool m_lastBudgetExceeded;
+};
+
+#endif /* SRC_CLOOKAHEADPLANNER_H_ */
@@ -44,8 +44,8 @@ CMap::CMap(string filepath)
 	//////////////////////////////////////////////////////////////////////////////////////
 	// Entrance and exit predefined
 
-	m_firstRoom = m_cellheight*m_cellwidth;
-	m_exitRoom = m_cellwidth-1;
+	m_firstRoom = (m_cellheight/3 - 1)*(m_cellwidth/3);	// Bottom left room
+	m_exitRoom = m_cellwidth/3 - 1;						// Top right room
 
 	m_entranceCell = {3*m_firstRoom , 2};
 	m_exitCell = {2, 3*m_cellwidth};
@@ -68,29 +68,25 @@ CMap::CMap(string filepath)
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Initialiser for unknown map.
+// Initialiser for unknown map. Every room is ERoom_Unknown and the robot is at the entrance.
 CMap::CMap(int room_height, int room_width)
 {
 	DEBUG_METHOD();
 
-	m_cellMap = vector<vector<int>> (room_height * 3, vector<int>(room_width * 3));
+	m_roomMap = vector<vector<ERoom>>(room_height, vector<ERoom>(room_width, ERoom_Unknown));
+	m_cellheight = room_height * 3;
+	m_cellwidth = room_width * 3;
 
-	for(int i=0; i<room_height; i++)
-	{
-		for(int j=0; j<room_width; j++)
-		{
-			m_cellMap[3*i][3*j] = 0;
-			m_cellMap[3*i+2][3*j] = 0;
-			m_cellMap[3*i][3 * j+2] = 0;
-			m_cellMap[3*i+2][3 * j+2] = 0;
-			m_cellMap[3*i+1][3 * j+1] = -1;
-			m_cellMap[3*i][3*j+1] = -1;
-			m_cellMap[3*i+1][3*j+2] = -1;
-			m_cellMap[3*i+2][3*j+1] = -1;
-			m_cellMap[3*i + 1][3*j] = -1;
+	UpdateCellMap();
 
-}
-	}
+	m_firstRoom = (room_height - 1)*room_width;
+	m_exitRoom = room_width - 1;
+
+	m_currentVertex = GetEntranceVertex();
+	m_currentOrientation = EOrientation_North;
+
+	m_currentRoom.resize(2);
+	m_currentRoom[0] = ENTRANCEPORCHROOM;
 }
 
 // ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -262,6 +258,11 @@ ERoom CMap::GetRoomType(int room_index) const
 	return m_roomMap[coords[0]][coords[1]];
 }
 
+ERoom CMap::GetRoomType(int row, int col) const
+{
+	return m_roomMap.at(row).at(col);
+}
+
 
 // ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 vector<vector<int>> CMap::GetCellMap() const
@@ -325,123 +326,156 @@ void CMap::UpdateCellMap()
 
 		for (size_t j = 0; j < m_roomMap[i].size(); j++)
 		{
-			m_cellMap[3*i][3*j] = 0;
-			m_cellMap[3*i+2][3*j] = 0;
-			m_cellMap[3*i][3 * j+2] = 0;
-			m_cellMap[3*i+2][3 * j+2] = 0;
-			m_cellMap[3*i+1][3 * j+1] = 1;
-
-
-			switch (m_roomMap[i][j])
-			{
-				case ERoom_Empty:
-				{
-					m_cellMap[3 * i + 1][3*j + 1] = 0;
-					break;
-				}
-				case ERoom_Cross:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					m_cellMap[3*i + 1][3*j] = 1;
-					break;
-				}
-				case ERoom_North:
-				{
-					m_cellMap[3*i][3*j + 1] = 1;
-					break;
-				}
-				case ERoom_East:
-				{
-					m_cellMap[3*i + 1][3*j + 2] = 1;
-					break;
-				}
-				case ERoom_South:
-				{
-					m_cellMap[3*i + 2][3*j + 1] = 1;
-					break;
-				}
-				case ERoom_West:
-				{
-					m_cellMap[3*i + 1][3*j] = 1;
-					break;
-				}
-				case ERoom_NorthEast:
-				{
-					m_cellMap[3*i][3*j + 1] = 1;
-					m_cellMap[3*i + 1][3*j + 2] = 1;
-					break;
-				}
-				case ERoom_NorthSouth:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					break;
-				}
-				case ERoom_NorthWest:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-				case ERoom_EastSouth:
-				{
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					break;
-				}
-				case ERoom_EastWest:
-				{
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-				case ERoom_SouthWest:
-				{
-					m_cellMap[3*i+2][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-				case ERoom_NorthEastSouth:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					break;
-				}
-				case ERoom_NorthEastWest:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-				case ERoom_NorthSouthWest:
-				{
-					m_cellMap[3*i][3*j+1] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-				case ERoom_EastSouthWest:
-				{
-					m_cellMap[3*i+1][3*j+2] = 1;
-					m_cellMap[3*i+2][3*j+1] = 1;
-					m_cellMap[3*i+1][3*j] = 1;
-					break;
-				}
-			}
+			UpdateRoomCells(i, j);
+		}
+	}
+}
 
-				}
-			}
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Writes the 3x3 cells of a single room from its room type. Unknown rooms have -1 in the centre
+// and on each side.
+void CMap::UpdateRoomCells(int i, int j)
+{
+	m_cellMap[3*i][3*j] = 0;
+	m_cellMap[3*i+2][3*j] = 0;
+	m_cellMap[3*i][3 * j+2] = 0;
+	m_cellMap[3*i+2][3 * j+2] = 0;
+	m_cellMap[3*i+1][3 * j+1] = 1;
+	m_cellMap[3*i][3*j+1] = 0;
+	m_cellMap[3*i+1][3*j+2] = 0;
+	m_cellMap[3*i+2][3*j+1] = 0;
+	m_cellMap[3*i+1][3*j] = 0;
+
+
+	switch (m_roomMap[i][j])
+	{
+		case ERoom_Empty:
+		{
+			m_cellMap[3 * i + 1][3*j + 1] = 0;
+			break;
 		}
+		case ERoom_Cross:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			m_cellMap[3*i + 1][3*j] = 1;
+			break;
+		}
+		case ERoom_North:
+		{
+			m_cellMap[3*i][3*j + 1] = 1;
+			break;
+		}
+		case ERoom_East:
+		{
+			m_cellMap[3*i + 1][3*j + 2] = 1;
+			break;
+		}
+		case ERoom_South:
+		{
+			m_cellMap[3*i + 2][3*j + 1] = 1;
+			break;
+		}
+		case ERoom_West:
+		{
+			m_cellMap[3*i + 1][3*j] = 1;
+			break;
+		}
+		case ERoom_NorthEast:
+		{
+			m_cellMap[3*i][3*j + 1] = 1;
+			m_cellMap[3*i + 1][3*j + 2] = 1;
+			break;
+		}
+		case ERoom_NorthSouth:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			break;
+		}
+		case ERoom_NorthWest:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_EastSouth:
+		{
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			break;
+		}
+		case ERoom_EastWest:
+		{
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_SouthWest:
+		{
+			m_cellMap[3*i+2][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_NorthEastSouth:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			break;
+		}
+		case ERoom_NorthEastWest:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_NorthSouthWest:
+		{
+			m_cellMap[3*i][3*j+1] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_EastSouthWest:
+		{
+			m_cellMap[3*i+1][3*j+2] = 1;
+			m_cellMap[3*i+2][3*j+1] = 1;
+			m_cellMap[3*i+1][3*j] = 1;
+			break;
+		}
+		case ERoom_Unknown:
+		{
+			m_cellMap[3*i+1][3*j+1] = -1;
+			m_cellMap[3*i][3*j+1] = -1;
+			m_cellMap[3*i+1][3*j+2] = -1;
+			m_cellMap[3*i+2][3*j+1] = -1;
+			m_cellMap[3*i+1][3*j] = -1;
+			break;
+		}
+	}
+}
 
 void CMap::SetCurrentRoomType(ERoom roomType)
 {	
-	m_roomMap[m_currentRoom[0]][m_currentRoom[1]] = roomType;
-	UpdateCellMap();
-	}
+	SetRoomType(m_currentRoom[0], m_currentRoom[1], roomType);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sets the type of a single room. Only the cells of that room are rewritten.
+void CMap::SetRoomType(int row, int col, ERoom roomType)
+{
+	DEBUG_METHOD();
+
+	m_roomMap.at(row).at(col) = roomType;
+
+	// Keep any block which is in the room
+	bool hasBlock = (m_cellMap[3*row+1][3*col+1] == 2);
+	UpdateRoomCells(row, col);
+	if (hasBlock) m_cellMap[3*row+1][3*col+1] = 2;
+}
 
 
 void CMap::CalculateBlockRooms(vector<int>* pBlockRooms) const
@@ -449,13 +483,13 @@ void CMap::CalculateBlockRooms(vector<int>* pBlockRooms) const
 	DEBUG_METHOD();
 	pBlockRooms->clear();
 
-	for(int i=1; i<m_cellwidth; i+=3)
+	for(int i=1; i<m_cellheight; i+=3)
 	{
-		for(int j=1; j<m_cellheight; j+=3)
+		for(int j=1; j<m_cellwidth; j+=3)
 		{
 			if(m_cellMap[i][j] ==2)
 			{
-				pBlockRooms->push_back((((i-1)*m_cellwidth)/3) + (j-1)/3);
+				pBlockRooms->push_back(((i-1)/3)*(m_cellwidth/3) + (j-1)/3);
 			}
 		}
 	}
@@ -502,7 +536,7 @@ vector<int> CMap::CalculateRoomVertices(vector<int> coord) const
 
 	roomVertices.push_back(coord[0]*(2*(m_cellwidth/3)+1) +2*coord[1] +1);  // North
 	roomVertices.push_back(coord[0]*(2*(m_cellwidth/3)+1) +2*coord[1] +2);  // East
-	roomVertices.push_back((coord[0]+1)*(2*(m_cellwidth/3)+1) +2*coord[1]); // South
+	roomVertices.push_back((coord[0]+1)*(2*(m_cellwidth/3)+1) +2*coord[1] +1); // South
 	roomVertices.push_back(coord[0]*(2*(m_cellwidth/3)+1) +2*coord[1]);     // West
 
 	return roomVertices;
@@ -643,22 +677,37 @@ vector<int> CMap::GetRoomVertices(ERoom room_type)
 	return vertex_flag;
 }
 
-int CMap::GetEntranceVertex() const
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// This is the inverse of GetRoomVertices. It takes the vertices of a room as a vector with 1 for
+// vertex and 0 for no vertex, in the order North East South West, and returns the room type.
+ERoom CMap::RoomFromVertices(const vector<int>& vertex_flag)
 {
 	DEBUG_METHOD();
 
-	vector<int> coord = {m_cellwidth/3, 0}; // TODO: should be m_cellheight here? (even if it is academic when they're both equal!)
+	for (int room_type = 0; room_type < ERoom_Unknown; ++room_type)
+	{
+		if (GetRoomVertices(static_cast<ERoom>(room_type)) == vertex_flag)
+			return static_cast<ERoom>(room_type);
+	}
 
-	return (coord[0]+1)*(2*m_cellwidth+1) + 2*coord[1] +1;
+	return ERoom_Unknown;
 }
 
-int CMap::GetExitVertex() const
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The entrance is off the bottom of the bottom left room, and the exit is off the top of the top
+// right room.
+int CMap::GetEntranceVertex() const
 {
 	DEBUG_METHOD();
 
-	vector<int> coord = {0, m_cellwidth/3};
+	return CalculateRoomVertices(m_firstRoom)[2];
+}
+
+int CMap::GetExitVertex() const
+{
+	DEBUG_METHOD();
 
-	return (coord[0])*(2*m_cellwidth+1) + 2*coord[1] +2; // TODO: Should be +1 here? Is the exit not off the top rather than the right?
+	return CalculateRoomVertices(m_exitRoom)[0];
 }
 
 int CMap::GetCurrentVertex() const
@@ -694,8 +743,9 @@ vector<int> CMap::RoomIndextoCoord(int room_index) const
 {
 	DEBUG_METHOD();
 
-	int row_index = room_index/(2*m_cellwidth +1);
-	int col_index = room_index % (2*m_cellwidth +1);
+	// Rooms are numbered row by row, so the room width gives the row and column.
+	int row_index = room_index/(m_cellwidth/3);
+	int col_index = room_index % (m_cellwidth/3);
 
 	vector<int> roomCoord = {row_index, col_index};
 	return roomCoord;
@@ -706,42 +756,16 @@ void CMap::FollowInstructions(CInstructions &inputInstructions)
 {
 	DEBUG_METHOD();
 
-	//////////////////////////////////////////////////////////////////////////////////////
-	// Check we are at start vertex.
-
-	int current_vertex = GetCurrentVertex();
-
-	vector<EInstruction> instructionList = inputInstructions.GetInstructions();
-	vector<ERoom> roomList = inputInstructions.GetRoomList();
-	vector<EOrientation> oreintationList = inputInstructions.GetOrientations();
-
-	if (current_vertex != instructionList[0]) CSignals::Error();
-
-	for (int i = 0; i < instructionList.size(); i++)
-	{
-		CManouvre::InstructionToManouvre(instructionList[i]);
-	}
+	CManouvre::FollowInstructions(inputInstructions.GetInstructions());
 }
 
 EInstruction CMap::FollowInstructionsNotLast(CInstructions & inputInstructions)
 {
 	DEBUG_METHOD();
 
-	//////////////////////////////////////////////////////////////////////////////////////
-	// Check we are at start vertex.
-
-	int current_vertex = GetCurrentVertex();
+	const vector<EInstruction>& instructionList = inputInstructions.GetInstructions();
 
-	vector<EInstruction> instructionList = inputInstructions.GetInstructions();
-	vector<ERoom> roomList = inputInstructions.GetRoomList();
-	vector<EOrientation> oreintationList = inputInstructions.GetOrientations();
-
-	if (current_vertex != instructionList[0]) CSignals::Error();
-
-	for (int i = 0; i < instructionList.size()-1; i++)
-	{
-		CManouvre::InstructionToManouvre(instructionList[i]);
-	}
+	CManouvre::FollowInstructions(vector<EInstruction>(instructionList.begin(), instructionList.end()-1));
 
 	return instructionList[instructionList.size()-1];
 }
@@ -752,6 +776,16 @@ void CMap::populateDistanceMatrixFromArray(std::vector<int> roomVertices, int ro
 {
 	DEBUG_METHOD();
 
+	populateDistanceMatrixFromArray(m_distanceMatrix, roomVertices, rowCoordinate, columnCoordinate, roomWidth);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static version of the above which writes the edges of one room into the supplied distance matrix.
+// This lets map snapshots (see CMapSnapshot) build distance matrices without a full CMap.
+// The edge weights come from the cost model (by default STRAIGHT_PATH_WEIGHT and CORNER_PATH_WEIGHT).
+void CMap::populateDistanceMatrixFromArray(std::vector<std::vector<double>>& distanceMatrix, std::vector<int> roomVertices, int rowCoordinate, int columnCoordinate, int roomWidth, const CCostModel& costModel)
+{
+
 	int n = roomWidth;
 
 	// x = i(2n + 1) + 2j
@@ -762,7 +796,7 @@ void CMap::populateDistanceMatrixFromArray(std::vector<int> roomVertices, int ro
 	int j_coordinate = columnCoordinate;
 
 	int vertexA_Coordinate = 0, vertexB_Coordinate = 0;
-	int edge_Magnitude;
+	double edge_Magnitude;
 
 	int firstVertexOfRoom = i_coordinate * ((2 * n) + 1) + 2 * j_coordinate;
 
@@ -780,33 +814,34 @@ void CMap::populateDistanceMatrixFromArray(std::vector<int> roomVertices, int ro
 
 	for (int i = 0; i < 4; i++)
 	{
-		if (roomVertices.at(i) != 0)
+		// Unknown rooms have flags of -1 and are not known to be passable, so only 1 counts as an exit
+		if (roomVertices.at(i) == 1)
 		{
-			// if != 0, the a coordinate is convertedVertexArray[i]
+			// if == 1, the a coordinate is convertedVertexArray[i]
 
 			vertexA_Coordinate = convertedVertexArray[i];
 
 			// loop through the rest of the integers in the array to see if any of them are non-zero
 			for (int j = i + 1; j < 4; j++) {
 
-				// if there is another non-zero value, the b coordinate is convertedVertexArray[j]
-				if (roomVertices.at(j) != 0) {
+				// if there is another exit, the b coordinate is convertedVertexArray[j]
+				if (roomVertices.at(j) == 1) {
 					vertexB_Coordinate = convertedVertexArray[j];
 
 					// coordinates are only added if both vertices are non-zero
 					if (j == i + 1 || j == i + 3) {
-						edge_Magnitude = CORNER_PATH_WEIGHT;
+						edge_Magnitude = costModel.CornerCost();
 					}
 					else if (j == i + 2) {
-						edge_Magnitude = STRAIGHT_PATH_WEIGHT;
+						edge_Magnitude = costModel.StraightCost();
 }
 					else { edge_Magnitude = -1; }
 
 
 					// Add two entries to distance matrix.
 
-					m_distanceMatrix.at(vertexB_Coordinate).at(vertexA_Coordinate) = edge_Magnitude;
-					m_distanceMatrix.at(vertexA_Coordinate).at(vertexB_Coordinate) = edge_Magnitude;
+					distanceMatrix.at(vertexB_Coordinate).at(vertexA_Coordinate) = edge_Magnitude;
+					distanceMatrix.at(vertexA_Coordinate).at(vertexB_Coordinate) = edge_Magnitude;
 				
 				}
 			}
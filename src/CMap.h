@@ -13,6 +13,7 @@
 
 #include "EnumsHeader.h"
 #include "Instructions.h"
+#include "CCostModel.h"
 #include<vector>
 #include<string>
 
@@ -47,12 +48,16 @@ private:
 public:
 	std::vector<std::vector<ERoom>>	GetRoomMap() const;
 	ERoom GetRoomType(int room_index) const;
+	ERoom GetRoomType(int row, int col) const;
+	int GetRoomHeight() const { return m_cellheight/3; }
+	int GetRoomWidth() const { return m_cellwidth/3; }
 	std::vector<std::vector<int>> GetCellMap() const;
 	int GetEntranceRoom() const;
 	int GetExitRoom() const;
 	std::vector<int> GetEntranceCell() const;
 	std::vector<int> GetExitCell() const;
 	static std::vector<int> GetRoomVertices(ERoom room_type);
+	static ERoom RoomFromVertices(const std::vector<int>& vertex_flag);
 	int GetEntranceVertex() const;
 	int GetExitVertex() const;
 
@@ -69,6 +74,7 @@ public:
 	void UpdateRoomMap();
 	void UpdateCellMap();
 	void SetCurrentRoomType(ERoom roomType);
+	void SetRoomType(int row, int col, ERoom roomType);
 	void CalculateBlockRooms(std::vector<int> *pBlockRooms) const;
 	std::vector<int> CalculateRoomVertices(int room_index) const;
 	std::vector<int> CalculateRoomVertices(int row, int col) const;
@@ -79,6 +85,7 @@ public:
 	std::vector<std::vector<double>> DistanceMatrix();		// recomputes distance matrix
 	std::vector<std::vector<double>> GetDistanceMatrix();	// Doesnt recompute.
 	void populateDistanceMatrixFromArray(std::vector<int> roomVertices, int rowCoordinate, int columnCoordinate, int roomWidth);
+	static void populateDistanceMatrixFromArray(std::vector<std::vector<double>>& distanceMatrix, std::vector<int> roomVertices, int rowCoordinate, int columnCoordinate, int roomWidth, const CCostModel& costModel = CCostModel::Default());
 
 	void WriteCellMap(std::string filepath);
 
@@ -87,6 +94,7 @@ public:
 private:
 	void CreateRoomMap();
 	void ComputeCellMapSize();
+	void UpdateRoomCells(int i, int j);
 	std::vector<int> CalculateRoomVertices(std::vector<int> coord) const;
 	std::vector<int> RoomIndextoCoord(int room_index) const;
 	
@@ -0,0 +1,242 @@
+/*
+ * CMapSnapshot.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMapSnapshot.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (constructor) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This constructor takes a snapshot of the room types and the rooms containing blocks of a CMap.
+ * Later changes to the CMap are not seen by the snapshot (and vice versa).
+ */
+CMapSnapshot::CMapSnapshot(const CMap& map)
+{
+	DEBUG_METHOD();
+
+	vector<int> blockRooms;
+	map.CalculateBlockRooms(&blockRooms);
+
+	Initialise(map.GetRoomMap(), blockRooms);
+}
+
+/* ~~~ FUNCTION (constructor) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This constructor builds a snapshot directly from a room map and a list of the (linear) indices
+ * of the rooms containing blocks.
+ */
+CMapSnapshot::CMapSnapshot(const vector<vector<ERoom> >& roomMap, const vector<int>& blockRooms)
+{
+	DEBUG_METHOD();
+
+	Initialise(roomMap, blockRooms);
+}
+
+
+// -/-/-/-/-/-/-/ ACCESS FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+ERoom CMapSnapshot::GetRoomType(int row, int col) const
+{
+	return m_tiles[TileIndex(row, col)]->m_rooms[CellIndex(row, col)];
+}
+
+ERoom CMapSnapshot::GetRoomType(int room_index) const
+{
+	return GetRoomType(room_index / m_roomWidth, room_index % m_roomWidth);
+}
+
+bool CMapSnapshot::HasBlock(int room_index) const
+{
+	int row = room_index / m_roomWidth;
+	int col = room_index % m_roomWidth;
+
+	return m_tiles[TileIndex(row, col)]->m_blocks[CellIndex(row, col)];
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function lists the (linear) indices of the rooms containing blocks, in increasing order.
+ * It mirrors CMap::CalculateBlockRooms.
+ */
+void CMapSnapshot::CalculateBlockRooms(vector<int>* pBlockRooms) const
+{
+	DEBUG_METHOD();
+
+	pBlockRooms->clear();
+
+	for (int i = 0; i < m_roomHeight*m_roomWidth; ++i)
+	{
+		if (HasBlock(i))
+			pBlockRooms->push_back(i);
+	}
+}
+
+vector<vector<ERoom> > CMapSnapshot::GetRoomMap() const
+{
+	DEBUG_METHOD();
+
+	vector<vector<ERoom> > roomMap(m_roomHeight, vector<ERoom>(m_roomWidth));
+	for (int i = 0; i < m_roomHeight; ++i)
+	{
+		for (int j = 0; j < m_roomWidth; ++j)
+			roomMap[i][j] = GetRoomType(i, j);
+	}
+
+	return roomMap;
+}
+
+
+// -/-/-/-/-/-/-/ HYPOTHESIS FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function returns a new snapshot sharing every tile with this one. It costs one pointer per
+ * tile. Writing to either snapshot afterwards copies only the tile written to.
+ */
+CMapSnapshot CMapSnapshot::Fork() const
+{
+	DEBUG_METHOD();
+
+	return *this;
+}
+
+void CMapSnapshot::SetRoomType(int row, int col, ERoom roomType)
+{
+	DEBUG_METHOD();
+
+	if (GetRoomType(row, col) == roomType)
+		return;
+
+	WritableTile(row, col).m_rooms[CellIndex(row, col)] = roomType;
+}
+
+void CMapSnapshot::SetBlock(int room_index, bool hasBlock)
+{
+	DEBUG_METHOD();
+
+	if (HasBlock(room_index) == hasBlock)
+		return;
+
+	int row = room_index / m_roomWidth;
+	int col = room_index % m_roomWidth;
+	WritableTile(row, col).m_blocks[CellIndex(row, col)] = hasBlock;
+}
+
+
+// -/-/-/-/-/-/-/ PLANNING FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function computes the distance matrix for the snapshot, using the same vertex numbering
+ * and edge weights as CMap::DistanceMatrix, or the edge weights of another cost model. Rooms
+ * containing a block are treated as impassable. The result can be passed straight to the CGraph
+ * constructor.
+ */
+vector<vector<double> > CMapSnapshot::DistanceMatrix(const CCostModel& costModel) const
+{
+	DEBUG_METHOD();
+
+	int n = m_roomWidth;
+	int distanceMatrixSize = n*(n + 1) + (n + 1)*(n + 1);
+
+	vector<vector<double> > distanceMatrix(distanceMatrixSize, vector<double>(distanceMatrixSize, -1.0));
+
+	for (int i = 0; i < m_roomHeight; ++i)
+	{
+		for (int j = 0; j < m_roomWidth; ++j)
+		{
+			if (!HasBlock(i*m_roomWidth + j))
+				CMap::populateDistanceMatrixFromArray(distanceMatrix, CMap::GetRoomVertices(GetRoomType(i, j)), i, j, n, costModel);
+		}
+	}
+
+	return distanceMatrix;
+}
+
+
+// -/-/-/-/-/-/-/ DIAGNOSTIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function counts the tiles which are physically shared (not just equal) with another
+ * snapshot of the same size. It is mainly useful to check how much a hypothesis has cost.
+ */
+unsigned int CMapSnapshot::CountSharedTiles(const CMapSnapshot& other) const
+{
+	DEBUG_METHOD();
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < m_tiles.size() && i < other.m_tiles.size(); ++i)
+	{
+		if (m_tiles[i] == other.m_tiles[i])
+			++count;
+	}
+
+	return count;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CMapSnapshot::Initialise(const vector<vector<ERoom> >& roomMap, const vector<int>& blockRooms)
+{
+	DEBUG_METHOD();
+
+	m_roomHeight = roomMap.size();
+	m_roomWidth = (m_roomHeight > 0) ? roomMap[0].size() : 0;
+	m_tileColumns = (m_roomWidth + TILESIZE - 1) / TILESIZE;
+	int tileRows = (m_roomHeight + TILESIZE - 1) / TILESIZE;
+
+	m_tiles.clear();
+	m_tiles.reserve(tileRows*m_tileColumns);
+	for (int i = 0; i < tileRows*m_tileColumns; ++i)
+	{
+		shared_ptr<STile> pTile = make_shared<STile>();
+		for (int k = 0; k < TILESIZE*TILESIZE; ++k)
+		{
+			pTile->m_rooms[k] = ERoom_Unknown;
+			pTile->m_blocks[k] = false;
+		}
+		m_tiles.push_back(pTile);
+	}
+
+	for (int i = 0; i < m_roomHeight; ++i)
+	{
+		for (unsigned int j = 0; j < roomMap[i].size() && j < (unsigned)m_roomWidth; ++j)
+			m_tiles[TileIndex(i, j)]->m_rooms[CellIndex(i, j)] = roomMap[i][j];
+	}
+
+	for (unsigned int i = 0; i < blockRooms.size(); ++i)
+	{
+		int row = blockRooms[i] / m_roomWidth;
+		int col = blockRooms[i] % m_roomWidth;
+		m_tiles[TileIndex(row, col)]->m_blocks[CellIndex(row, col)] = true;
+	}
+}
+
+unsigned int CMapSnapshot::TileIndex(int row, int col) const
+{
+	if (row < 0 || row >= m_roomHeight || col < 0 || col >= m_roomWidth)
+		throw Exception_RoomOutOfRange { row, col };
+
+	return (row / TILESIZE)*m_tileColumns + col / TILESIZE;
+}
+
+unsigned int CMapSnapshot::CellIndex(int row, int col) const
+{
+	return (row % TILESIZE)*TILESIZE + col % TILESIZE;
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function returns the tile containing a room, ready to be written to. If the tile is shared
+ * with another snapshot then it is copied first, so that the other snapshot does not see the write.
+ *
+ * If use_count() is 1 then nobody else holds the tile and nobody else can start to, since only this
+ * snapshot can hand out a copy of the pointer. If it is larger we copy, which is at worst an
+ * unnecessary copy if another snapshot lets go of the tile concurrently.
+ */
+CMapSnapshot::STile& CMapSnapshot::WritableTile(int row, int col)
+{
+	shared_ptr<STile>& pTile = m_tiles[TileIndex(row, col)];
+
+	if (pTile.use_count() > 1)
+		pTile = make_shared<STile>(*pTile);
+
+	return *pTile;
+}
@@ -0,0 +1,112 @@
+/*
+ * CMapSnapshot.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMAPSNAPSHOT_H_
+#define SRC_CMAPSNAPSHOT_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "CMap.h"
+#include <vector>
+#include <memory>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to hold a cheap copy of the rooms of a CMap, so that planners (e.g. in challenge
+ * four) can try out hypotheses such as "the block is in room X" without touching the real map.
+ *
+ * The rooms are stored in square tiles of TILESIZE x TILESIZE rooms. Copying a snapshot only
+ * copies the pointers to the tiles, so the tiles are shared between the copies. A tile is only
+ * copied when one of the snapshots sharing it is written to (copy-on-write). A hypothetical map
+ * therefore only costs the tiles containing the rooms which differ from the map it was forked from.
+ *
+ * Rooms are indexed either by (row, col) or by the linear room index row*width + col, as in CMap.
+ *
+ * Public Constructors:
+ *    - CMapSnapshot(const CMap&) - Takes a snapshot of the room types and blocks of a CMap.
+ *    - CMapSnapshot(roomMap, blockRooms) - Builds a snapshot directly from a room map.
+ *
+ * Public Methods:
+ *    - Fork() - Returns a copy sharing all of its tiles with this snapshot.
+ *    - GetRoomType/SetRoomType - Read and write the type of a room.
+ *    - HasBlock/SetBlock - Read and write whether a room contains a block.
+ *    - DistanceMatrix(costModel) - Computes the distance matrix of the snapshot in the same way as
+ *    	CMap::DistanceMatrix (rooms containing blocks are not passable), with the edge weights of
+ *    	the cost model.
+ *    - CountSharedTiles(...) - Counts the tiles shared with another snapshot.
+ *
+ * Thread Safety:
+ *    Different snapshots may be used (and written to) on different threads at the same time, even
+ *    if they share tiles. A single snapshot must not be used by two threads at once.
+ *
+ * Exceptions:
+ * 	- Exception_RoomOutOfRange - Thrown when a room outside the map is requested.
+ *
+ */
+class CMapSnapshot
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMapSnapshot(const CMap& map);
+	CMapSnapshot(const std::vector<std::vector<ERoom> >& roomMap, const std::vector<int>& blockRooms);
+
+	// === Public Functions =========================================================================
+	// Access functions
+	int GetRoomHeight() const {return m_roomHeight;}
+	int GetRoomWidth() const {return m_roomWidth;}
+	ERoom GetRoomType(int row, int col) const;
+	ERoom GetRoomType(int room_index) const;
+	bool HasBlock(int room_index) const;
+	void CalculateBlockRooms(std::vector<int>* pBlockRooms) const;
+	std::vector<std::vector<ERoom> > GetRoomMap() const;
+
+	// Hypothesis functions
+	CMapSnapshot Fork() const;
+	void SetRoomType(int row, int col, ERoom roomType);
+	void SetBlock(int room_index, bool hasBlock);
+
+	// Planning functions
+	std::vector<std::vector<double> > DistanceMatrix(const CCostModel& costModel = CCostModel::Default()) const;
+
+	// Diagnostic functions
+	unsigned int CountTiles() const {return m_tiles.size();}
+	unsigned int CountSharedTiles(const CMapSnapshot& other) const;
+
+	// === Exceptions ===============================================================================
+	struct Exception_RoomOutOfRange
+	{
+		int mm_row;
+		int mm_col;
+		Exception_RoomOutOfRange(int row, int col)
+				: mm_row { row }, mm_col { col }
+		{
+		}
+	};
+
+	// === Constants ================================================================================
+	static const int TILESIZE = 4;
+
+private:
+	// === Private Types ============================================================================
+	struct STile
+	{
+		ERoom m_rooms[TILESIZE*TILESIZE];
+		bool m_blocks[TILESIZE*TILESIZE];
+	};
+
+	// === Private Functions ========================================================================
+	void Initialise(const std::vector<std::vector<ERoom> >& roomMap, const std::vector<int>& blockRooms);
+	unsigned int TileIndex(int row, int col) const;
+	unsigned int CellIndex(int row, int col) const;
+	STile& WritableTile(int row, int col);
+
+	// === Member Variables =========================================================================
+	int m_roomHeight;
+	int m_roomWidth;
+	int m_tileColumns;
+	std::vector<std::shared_ptr<STile> > m_tiles;
+};
+
+#endif /* SRC_CMAPSNAPSHOT_H_ */
@@ -0,0 +1,110 @@
+/*
+ * CMapSnapshot_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CMapSnapshot.h"
+#include "CGraph.h"
+#include <iostream>
+#include <thread>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Label the vertices of a distance matrix 0, 1, 2, ...
+static vector<int> IdentityLabels(unsigned int size)
+{
+	vector<int> labels(size);
+	for (unsigned int i = 0; i < size; ++i)
+		labels[i] = i;
+	return labels;
+}
+
+// Test that snapshots share tiles until written to, and that hypotheses can be evaluated in parallel
+int CMapSnapshot_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CMapSnapshot_test--\n\n";
+
+	int result = 0;
+
+	CMap aMap { "TestData/PracticeMap.csv" };
+	CMapSnapshot baseSnapshot { aMap };
+
+	// A fork should share every tile and have the same distance matrix as the map
+	CMapSnapshot hypothesis = baseSnapshot.Fork();
+	if (hypothesis.CountSharedTiles(baseSnapshot) != baseSnapshot.CountTiles())
+	{
+		cout << "Fork does not share all of its tiles\n";
+		result = 1;
+	}
+	if (baseSnapshot.DistanceMatrix() != aMap.DistanceMatrix())
+	{
+		cout << "Snapshot distance matrix does not match CMap::DistanceMatrix\n";
+		result = 1;
+	}
+
+	// Put a block in one room of the hypothesis. Only one tile should be copied.
+	int blockRoom = 5*baseSnapshot.GetRoomWidth() + 5;
+	hypothesis.SetBlock(blockRoom, true);
+	if (hypothesis.CountSharedTiles(baseSnapshot) != baseSnapshot.CountTiles() - 1)
+	{
+		cout << "Writing one room copied " << baseSnapshot.CountTiles() - hypothesis.CountSharedTiles(baseSnapshot) << " tiles\n";
+		result = 1;
+	}
+	if (baseSnapshot.HasBlock(blockRoom) || !hypothesis.HasBlock(blockRoom))
+	{
+		cout << "Block written to the wrong snapshot\n";
+		result = 1;
+	}
+
+	// Evaluate several hypotheses in parallel: each thread forks the base snapshot, blocks one room
+	// of the bottom row and measures the distance from the bottom left room to the top right room.
+	int startVertex = aMap.CalculateRoomVertices(baseSnapshot.GetRoomHeight() - 1, 0)[2];
+	int endVertex = aMap.CalculateRoomVertices(0, baseSnapshot.GetRoomWidth() - 1)[0];
+
+	vector<vector<double> > baseDistanceMatrix = baseSnapshot.DistanceMatrix();
+	CGraph baseGraph { baseDistanceMatrix, IdentityLabels(baseDistanceMatrix.size()) };
+	vector<int> baseRoute;
+	double baseDistance = baseGraph.ShortestDistance(startVertex, endVertex, baseRoute);
+
+	const int numHypotheses = 4;
+	vector<double> distances(numHypotheses);
+	vector<thread> threads;
+	for (int k = 0; k < numHypotheses; ++k)
+	{
+		threads.push_back(thread([&, k]() {
+			CMapSnapshot threadHypothesis = baseSnapshot.Fork();
+			threadHypothesis.SetBlock((baseSnapshot.GetRoomHeight() - 1)*baseSnapshot.GetRoomWidth() + k + 4, true);
+
+			vector<vector<double> > distanceMatrix = threadHypothesis.DistanceMatrix();
+			CGraph graph { distanceMatrix, IdentityLabels(distanceMatrix.size()) };
+			vector<int> route;
+			distances[k] = graph.ShortestDistance(startVertex, endVertex, route);
+		}));
+	}
+	for (unsigned int k = 0; k < threads.size(); ++k)
+		threads[k].join();
+
+	cout << "Bottom left to top right distance: " << baseDistance << '\n';
+	for (int k = 0; k < numHypotheses; ++k)
+		cout << "  with a block in bottom row room " << k + 4 << ": " << distances[k] << '\n';
+
+	vector<int> baseBlockRooms;
+	baseSnapshot.CalculateBlockRooms(&baseBlockRooms);
+	if (!baseBlockRooms.empty() || baseSnapshot.GetRoomMap() != aMap.GetRoomMap())
+	{
+		cout << "Base snapshot was changed by a hypothesis\n";
+		result = 1;
+	}
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,127 @@
+/*
+ * CMazeGenerator.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMazeGenerator.h"
+#include "CMap.h"
+#include <random>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ DEFINITIONS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Steps to the neighbouring room through each side, in the order North East South West
+static const int ROW_STEP[4] = { -1, 0, 1, 0 };
+static const int COL_STEP[4] = { 0, 1, 0, -1 };
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function generates a random maze.
+ *
+ * INPUTS:
+ * room_height, room_width - The size of the maze in rooms.
+ * seed                    - The seed for the random number generator.
+ * braidFraction           - The probability that each dead end is opened up into a loop. 0 gives a
+ *                           perfect maze and 1 a maze with no dead ends.
+ *
+ * OUTPUT:
+ * The room map of the maze, as CMap::GetRoomMap.
+ *
+ */
+vector<vector<ERoom> > CMazeGenerator::Generate(int room_height, int room_width, unsigned int seed, double braidFraction)
+{
+	DEBUG_METHOD();
+
+	mt19937 generator { seed };
+
+	// exits[i][j][side] is 1 if room (i, j) has an exit through side
+	vector<vector<vector<int> > > exits(room_height, vector<vector<int> >(room_width, vector<int>(4, 0)));
+
+	auto inMaze = [&](int row, int col) { return row >= 0 && row < room_height && col >= 0 && col < room_width; };
+	auto openWall = [&](int row, int col, int side) {
+		exits[row][col][side] = 1;
+		exits[row + ROW_STEP[side]][col + COL_STEP[side]][(side + 2) % 4] = 1;
+	};
+
+	// -- Perfect maze by randomised depth first search from the entrance room -- //
+	vector<vector<bool> > visited(room_height, vector<bool>(room_width, false));
+	vector<pair<int, int> > stack { make_pair(room_height - 1, 0) };
+	visited[room_height - 1][0] = true;
+	while (!stack.empty())
+	{
+		int row = stack.back().first;
+		int col = stack.back().second;
+
+		vector<int> sides;
+		for (int side = 0; side < 4; ++side)
+		{
+			int nextRow = row + ROW_STEP[side];
+			int nextCol = col + COL_STEP[side];
+			if (inMaze(nextRow, nextCol) && !visited[nextRow][nextCol])
+				sides.push_back(side);
+		}
+
+		if (sides.empty())
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		int side = sides[uniform_int_distribution<int>(0, sides.size() - 1)(generator)];
+		openWall(row, col, side);
+		visited[row + ROW_STEP[side]][col + COL_STEP[side]] = true;
+		stack.push_back(make_pair(row + ROW_STEP[side], col + COL_STEP[side]));
+	}
+
+	// -- Braid: open dead ends into a neighbouring room -- //
+	uniform_real_distribution<double> probability(0, 1);
+	for (int row = 0; row < room_height; ++row)
+	{
+		for (int col = 0; col < room_width; ++col)
+		{
+			if (exits[row][col][0] + exits[row][col][1] + exits[row][col][2] + exits[row][col][3] != 1
+					|| probability(generator) >= braidFraction)
+				continue;
+
+			vector<int> sides;
+			for (int side = 0; side < 4; ++side)
+			{
+				if (!exits[row][col][side] && inMaze(row + ROW_STEP[side], col + COL_STEP[side]))
+					sides.push_back(side);
+			}
+			if (!sides.empty())
+				openWall(row, col, sides[uniform_int_distribution<int>(0, sides.size() - 1)(generator)]);
+		}
+	}
+
+	// -- Entrance and exit -- //
+	exits[room_height - 1][0][2] = 1;
+	exits[0][room_width - 1][0] = 1;
+
+	vector<vector<ERoom> > roomMap(room_height, vector<ERoom>(room_width));
+	for (int row = 0; row < room_height; ++row)
+	{
+		for (int col = 0; col < room_width; ++col)
+			roomMap[row][col] = CMap::RoomFromVertices(exits[row][col]);
+	}
+
+	return roomMap;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function generates count mazes, using the seeds firstSeed, firstSeed + 1, ...
+ */
+vector<vector<vector<ERoom> > > CMazeGenerator::GenerateCorpus(unsigned int count, int room_height, int room_width, unsigned int firstSeed, double braidFraction)
+{
+	DEBUG_METHOD();
+
+	vector<vector<vector<ERoom> > > corpus;
+	corpus.reserve(count);
+	for (unsigned int i = 0; i < count; ++i)
+		corpus.push_back(Generate(room_height, room_width, firstSeed + i, braidFraction));
+
+	return corpus;
+}
@@ -0,0 +1,38 @@
+/*
+ * CMazeGenerator.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMAZEGENERATOR_H_
+#define SRC_CMAZEGENERATOR_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to generate random mazes (as room maps) for testing exploration strategies
+ * offline.
+ *
+ * A maze is first generated as a perfect maze (exactly one route between any two rooms) by a
+ * randomised depth first search. It is then 'braided': each dead end is, with a given probability,
+ * opened into a neighbouring room, which creates loops. The entrance is off the bottom of the bottom
+ * left room and the exit is off the top of the top right room, as in CMap.
+ *
+ * The same seed always gives the same maze (for a given standard library).
+ *
+ * Public Methods:
+ *    - Generate(...) - Generates one maze.
+ *    - GenerateCorpus(...) - Generates a number of mazes with consecutive seeds.
+ *
+ */
+class CMazeGenerator
+{
+public:
+	// === Public Functions =========================================================================
+	static std::vector<std::vector<ERoom> > Generate(int room_height, int room_width, unsigned int seed, double braidFraction = 0);
+	static std::vector<std::vector<std::vector<ERoom> > > GenerateCorpus(unsigned int count, int room_height, int room_width, unsigned int firstSeed, double braidFraction = 0);
+};
+
+#endif /* SRC_CMAZEGENERATOR_H_ */
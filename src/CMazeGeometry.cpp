@@ -0,0 +1,114 @@
+/*
+ * CMazeGeometry.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMazeGeometry.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (constructor) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This constructor builds the vertex and room tables for a maze of room_height x room_width rooms.
+ */
+CMazeGeometry::CMazeGeometry(int room_height, int room_width)
+		: m_roomHeight { room_height }, m_roomWidth { room_width }, m_rowLength { 2*room_width + 1 },
+		  m_vertexCount { (room_height + 1)*(2*room_width + 1) }
+{
+	DEBUG_METHOD();
+
+	m_sideOffset[EOrientation_North] = 1;
+	m_sideOffset[EOrientation_East] = 2;
+	m_sideOffset[EOrientation_South] = m_rowLength + 1;
+	m_sideOffset[EOrientation_West] = 0;
+
+	m_offsetSide.assign(m_rowLength + 2, -1);
+	for (int side = 0; side < 4; ++side)
+		m_offsetSide[m_sideOffset[side]] = side;
+
+	m_roomBase.resize(m_roomHeight*m_roomWidth);
+	for (int i = 0; i < m_roomHeight; ++i)
+	{
+		for (int j = 0; j < m_roomWidth; ++j)
+			m_roomBase[i*m_roomWidth + j] = i*m_rowLength + 2*j;
+	}
+
+	// Slot 0 holds the room the vertex is the West or North vertex of, slot 1 the room it is the
+	// East or South vertex of
+	m_vertexRooms.assign(2*m_vertexCount, -1);
+	m_vertexSides.assign(2*m_vertexCount, -1);
+	for (int v = 0; v < m_vertexCount; ++v)
+	{
+		int row = v / m_rowLength;
+		int position = v % m_rowLength;
+
+		if (position % 2 == 0)
+		{
+			int col = position / 2;
+			if (row < m_roomHeight && col < m_roomWidth)
+			{
+				m_vertexRooms[2*v] = row*m_roomWidth + col;
+				m_vertexSides[2*v] = EOrientation_West;
+			}
+			if (row < m_roomHeight && col > 0)
+			{
+				m_vertexRooms[2*v + 1] = row*m_roomWidth + col - 1;
+				m_vertexSides[2*v + 1] = EOrientation_East;
+			}
+		}
+		else
+		{
+			int col = (position - 1) / 2;
+			if (row < m_roomHeight)
+			{
+				m_vertexRooms[2*v] = row*m_roomWidth + col;
+				m_vertexSides[2*v] = EOrientation_North;
+			}
+			if (row > 0)
+			{
+				m_vertexRooms[2*v + 1] = (row - 1)*m_roomWidth + col;
+				m_vertexSides[2*v + 1] = EOrientation_South;
+			}
+		}
+	}
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds the room which both fromVertex and toVertex are on the walls of, and the sides
+ * of that room they are on. It returns false if there is no such room (or if the two vertices are
+ * the same).
+ *
+ * Only the (at most two) rooms of fromVertex are tried: toVertex's offset from the base of the room
+ * is looked up to give the side it is on.
+ *
+ * This is called for every step of every route, so it does not log.
+ */
+bool CMazeGeometry::FindMove(int fromVertex, int toVertex, int& room, EOrientation& entrySide, EOrientation& exitSide) const
+{
+	if (fromVertex < 0 || fromVertex >= m_vertexCount)
+		return false;
+
+	for (int slot = 2*fromVertex; slot < 2*fromVertex + 2; ++slot)
+	{
+		int candidate = m_vertexRooms[slot];
+		if (candidate < 0)
+			continue;
+
+		unsigned int offset = toVertex - m_roomBase[candidate];
+		if (offset < m_offsetSide.size() && m_offsetSide[offset] >= 0 && m_offsetSide[offset] != m_vertexSides[slot])
+		{
+			room = candidate;
+			entrySide = static_cast<EOrientation>(m_vertexSides[slot]);
+			exitSide = static_cast<EOrientation>(m_offsetSide[offset]);
+			return true;
+		}
+	}
+
+	return false;
+}
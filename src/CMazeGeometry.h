@@ -0,0 +1,81 @@
+/*
+ * CMazeGeometry.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMAZEGEOMETRY_H_
+#define SRC_CMAZEGEOMETRY_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to hold precomputed tables of the vertex labelling of a maze of a given size, so
+ * that routes can be decoded without any arithmetic on the labels beyond a few table lookups.
+ *
+ * With n rooms across, room (i, j) has the vertices
+ *
+ *					i(2n+1) +2j +1
+ *					 _ _ _
+ *					|_ _ _|
+ *		i(2n+1) +2j	|_ _ _|		i(2n+1) + 2j + 2
+ *					|_ _ _|
+ *
+ *					(i+1)(2n+1) + 2j + 1
+ *
+ * so every vertex is on the wall of at most two rooms. For each vertex the tables hold those rooms
+ * and which side of each room the vertex is on. For each room they hold the label of its West
+ * vertex (the 'base'), from which the other vertices are fixed offsets.
+ *
+ * Sides of rooms are given as EOrientation values, in the same order as CMap::GetRoomVertices.
+ *
+ * Public Constructors:
+ *    - CMazeGeometry(room_height, room_width) - Builds the tables for a maze of the given size.
+ *
+ * Public Methods:
+ *    - FindMove(...) - Finds the room two vertices are both on, and the sides they are on.
+ *    - RoomVertex(...) - The label of the vertex on a given side of a room.
+ *    - IsVerticalVertex(...) - Whether a vertex is on an East/West wall.
+ *
+ */
+class CMazeGeometry
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CMazeGeometry(int room_height, int room_width);
+
+	// === Public Functions =========================================================================
+	bool FindMove(int fromVertex, int toVertex, int& room, EOrientation& entrySide, EOrientation& exitSide) const;
+	int RoomVertex(int room_index, EOrientation side) const {return m_roomBase[room_index] + m_sideOffset[side];}
+	bool IsVerticalVertex(int vertex) const {return m_vertexSides[2*vertex] == EOrientation_West || m_vertexSides[2*vertex + 1] == EOrientation_East;}
+
+	// Access functions
+	int GetRoomHeight() const {return m_roomHeight;}
+	int GetRoomWidth() const {return m_roomWidth;}
+	int GetRowLength() const {return m_rowLength;}
+	int GetVertexCount() const {return m_vertexCount;}
+
+private:
+	// === Member Variables =========================================================================
+	int m_roomHeight;
+	int m_roomWidth;
+	int m_rowLength;		// Vertex labels per row of rooms (2n+1)
+	int m_vertexCount;
+
+	// For vertex v, the rooms it is on are m_vertexRooms[2v] and m_vertexRooms[2v+1] (-1 if there
+	// is no room), and it is on side m_vertexSides[2v] and m_vertexSides[2v+1] of them
+	std::vector<int> m_vertexRooms;
+	std::vector<signed char> m_vertexSides;
+
+	// The label of the West vertex of each room
+	std::vector<int> m_roomBase;
+
+	// The offset of the vertex on each side of a room from its base, and the inverse of this (-1 for
+	// an offset which is not a vertex of the room)
+	int m_sideOffset[4];
+	std::vector<signed char> m_offsetSide;
+};
+
+#endif /* SRC_CMAZEGEOMETRY_H_ */
@@ -7,6 +7,8 @@
 
 // ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 #include "CMazeMapper.h"
+#include "CMapSnapshot.h"
+#include <algorithm>
 #include "DebugLog.hpp"
 
 // ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -49,41 +51,160 @@ bool CMazeMapper::ComputeNextVertex(const int& currentVertex, std::vector<int>&
 	DEBUG_METHOD();
 
 	// Generate graph from the CMap
-	// TODO: Fix this when you now how you will generate the graph / receive the map
-	vector< vector<double> > distanceMatrix;
-	vector<int> vertexLabels;
+	vector< vector<double> > distanceMatrix = CMapSnapshot(*m_pCurrentMap).DistanceMatrix();
+	vector<int> vertexLabels(distanceMatrix.size());
+	for (unsigned int i = 0; i < vertexLabels.size(); ++i)
+		vertexLabels[i] = i;
 	CGraph currentGraph { distanceMatrix, vertexLabels };
 
-	// Check there remain vertices to explore
-	if (m_vertsToExplore.size() > 0)
-		return false;
+	return ComputeNextVertex(currentGraph, currentVertex, outputRoute);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * As above, but using a graph of the map supplied by the caller. The graph must use the vertex
+ * numbering of the CMap as its external labels. Since CGraph saves its Dijkstra results, a caller
+ * which keeps the graph between calls (see CExplorationSession) does not pay to rebuild it or to
+ * rerun Dijkstra from vertices it has already searched from.
+ *
+ * Vertices which cannot be reached from currentVertex are ignored.
+ *
+ * Routes are compared by RouteCost. A route which is shorter than the chosen one by less than
+ * choice.m_tieMargin is taken as tied with it, so that costs which are rarely exactly equal (e.g.
+ * times) still leave the choice to the vertex scores.
+ *
+ */
+bool CMazeMapper::ComputeNextVertex(CGraph& currentGraph, const int& currentVertex, std::vector<int>& outputRoute,
+		const SRouteChoice& choice) const
+{
+	DEBUG_METHOD();
 
-	// Find closest of the vertices left to explore
-	int nextVertex { m_vertsToExplore[0] };
-	double currentFastestDist = currentGraph.ShortestDistance(currentVertex, m_vertsToExplore[0], true, outputRoute);
-	for (unsigned int i = 1; i < m_vertsToExplore.size(); ++i)
+	outputRoute.clear();
+
+	// Find closest of the vertices left to explore. The vertices are visited in order of increasing
+	// score (and then increasing label), and only a strictly shorter distance (by at least the tie
+	// margin) replaces the current choice, so ties in distance go to the vertex closest to the
+	// bottom left of the maze.
+	int nextVertex { -1 };
+	double currentFastestDist { -1 };
+	vector<int> vertsToExplore = GetVertsToExplore();
+	for (unsigned int i = 0; i < vertsToExplore.size(); ++i)
 	{
 		vector<int> newOutputRoute;
-		double newDist = currentGraph.ShortestDistance(currentVertex, m_vertsToExplore[i], true, newOutputRoute);
+		double newDist;
+		if (vertsToExplore[i] == currentVertex)
+		{
+			newDist = 0;
+			newOutputRoute = { currentVertex };
+		}
+		else
+			newDist = currentGraph.ShortestDistance(currentVertex, vertsToExplore[i], true, newOutputRoute);
 
-		if (newDist < currentFastestDist)
+		// Skip vertices which cannot be reached
+		if (newDist == -1)
+			continue;
+
+		newDist = RouteCost(newOutputRoute, newDist, choice);
+		double saving = currentFastestDist - newDist;
+		if (nextVertex == -1 || (saving > 0 && saving >= choice.m_tieMargin))
 		{
 			currentFastestDist = newDist;
 			outputRoute = newOutputRoute;
-			nextVertex = m_vertsToExplore[i];
+			nextVertex = vertsToExplore[i];
 		}
-		else if (newDist == currentFastestDist
-				&& VertexScore(m_vertsToExplore[i]) < VertexScore(nextVertex))
+	}
+
+	// Check there remain vertices to explore
+	return nextVertex != -1;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function gives the cost of a route of the given length in the graph: the length, plus
+ * choice.m_turnBack if the robot faces a room from the start of the route and the route does not
+ * set off through it.
+ */
+double CMazeMapper::RouteCost(const vector<int>& route, double distance, const SRouteChoice& choice) const
+{
+	if (route.size() < 2 || choice.m_facingRow < 0 || choice.m_turnBack == 0)
+		return distance;
+
+	vector<int> aheadVertices = m_pCurrentMap->CalculateRoomVertices(choice.m_facingRow, choice.m_facingCol);
+	if (find(aheadVertices.begin(), aheadVertices.end(), route[0]) == aheadVertices.end()
+			|| find(aheadVertices.begin(), aheadVertices.end(), route[1]) != aheadVertices.end())
+		return distance;
+
+	return distance + choice.m_turnBack;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function returns the vertices left to explore, in order of increasing VertexScore. Vertices
+ * with the same score are in order of increasing label, so the order is deterministic.
+ *
+ */
+vector<int> CMazeMapper::GetVertsToExplore() const
+{
+	DEBUG_METHOD();
+
+	vector<int> vertsToExplore;
+	vertsToExplore.reserve(m_frontierSize);
+
+	for (unsigned int i = 0; i < m_scoreBuckets.size(); ++i)
+	{
+		// Buckets are small (at most one vertex per wall on a diagonal), so sorting them is cheap
+		vector<int> bucket = m_scoreBuckets[i];
+		sort(bucket.begin(), bucket.end());
+		vertsToExplore.insert(vertsToExplore.end(), bucket.begin(), bucket.end());
+	}
+
+	return vertsToExplore;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds the room of unknown type on one side of a vertex, i.e. the room which will
+ * be explored by visiting the vertex.
+ *
+ * INPUTS:
+ * vertex - The vertex.
+ *
+ * OUTPUTS:
+ * row, col - The room of unknown type next to the vertex.
+ *
+ * RETURNS:
+ * true if there is a room of unknown type next to the vertex, and false otherwise (in which case
+ * row and col are not changed).
+ *
+ */
+bool CMazeMapper::RoomToExplore(int vertex, int& row, int& col) const
+{
+	DEBUG_METHOD();
+
+	// A vertex on a vertical wall is at (i + 1/2, j) and joins rooms (i, j-1) and (i, j).
+	// A vertex on a horizontal wall is at (i, j + 1/2) and joins rooms (i-1, j) and (i, j).
+	vector<double> coord = m_pCurrentMap->CalculateVertexCoords(vertex);
+	int rooms[2][2];
+	if (coord[0] != static_cast<int>(coord[0]))
+	{
+		rooms[0][0] = static_cast<int>(coord[0]); rooms[0][1] = static_cast<int>(coord[1]) - 1;
+		rooms[1][0] = static_cast<int>(coord[0]); rooms[1][1] = static_cast<int>(coord[1]);
+	}
+	else
+	{
+		rooms[0][0] = static_cast<int>(coord[0]) - 1; rooms[0][1] = static_cast<int>(coord[1]);
+		rooms[1][0] = static_cast<int>(coord[0]); rooms[1][1] = static_cast<int>(coord[1]);
+	}
+
+	for (int k = 0; k < 2; ++k)
+	{
+		if (rooms[k][0] >= 0 && rooms[k][0] < m_pCurrentMap->GetRoomHeight()
+				&& rooms[k][1] >= 0 && rooms[k][1] < m_pCurrentMap->GetRoomWidth()
+				&& m_pCurrentMap->GetRoomType(rooms[k][0], rooms[k][1]) == ERoom_Unknown)
 		{
-			// If there is a tie in distances, choose the one which is closest to the bottom left of the maze
-			// If this is also a tie then do not update nextVertex. This is equivalent to choosing the vertex
-			// which is closer to the top left.
-			outputRoute = newOutputRoute;
-			nextVertex = m_vertsToExplore[i];
+			row = rooms[k][0];
+			col = rooms[k][1];
+			return true;
 		}
 	}
 
-	return true;
+	return false;
 }
 
 /* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -92,6 +213,8 @@ bool CMazeMapper::ComputeNextVertex(const int& currentVertex, std::vector<int>&
  * 	- Set the pointer to the CMap
  * 	- Generate a list of vertices to explore from the CMap*
  *
+ * If only a few rooms of the map have changed then UpdateRoom is much cheaper.
+ *
  * INPUTS:
  * pNewMap - The new CMap pointer.
  *
@@ -111,77 +234,145 @@ void CMazeMapper::Update(const CMap* pNewMap)
 		throw Exception_NullPointer{};
 }
 
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function updates the vertices to explore after the type of one room of the map has changed.
+ * Only the four vertices on the walls of the room can change, so this takes constant time.
+ *
+ * INPUTS:
+ * row, col - The room whose type has changed.
+ *
+ */
+void CMazeMapper::UpdateRoom(int row, int col)
+{
+	DEBUG_METHOD();
+
+	vector<int> roomVertexLabels = m_pCurrentMap->CalculateRoomVertices(row, col);
+	for (int side = 0; side < 4; ++side)
+	{
+		if (IsVertToExplore(row, col, side))
+			AddVertToExplore(roomVertexLabels[side]);
+		else
+			RemoveVertToExplore(roomVertexLabels[side]);
+	}
+}
+
 /* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * This function analyses a map and computes a vector of vertices to explore.
+ * This function analyses a map and computes the set of vertices to explore from scratch.
  *
- * A vertex is added to the vector if it joins a room of unknown type to a room with known type.
+ * A vertex is added to the set if it joins a room of unknown type to a room with known type.
  *
  * BE WARNED -- Vertices added need not be in the same connected component as the robot! Indeed,
  *    this will occur if two rooms of CMap of known type are not joined by rooms of known type. For
  *    example, if we add the types of the start and end rooms (to prevent the robot from exploring
  *    them and getting lost over the white spot) then they will initially be unconnected.
  *
- * IMPORTANT -- The rooms in the maze which lead to the entrance and exit from the maze should be
- *    passed with known type. If a room at the edge of the maze leads out of the maze then overflow
- *    exceptions will occur.
+ * The entrance vertex is added for as long as the entrance room is of unknown type, so that the
+ *    robot starts by exploring it. Other exits which lead out of the maze (e.g. the exit of the
+ *    maze) are never added.
  *
  *
  * MEMBER VARIABLES SET:
- * m_vertsToExplore - This is updated with a list of all vertices which join a room of unknown type
- * 	to a room of known type.
+ * m_scoreBuckets, m_bucketPosition, m_frontierSize - These hold the set of all vertices which join
+ * 	a room of unknown type to a room of known type.
  *
  */
 void CMazeMapper::FindVertsToExplore()
 {
 	DEBUG_METHOD();
 
-	m_vertsToExplore.clear();
+	int height = m_pCurrentMap->GetRoomHeight();
+	int width = m_pCurrentMap->GetRoomWidth();
 
-	vector<vector<ERoom> > roomMap = m_pCurrentMap->GetRoomMap();
+	// Vertex scores (doubled) run from -2*height to 2*width
+	m_bucketOffset = 2*height;
+	m_scoreBuckets.assign(2*(height + width) + 1, vector<int>());
+	m_bucketPosition.assign((height + 1)*(2*width + 1), -1);
+	m_frontierSize = 0;
 
-	// Add entrance vertex
-	m_vertsToExplore.push_back(m_pCurrentMap->GetEntranceVertex());
-
-	// Add vertices which join rooms of known type with those of unknown type
-	for (unsigned int i = 0; i < roomMap.size(); ++i)
+	for (int i = 0; i < height; ++i)
 	{
-		for (unsigned int j = 0; j < roomMap[i].size(); ++j)
-		{
-			if (roomMap[i][j] != ERoom_Unknown)
-			{
-				// Check if it leads into any unknown rooms
-				vector<int> roomExits = CMap::GetRoomVertices(roomMap[i][j]);
-				vector<int> roomVertexLabels = m_pCurrentMap->CalculateRoomVertices(i, j);
-
-				// Check room above
-				if (roomExits[0] == 1 && roomMap.at(i-1)[j] == ERoom_Unknown)
-				{
-					m_vertsToExplore.push_back(roomVertexLabels[0]);
-				}
-
-				// Check room to the right
-				if (roomExits[1] == 1 && roomMap[i].at(j+1) == ERoom_Unknown)
-				{
-					m_vertsToExplore.push_back(roomVertexLabels[1]);
-				}
-
-				// Check room below
-				if (roomExits[2] == 1 && roomMap.at(i+1)[j] == ERoom_Unknown)
-				{
-					m_vertsToExplore.push_back(roomVertexLabels[2]);
-				}
-
-				// Check room to left
-				if (roomExits[3] == 1 && roomMap[i].at(j-1) == ERoom_Unknown)
-				{
-					m_vertsToExplore.push_back(roomVertexLabels[3]);
-				}
-
-			}
-		}
+		for (int j = 0; j < width; ++j)
+			UpdateRoom(i, j);
 	}
 }
 
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function decides whether the vertex on one side of a room should be explored. This is the
+ * case if
+ *   - one of the rooms either side of the vertex is of known type and has an exit through the
+ *     vertex, and the other is in the map and of unknown type, or
+ *   - the vertex is the entrance vertex and the entrance room is of unknown type.
+ *
+ * INPUTS:
+ * row, col - The room.
+ * side     - The side of the room, in the order North, East, South, West (as GetRoomVertices).
+ *
+ */
+bool CMazeMapper::IsVertToExplore(int row, int col, int side) const
+{
+	DEBUG_METHOD();
+
+	const int rowStep[4] = { -1, 0, 1, 0 };
+	const int colStep[4] = { 0, 1, 0, -1 };
+
+	ERoom roomType = m_pCurrentMap->GetRoomType(row, col);
+
+	// The entrance
+	if (row == m_pCurrentMap->GetRoomHeight() - 1 && col == 0 && side == 2)
+		return roomType == ERoom_Unknown;
+
+	// Exits which lead out of the maze are ignored
+	int otherRow = row + rowStep[side];
+	int otherCol = col + colStep[side];
+	if (otherRow < 0 || otherRow >= m_pCurrentMap->GetRoomHeight()
+			|| otherCol < 0 || otherCol >= m_pCurrentMap->GetRoomWidth())
+		return false;
+
+	ERoom otherRoomType = m_pCurrentMap->GetRoomType(otherRow, otherCol);
+
+	if (roomType != ERoom_Unknown && otherRoomType == ERoom_Unknown)
+		return CMap::GetRoomVertices(roomType)[side] == 1;
+	else if (roomType == ERoom_Unknown && otherRoomType != ERoom_Unknown)
+		return CMap::GetRoomVertices(otherRoomType)[(side + 2) % 4] == 1;
+	else
+		return false;
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * These functions add and remove a vertex from the set of vertices to explore, in constant time.
+ * Each vertex is kept in the bucket for its (doubled) score, and m_bucketPosition records where in
+ * the bucket it is so that it can be swapped with the last element and popped.
+ *
+ */
+void CMazeMapper::AddVertToExplore(int vertex)
+{
+	DEBUG_METHOD();
+
+	if (m_bucketPosition[vertex] != -1)
+		return;
+
+	vector<int>& bucket = m_scoreBuckets[ScoreBucket(vertex)];
+	m_bucketPosition[vertex] = bucket.size();
+	bucket.push_back(vertex);
+	++m_frontierSize;
+}
+
+void CMazeMapper::RemoveVertToExplore(int vertex)
+{
+	DEBUG_METHOD();
+
+	if (m_bucketPosition[vertex] == -1)
+		return;
+
+	vector<int>& bucket = m_scoreBuckets[ScoreBucket(vertex)];
+	int lastVertex = bucket.back();
+	bucket[m_bucketPosition[vertex]] = lastVertex;
+	m_bucketPosition[lastVertex] = m_bucketPosition[vertex];
+	bucket.pop_back();
+	m_bucketPosition[vertex] = -1;
+	--m_frontierSize;
+}
+
 /* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * This function computes 'scores' for vertices. It is used by the ComputeNextVertex function to
  * help to decide which vertex to visit next when there is a tie for the closest vertex.
@@ -193,10 +384,16 @@ void CMazeMapper::FindVertsToExplore()
  * NOTE: It *is* possible for two vertices to have the same number.
  *
  */
-double CMazeMapper::VertexScore(int vertex)
+double CMazeMapper::VertexScore(int vertex) const
 {
 	DEBUG_METHOD();
 
 	vector<double> coord = m_pCurrentMap->CalculateVertexCoords(vertex);
 	return coord[1] - coord[0];
 }
+
+// Vertex scores are multiples of 1/2, so doubling them gives the index of a bucket
+unsigned int CMazeMapper::ScoreBucket(int vertex) const
+{
+	return static_cast<int>(2*VertexScore(vertex)) + m_bucketOffset;
+}
@@ -14,6 +14,22 @@
 #include "CGraph.h"
 #include <vector>
 
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// How the routes to the vertices to explore are compared, beyond their length in the graph. The
+// defaults compare the lengths alone.
+struct SRouteChoice
+{
+	double m_tieMargin;		// Routes shorter than the chosen one by less than this are taken as tied
+	double m_turnBack;		// Added to a route which sets off through the room behind the robot
+	int m_facingRow;		// The room the robot faces from the current vertex (-1 if not known)
+	int m_facingCol;
+
+	SRouteChoice()
+			: m_tieMargin { 0 }, m_turnBack { 0 }, m_facingRow { -1 }, m_facingCol { -1 }
+	{
+	}
+};
+
 /* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * This is a class to plan the route when mapping the maze in challenge two.
  *
@@ -22,11 +38,23 @@
  *
  * Public Methods:
  *    - ComputeNextVertex(...) - A method to find the route to the next vertex to explore. Returns
- *    	false if no more vertices need exploring.
+ *    	false if no more vertices need exploring. An overload takes a CGraph of the map which the
+ *    	caller keeps between calls, so that its Dijkstra results are reused, and how to compare
+ *    	the routes (SRouteChoice).
+ *
+ *    - RouteCost(...) - The length of a route plus the cost of turning back to set off on it.
+ *
+ *    - GetVertsToExplore() - Returns the vertices which join known rooms to unknown rooms, in
+ *    	order of increasing VertexScore (ties broken by vertex label).
+ *
+ *    - RoomToExplore(...) - Finds the room of unknown type next to a vertex.
  *
  *    - Update(const CMap*) - Updates the CMazeMapper with a new CMap pointer and recomputes the
  *    	vertices to explore.
  *
+ *    - UpdateRoom(row, col) - Updates the vertices to explore after one room of the map has changed.
+ *    	This takes constant time.
+ *
  * Exceptions:
  * 	- Exception_NullPointer - Thrown when a null pointer is passed either to the constructor or to
  * 		the Update method.
@@ -40,19 +68,35 @@ public:
 
 	// === Public Functions =========================================================================
 	bool ComputeNextVertex(const int& currentVertex, std::vector<int>& outputRoute);
+	bool ComputeNextVertex(CGraph& currentGraph, const int& currentVertex, std::vector<int>& outputRoute,
+			const SRouteChoice& choice = SRouteChoice()) const;
+	double RouteCost(const std::vector<int>& route, double distance, const SRouteChoice& choice) const;
+	std::vector<int> GetVertsToExplore() const;
+	unsigned int CountVertsToExplore() const {return m_frontierSize;}
+	bool RoomToExplore(int vertex, int& row, int& col) const;
 	void Update(const CMap* newMap);
+	void UpdateRoom(int row, int col);
 
 	// === Exceptions ===============================================================================
 	struct Exception_NullPointer {};
 
 private:
 	// === Member Variables =========================================================================
-	std::vector<int> m_vertsToExplore;
+	// The vertices to explore, bucketed by 2*VertexScore (offset by m_bucketOffset), with the
+	// position of each vertex in its bucket (or -1 if it is not to be explored)
+	std::vector<std::vector<int> > m_scoreBuckets;
+	std::vector<int> m_bucketPosition;
+	int m_bucketOffset;
+	unsigned int m_frontierSize;
 	const CMap* m_pCurrentMap;
 
 	// === Private Functions ========================================================================
 	void FindVertsToExplore();
-	double VertexScore(int vertex);
+	bool IsVertToExplore(int row, int col, int side) const;
+	void AddVertToExplore(int vertex);
+	void RemoveVertToExplore(int vertex);
+	double VertexScore(int vertex) const;
+	unsigned int ScoreBucket(int vertex) const;
 };
 
 #endif /* SRC_CMAZEMAPPER_H_ */
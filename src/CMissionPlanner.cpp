@@ -0,0 +1,243 @@
+/*
+ * CMissionPlanner.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMissionPlanner.h"
+#include <algorithm>
+#include <limits>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ DEFINITIONS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static const double INFINITE_COST = numeric_limits<double>::infinity();
+
+const int CMissionPlanner::EXIT_SITE;
+const unsigned int CMissionPlanner::EXACT_LIMIT;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CMissionPlanner::CMissionPlanner(const vector<vector<double> >& siteCosts)
+		: m_siteCosts { siteCosts }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function builds the table of travel costs between sites. The cost between two sites is the
+ * shortest route between any vertex of one and any vertex of the other, and is infinite if there is
+ * no route.
+ *
+ * Only one Dijkstra search is needed from each vertex, since CGraph saves its results.
+ */
+vector<vector<double> > CMissionPlanner::SiteCosts(CGraph& graph, const vector<vector<int> >& siteVertices)
+{
+	DEBUG_METHOD();
+
+	unsigned int siteCount = siteVertices.size();
+	vector<vector<double> > siteCosts(siteCount, vector<double>(siteCount, INFINITE_COST));
+
+	vector<int> route;
+	for (unsigned int i = 0; i < siteCount; ++i)
+	{
+		siteCosts[i][i] = 0;
+		for (unsigned int j = i + 1; j < siteCount; ++j)
+		{
+			for (unsigned int a = 0; a < siteVertices[i].size(); ++a)
+			{
+				for (unsigned int b = 0; b < siteVertices[j].size(); ++b)
+				{
+					double distance = graph.ShortestDistance(siteVertices[i][a], siteVertices[j][b], route);
+					if (distance >= 0 && distance < siteCosts[i][j])
+						siteCosts[i][j] = distance;
+				}
+			}
+			siteCosts[j][i] = siteCosts[i][j];
+		}
+	}
+
+	return siteCosts;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function plans the order in which to photograph the candidate rooms for the next block,
+ * starting from currentSite.
+ */
+SProbePlan CMissionPlanner::PlanProbes(int currentSite, const vector<int>& candidates) const
+{
+	DEBUG_METHOD();
+
+	GetCost(currentSite, currentSite);
+	for (unsigned int i = 0; i < candidates.size(); ++i)
+		GetCost(candidates[i], candidates[i]);
+
+	if (candidates.empty())
+		return SProbePlan { {}, 0, true };
+
+	if (candidates.size() <= EXACT_LIMIT)
+		return ExactProbes(currentSite, candidates);
+
+	return HeuristicProbes(currentSite, candidates);
+}
+
+double CMissionPlanner::DeliveryCost(int currentSite, int site) const
+{
+	return GetCost(currentSite, site) + GetCost(site, EXIT_SITE);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function returns the expected travel of photographing the rooms in the given order until
+ * the block is found (each room being equally likely to hold it), then taking it to the exit.
+ */
+double CMissionPlanner::ExpectedCost(int currentSite, const vector<int>& order) const
+{
+	double count = order.size();
+	double expectedCost = 0;
+	int previous = currentSite;
+	for (unsigned int k = 0; k < order.size(); ++k)
+	{
+		expectedCost += GetCost(previous, order[k])*(count - k)/count + GetCost(order[k], EXIT_SITE)/count;
+		previous = order[k];
+	}
+
+	return expectedCost;
+}
+
+double CMissionPlanner::GetCost(int from, int to) const
+{
+	if (from < 0 || from >= static_cast<int>(m_siteCosts.size()))
+		throw Exception_InvalidSite { from };
+	if (to < 0 || to >= static_cast<int>(m_siteCosts.size()))
+		throw Exception_InvalidSite { to };
+
+	return m_siteCosts[from][to];
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds the optimal probe order by dynamic programming over subsets.
+ *
+ * best[S][j] is the least expected cost of photographing the candidates in the set S (a bit mask),
+ * finishing with candidate j. The move into the (|S| + 1)th room is only made if the block was not
+ * in the first |S|, which has probability (m - |S|)/m.
+ */
+SProbePlan CMissionPlanner::ExactProbes(int currentSite, const vector<int>& candidates) const
+{
+	unsigned int m = candidates.size();
+	unsigned int setCount = 1u << m;
+	double count = m;
+
+	vector<vector<double> > best(setCount, vector<double>(m, INFINITE_COST));
+	vector<vector<int> > previous(setCount, vector<int>(m, -1));
+
+	for (unsigned int j = 0; j < m; ++j)
+		best[1u << j][j] = m_siteCosts[currentSite][candidates[j]] + m_siteCosts[candidates[j]][EXIT_SITE]/count;
+
+	for (unsigned int set = 1; set < setCount; ++set)
+	{
+		unsigned int setSize = 0;
+		for (unsigned int j = 0; j < m; ++j)
+			setSize += (set >> j) & 1;
+		double reachProbability = (count - setSize)/count;
+
+		for (unsigned int last = 0; last < m; ++last)
+		{
+			if (!((set >> last) & 1) || best[set][last] == INFINITE_COST)
+				continue;
+
+			for (unsigned int next = 0; next < m; ++next)
+			{
+				if ((set >> next) & 1)
+					continue;
+
+				double cost = best[set][last] + m_siteCosts[candidates[last]][candidates[next]]*reachProbability
+						+ m_siteCosts[candidates[next]][EXIT_SITE]/count;
+				unsigned int nextSet = set | (1u << next);
+				if (cost < best[nextSet][next])
+				{
+					best[nextSet][next] = cost;
+					previous[nextSet][next] = last;
+				}
+			}
+		}
+	}
+
+	// Read the order back from the best final room
+	unsigned int set = setCount - 1;
+	int last = 0;
+	for (unsigned int j = 1; j < m; ++j)
+	{
+		if (best[set][j] < best[set][last])
+			last = j;
+	}
+
+	// Every candidate unreachable: any order is as good as another
+	if (best[set][last] == INFINITE_COST)
+		return SProbePlan { candidates, INFINITE_COST, true };
+
+	SProbePlan plan { vector<int>(m), best[set][last], true };
+	for (int k = m - 1; k >= 0; --k)
+	{
+		plan.m_order[k] = candidates[last];
+		int before = previous[set][last];
+		set &= ~(1u << last);
+		last = before;
+	}
+
+	return plan;
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function finds a good probe order for many candidates: the nearest neighbour order, improved
+ * by swapping pairs of rooms while any swap lowers the expected cost.
+ */
+SProbePlan CMissionPlanner::HeuristicProbes(int currentSite, const vector<int>& candidates) const
+{
+	vector<int> remaining = candidates;
+	vector<int> order;
+	order.reserve(candidates.size());
+
+	int previous = currentSite;
+	while (!remaining.empty())
+	{
+		unsigned int nearest = 0;
+		for (unsigned int i = 1; i < remaining.size(); ++i)
+		{
+			if (m_siteCosts[previous][remaining[i]] < m_siteCosts[previous][remaining[nearest]])
+				nearest = i;
+		}
+		previous = remaining[nearest];
+		order.push_back(previous);
+		remaining.erase(remaining.begin() + nearest);
+	}
+
+	double expectedCost = ExpectedCost(currentSite, order);
+	bool improved = true;
+	while (improved)
+	{
+		improved = false;
+		for (unsigned int i = 0; i < order.size(); ++i)
+		{
+			for (unsigned int j = i + 1; j < order.size(); ++j)
+			{
+				swap(order[i], order[j]);
+				double cost = ExpectedCost(currentSite, order);
+				if (cost < expectedCost - 1e-9)
+				{
+					expectedCost = cost;
+					improved = true;
+				}
+				else
+					swap(order[i], order[j]);
+			}
+		}
+	}
+
+	return SProbePlan { order, expectedCost, false };
+}
@@ -0,0 +1,93 @@
+/*
+ * CMissionPlanner.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMISSIONPLANNER_H_
+#define SRC_CMISSIONPLANNER_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CGraph.h"
+#include <vector>
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The order in which to photograph the candidate rooms for the next block
+struct SProbePlan
+{
+	std::vector<int> m_order;		// Sites, in the order to visit them
+	double m_expectedCost;			// Expected travel until the block is delivered to the exit
+	bool m_exact;					// Whether the order is optimal (or found by the heuristic)
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to plan the order of visits in challenge four, given a table of travel costs
+ * between 'sites': site 0 is the exit, and sites 1, 2, ... are the rooms containing blocks.
+ *
+ * The blocks must be delivered in order, so the collection order is fixed. The choice is where to
+ * look for the next block when its room is not known yet. Each unidentified room is taken to be
+ * equally likely to hold it, and the rooms are photographed in turn until it is found, then it is
+ * taken to the exit. The probe order minimises the expected travel for this:
+ *     sum over k of  P(not found in the first k - 1 rooms) * cost(room k - 1 -> room k)
+ *                  + P(found in room k) * cost(room k -> exit)
+ * which is a travelling salesman path with weights falling along the path. Up to EXACT_LIMIT
+ * candidates it is solved exactly by dynamic programming over subsets of the candidates (in
+ * O(2^m m^2)); beyond that a nearest neighbour order is improved by swapping pairs of rooms.
+ *
+ * The table is computed once, so replanning after each photograph costs microseconds.
+ *
+ * Public Constructors:
+ *    - CMissionPlanner(siteCosts) - A planner for a square table of travel costs between sites.
+ *
+ * Public Methods:
+ *    - SiteCosts(graph, siteVertices) - Builds the table from the vertices at which each site can
+ *    	be entered (the cost between two sites is the shortest route between any of their vertices).
+ *    - PlanProbes(currentSite, candidates) - The probe order for the next block.
+ *    - DeliveryCost(currentSite, site) - The travel to collect the block in a known site and take
+ *    	it to the exit.
+ *    - ExpectedCost(currentSite, order) - The expected travel of a probe order.
+ *
+ * Exceptions:
+ * 	- Exception_InvalidSite - Thrown when a site is not in the table.
+ *
+ */
+class CMissionPlanner
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMissionPlanner(const std::vector<std::vector<double> >& siteCosts);
+
+	// === Public Functions =========================================================================
+	static std::vector<std::vector<double> > SiteCosts(CGraph& graph, const std::vector<std::vector<int> >& siteVertices);
+
+	SProbePlan PlanProbes(int currentSite, const std::vector<int>& candidates) const;
+	double DeliveryCost(int currentSite, int site) const;
+	double ExpectedCost(int currentSite, const std::vector<int>& order) const;
+
+	// Access functions
+	unsigned int GetSiteCount() const {return m_siteCosts.size();}
+	double GetCost(int from, int to) const;
+
+	static const int EXIT_SITE = 0;
+	static const unsigned int EXACT_LIMIT = 12;
+
+	// === Exceptions ===============================================================================
+	struct Exception_InvalidSite
+	{
+		int mm_site;
+		explicit Exception_InvalidSite(int site)
+				: mm_site { site }
+		{
+		}
+	};
+
+private:
+	// === Private Functions ========================================================================
+	SProbePlan ExactProbes(int currentSite, const std::vector<int>& candidates) const;
+	SProbePlan HeuristicProbes(int currentSite, const std::vector<int>& candidates) const;
+
+	// === Member Variables =========================================================================
+	std::vector<std::vector<double> > m_siteCosts;
+};
+
+#endif /* SRC_CMISSIONPLANNER_H_ */
@@ -0,0 +1,144 @@
+/*
+ * CMissionPlanner_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CMissionPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// A random table of costs between points in the plane (so the triangle inequality holds)
+static vector<vector<double> > RandomSiteCosts(unsigned int siteCount, mt19937& generator)
+{
+	uniform_real_distribution<double> coordinate(0, 10);
+	vector<pair<double, double> > points(siteCount);
+	for (unsigned int i = 0; i < siteCount; ++i)
+		points[i] = make_pair(coordinate(generator), coordinate(generator));
+
+	vector<vector<double> > siteCosts(siteCount, vector<double>(siteCount));
+	for (unsigned int i = 0; i < siteCount; ++i)
+	{
+		for (unsigned int j = 0; j < siteCount; ++j)
+			siteCosts[i][j] = fabs(points[i].first - points[j].first) + fabs(points[i].second - points[j].second);
+	}
+
+	return siteCosts;
+}
+
+// Test that the probe order is optimal for small numbers of rooms, that the heuristic is no worse
+// than the nearest room first, and that the table is built from a graph correctly
+int CMissionPlanner_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CMissionPlanner_test--\n\n";
+
+	int result = 0;
+	mt19937 generator { 38 };
+
+	// -- Exact plans match a search over every order -- //
+	for (unsigned int trial = 0; trial < 20; ++trial)
+	{
+		unsigned int candidateCount = 1 + trial % 7;
+		CMissionPlanner planner { RandomSiteCosts(candidateCount + 2, generator) };
+		vector<int> candidates;
+		for (unsigned int i = 0; i < candidateCount; ++i)
+			candidates.push_back(i + 2);
+
+		SProbePlan plan = planner.PlanProbes(1, candidates);
+
+		double bruteForce = planner.ExpectedCost(1, candidates);
+		vector<int> order = candidates;
+		while (next_permutation(order.begin(), order.end()))
+			bruteForce = min(bruteForce, planner.ExpectedCost(1, order));
+
+		if (!plan.m_exact || fabs(plan.m_expectedCost - bruteForce) > 1e-9
+				|| fabs(planner.ExpectedCost(1, plan.m_order) - plan.m_expectedCost) > 1e-9)
+		{
+			cout << "Plan for " << candidateCount << " rooms costs " << plan.m_expectedCost << ", but the best order costs "
+					<< bruteForce << '\n';
+			result = 1;
+		}
+	}
+
+	// -- Replanning for five rooms takes microseconds -- //
+	CMissionPlanner fivePlanner { RandomSiteCosts(6, generator) };
+	const unsigned int REPLANS = 1000;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	double totalCost = 0;
+	for (unsigned int i = 0; i < REPLANS; ++i)
+		totalCost += fivePlanner.PlanProbes(i % 6, { 1, 2, 3, 4, 5 }).m_expectedCost;
+	double replanTime = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count()/REPLANS;
+	cout << "Replanning for five rooms took " << replanTime << "us (total cost " << totalCost << ")\n";
+
+	// -- The heuristic for many rooms gives a full order, no worse than nearest room first -- //
+	unsigned int manyCount = CMissionPlanner::EXACT_LIMIT + 8;
+	CMissionPlanner manyPlanner { RandomSiteCosts(manyCount + 1, generator) };
+	vector<int> manyCandidates;
+	for (unsigned int i = 1; i <= manyCount; ++i)
+		manyCandidates.push_back(i);
+
+	SProbePlan manyPlan = manyPlanner.PlanProbes(CMissionPlanner::EXIT_SITE, manyCandidates);
+	vector<int> sortedOrder = manyPlan.m_order;
+	sort(sortedOrder.begin(), sortedOrder.end());
+
+	vector<int> nearestOrder;
+	vector<int> remaining = manyCandidates;
+	int previous = CMissionPlanner::EXIT_SITE;
+	while (!remaining.empty())
+	{
+		vector<int>::iterator nearest = min_element(remaining.begin(), remaining.end(), [&](int a, int b) {
+			return manyPlanner.GetCost(previous, a) < manyPlanner.GetCost(previous, b);
+		});
+		previous = *nearest;
+		nearestOrder.push_back(previous);
+		remaining.erase(nearest);
+	}
+	double nearestCost = manyPlanner.ExpectedCost(CMissionPlanner::EXIT_SITE, nearestOrder);
+	cout << manyCount << " rooms: heuristic " << manyPlan.m_expectedCost << ", nearest first " << nearestCost << '\n';
+	if (manyPlan.m_exact || sortedOrder != manyCandidates || manyPlan.m_expectedCost > nearestCost + 1e-9)
+	{
+		cout << "The heuristic plan is not a good order of every room\n";
+		result = 1;
+	}
+
+	// -- Site costs from a graph: a path 0 - 1 - 2 - 3 with sites {0}, {2, 3} and {1} -- //
+	vector<vector<double> > distanceMatrix = { { -1, 1, -1, -1 }, { 1, -1, 2, -1 }, { -1, 2, -1, 4 }, { -1, -1, 4, -1 } };
+	CGraph graph { distanceMatrix, { 0, 1, 2, 3 } };
+	vector<vector<double> > siteCosts = CMissionPlanner::SiteCosts(graph, { { 0 }, { 2, 3 }, { 1 } });
+	if (siteCosts != vector<vector<double> > { { 0, 3, 1 }, { 3, 0, 2 }, { 1, 2, 0 } })
+	{
+		cout << "Site costs were not the shortest routes between the sites\n";
+		result = 1;
+	}
+
+	// -- Sites outside the table are rejected -- //
+	bool rejected = false;
+	try
+	{
+		fivePlanner.PlanProbes(0, { 6 });
+	}
+	catch (const CMissionPlanner::Exception_InvalidSite& e)
+	{
+		rejected = e.mm_site == 6;
+	}
+	if (!rejected)
+	{
+		cout << "An invalid site was accepted\n";
+		result = 1;
+	}
+
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
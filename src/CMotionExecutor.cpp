@@ -0,0 +1,150 @@
+/*
+ * CMotionExecutor.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMotionExecutor.h"
+#include <chrono>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (constructor) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This constructor starts the motion thread. The thread is started last, once everything it uses
+ * has been initialised.
+ */
+CMotionExecutor::CMotionExecutor(size_t capacity)
+		: m_commands { capacity }, m_pending { 0 }, m_executed { 0 }, m_idleTime { 0 }
+{
+	DEBUG_METHOD();
+
+	m_thread = thread { &CMotionExecutor::Run, this };
+}
+
+CMotionExecutor::~CMotionExecutor()
+{
+	DEBUG_METHOD();
+
+	Finish();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function waits until every command submitted so far has been carried out.
+ */
+void CMotionExecutor::WaitUntilIdle()
+{
+	DEBUG_METHOD();
+
+	{
+		unique_lock<mutex> lock { m_mutex };
+		m_idle.wait(lock, [this] { return m_pending == 0; });
+	}
+	RethrowFailure();
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function closes the queue, so that the motion thread stops once it has carried out the
+ * commands already submitted, and waits for it.
+ */
+void CMotionExecutor::Finish()
+{
+	DEBUG_METHOD();
+
+	m_commands.Close();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+double CMotionExecutor::GetIdleTime() const
+{
+	lock_guard<mutex> lock { m_mutex };
+	return m_idleTime;
+}
+
+unsigned int CMotionExecutor::GetCommandsExecuted() const
+{
+	lock_guard<mutex> lock { m_mutex };
+	return m_executed;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+// Queues a command, waiting while the queue is full
+void CMotionExecutor::Enqueue(function<void()> command)
+{
+	{
+		lock_guard<mutex> lock { m_mutex };
+		++m_pending;
+	}
+
+	if (!m_commands.Push(move(command)))
+	{
+		lock_guard<mutex> lock { m_mutex };
+		--m_pending;
+		m_idle.notify_all();
+		throw Exception_ExecutorFinished {};
+	}
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is the motion thread. It carries out commands in order until the queue is closed and empty.
+ * Waits for a command are only counted as idle time once the first command has been carried out.
+ */
+void CMotionExecutor::Run()
+{
+	DEBUG_METHOD();
+
+	function<void()> command;
+	chrono::steady_clock::time_point waitStart = chrono::steady_clock::now();
+	while (m_commands.Pop(command))
+	{
+		chrono::steady_clock::time_point waitEnd = chrono::steady_clock::now();
+		{
+			lock_guard<mutex> lock { m_mutex };
+			if (m_executed > 0)
+				m_idleTime += chrono::duration<double>(waitEnd - waitStart).count();
+		}
+
+		// Packaged tasks pass exceptions on to their futures, but anything else must not stop the thread
+		try
+		{
+			command();
+		}
+		catch (...)
+		{
+			DEBUG_MESSAGE("A command threw an exception");
+		}
+		command = nullptr;
+
+		lock_guard<mutex> lock { m_mutex };
+		++m_executed;
+		--m_pending;
+		m_idle.notify_all();
+		waitStart = chrono::steady_clock::now();
+	}
+}
+
+// Aborts the executor, keeping the first failure
+void CMotionExecutor::Fail(exception_ptr failure)
+{
+	lock_guard<mutex> lock { m_mutex };
+	if (!m_failure)
+		m_failure = failure;
+}
+
+void CMotionExecutor::RethrowFailure() const
+{
+	exception_ptr failure;
+	{
+		lock_guard<mutex> lock { m_mutex };
+		failure = m_failure;
+	}
+	if (failure)
+		rethrow_exception(failure);
+}
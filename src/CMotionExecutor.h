@@ -0,0 +1,131 @@
+/*
+ * CMotionExecutor.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMOTIONEXECUTOR_H_
+#define SRC_CMOTIONEXECUTOR_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CBoundedQueue.h"
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to drive the robot on its own thread, so that the challenges can plan the next
+ * leg while the current one is being driven.
+ *
+ * Commands (anything callable, usually a call to CManouvre or CSignals) are passed to the motion
+ * thread through a CBoundedQueue and carried out in the order they were submitted. Submit returns
+ * straight away with a future for the result of the command, so the planner only waits when it
+ * needs something the robot has measured (e.g. CManouvre::ApproachAndPhotographBlock), or when it is
+ * more than the capacity of the queue ahead of the robot.
+ *
+ * An exception thrown by a command is passed to its future, and aborts the executor: the commands
+ * queued after it are not carried out (their futures get the same exception), and Submit and
+ * WaitUntilIdle throw it too. Otherwise a motion which failed would leave the robot somewhere
+ * other than where the next commands expect it to be.
+ *
+ * The time the motion thread spends between commands waiting for the next one (i.e. the robot idle,
+ * waiting on the planner) is measured.
+ *
+ * Public Constructors:
+ *    - CMotionExecutor(capacity) - Starts the motion thread, with a queue of at most capacity
+ *    	commands.
+ *
+ * Public Methods:
+ *    - Submit(command) - Queues a command, returning a future for its result. Throws the exception
+ *    	of a failed command instead if the executor has been aborted.
+ *    - WaitUntilIdle() - Waits until every command submitted has been carried out. Throws the
+ *    	exception of a failed command if the executor has been aborted.
+ *    - Finish() - Carries out the commands already submitted and stops the motion thread. Called by
+ *    	the destructor.
+ *    - GetIdleTime() - Seconds spent between commands waiting for the next one.
+ *    - GetCommandsExecuted() - The number of commands carried out.
+ *
+ * Exceptions:
+ * 	- Exception_ExecutorFinished - Thrown by Submit after Finish.
+ *
+ */
+class CMotionExecutor
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMotionExecutor(std::size_t capacity = 8);
+	~CMotionExecutor();
+
+	CMotionExecutor(const CMotionExecutor&) = delete;
+	CMotionExecutor& operator=(const CMotionExecutor&) = delete;
+
+	// === Public Functions =========================================================================
+	/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+	 * This function is included in full in the header because it is templated. The command is
+	 * wrapped in a packaged_task, which passes its result (or exception) to the future. The wrapper
+	 * aborts the executor if the command throws, and skips the command if it has been aborted.
+	 */
+	template<typename F>
+	std::future<decltype(std::declval<F>()())> Submit(F command)
+	{
+		typedef decltype(std::declval<F>()()) TResult;
+
+		RethrowFailure();
+
+		std::shared_ptr<std::packaged_task<TResult()> > pTask = std::make_shared<std::packaged_task<TResult()> >(
+				[this, command]() mutable -> TResult {
+					RethrowFailure();
+					try
+					{
+						return command();
+					}
+					catch (...)
+					{
+						Fail(std::current_exception());
+						throw;
+					}
+				});
+		std::future<TResult> result = pTask->get_future();
+		Enqueue([pTask] { (*pTask)(); });
+
+		return result;
+	}
+
+	void WaitUntilIdle();
+	void Finish();
+
+	// Statistics
+	double GetIdleTime() const;
+	unsigned int GetCommandsExecuted() const;
+
+	// === Exceptions ===============================================================================
+	struct Exception_ExecutorFinished
+	{
+	};
+
+private:
+	// === Private Functions ========================================================================
+	void Enqueue(std::function<void()> command);
+	void Run();
+	void Fail(std::exception_ptr failure);
+	void RethrowFailure() const;
+
+	// === Member Variables =========================================================================
+	CBoundedQueue<std::function<void()> > m_commands;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_idle;
+	unsigned int m_pending;			// Commands submitted but not yet finished
+	unsigned int m_executed;
+	double m_idleTime;
+	std::exception_ptr m_failure;	// Of the first command which failed; set once aborted
+
+	std::thread m_thread;
+};
+
+#endif /* SRC_CMOTIONEXECUTOR_H_ */
@@ -0,0 +1,178 @@
+/*
+ * CMotionExecutor_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CMotionExecutor.h"
+#include "CBoundedQueue.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test the bounded queue, and that the executor carries out commands in order on its own thread
+// while the caller carries on planning, and stops carrying them out once one fails
+int CMotionExecutor_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CMotionExecutor_test--\n\n";
+
+	int result = 0;
+
+	// -- The queue is first in, first out, and closes -- //
+	CBoundedQueue<int> queue { 2 };
+	int item = 0;
+	if (!queue.Push(1) || !queue.Push(2) || queue.Size() != 2 || !queue.TryPop(item) || item != 1)
+	{
+		cout << "The queue did not return its items in order\n";
+		result = 1;
+	}
+	queue.Close();
+	if (queue.Push(3) || !queue.Pop(item) || item != 2 || queue.Pop(item))
+	{
+		cout << "The queue did not close properly\n";
+		result = 1;
+	}
+
+	// -- A producer waits while the queue is full -- //
+	CBoundedQueue<int> fullQueue { 2 };
+	atomic<bool> producerFinished { false };
+	thread producer { [&] {
+		for (int i = 0; i < 3; ++i)
+			fullQueue.Push(i);
+		producerFinished = true;
+	} };
+	this_thread::sleep_for(chrono::milliseconds(20));
+	bool blocked = !producerFinished && fullQueue.Size() == 2;
+	fullQueue.Pop(item);
+	producer.join();
+	if (!blocked || fullQueue.Size() != 2)
+	{
+		cout << "The producer was not held back by the full queue\n";
+		result = 1;
+	}
+
+	// -- Commands are carried out in order on another thread -- //
+	CMotionExecutor executor { 4 };
+	vector<int> order;
+	atomic<bool> otherThread { true };
+	thread::id callerId = this_thread::get_id();
+	for (int i = 0; i < 20; ++i)
+	{
+		executor.Submit([&order, &otherThread, callerId, i] {
+			order.push_back(i);
+			if (this_thread::get_id() == callerId)
+				otherThread = false;
+		});
+	}
+	executor.WaitUntilIdle();
+	bool inOrder = order.size() == 20;
+	for (unsigned int i = 0; inOrder && i < order.size(); ++i)
+		inOrder = order[i] == static_cast<int>(i);
+	if (!inOrder || !otherThread || executor.GetCommandsExecuted() != 20)
+	{
+		cout << "The commands were not carried out in order on the motion thread\n";
+		result = 1;
+	}
+
+	// -- The caller plans while a command is being carried out: the command only finishes once it
+	// sees the plan, so this would time out if Submit waited for it -- //
+	promise<void> planned;
+	shared_future<void> plannedFuture = planned.get_future().share();
+	future<bool> sawPlan = executor.Submit([plannedFuture] {
+		return plannedFuture.wait_for(chrono::seconds(1)) == future_status::ready;
+	});
+	planned.set_value();
+	if (!sawPlan.get())
+	{
+		cout << "Submit waited for the command to be carried out\n";
+		result = 1;
+	}
+
+	// -- Results are passed back -- //
+	future<int> seven = executor.Submit([] { return 7; });
+	if (seven.get() != 7)
+	{
+		cout << "Results were not passed back\n";
+		result = 1;
+	}
+
+	// -- A failed command aborts the executor: the commands queued after it are not carried out,
+	// and the failure is thrown by their futures and by the next Submit and wait -- //
+	CMotionExecutor failingExecutor { 4 };
+	promise<void> release;
+	shared_future<void> releaseFuture = release.get_future().share();
+	future<void> failed = failingExecutor.Submit([releaseFuture] {
+		releaseFuture.wait();
+		throw runtime_error("Motion failed");
+	});
+	atomic<bool> ranAfter { false };
+	future<void> after = failingExecutor.Submit([&ranAfter] { ranAfter = true; });
+	release.set_value();
+
+	unsigned int rethrown = 0;
+	for (future<void>* pFuture : { &failed, &after })
+	{
+		try
+		{
+			pFuture->get();
+		}
+		catch (const runtime_error&)
+		{
+			++rethrown;
+		}
+	}
+	try
+	{
+		failingExecutor.WaitUntilIdle();
+	}
+	catch (const runtime_error&)
+	{
+		++rethrown;
+	}
+	try
+	{
+		failingExecutor.Submit([] {});
+	}
+	catch (const runtime_error&)
+	{
+		++rethrown;
+	}
+	if (rethrown != 4 || ranAfter)
+	{
+		cout << "A failed command did not abort the commands after it\n";
+		result = 1;
+	}
+
+	// -- Nothing can be submitted once finished -- //
+	executor.Finish();
+	bool rejected = false;
+	try
+	{
+		executor.Submit([] {});
+	}
+	catch (const CMotionExecutor::Exception_ExecutorFinished&)
+	{
+		rejected = true;
+	}
+	if (!rejected)
+	{
+		cout << "A command was accepted after finishing\n";
+		result = 1;
+	}
+	cout << "Idle time between commands: " << executor.GetIdleTime() << "s\n";
+
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
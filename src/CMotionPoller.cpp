@@ -0,0 +1,171 @@
+/*
+ * CMotionPoller.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMotionPoller.h"
+#include "pi_spi.h"
+#include <algorithm>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+
+// -/-/-/-/-/-/-/ CMotionHandle /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+EMotionStatus CMotionHandle::GetStatus() const
+{
+	if (!m_state)
+		return EMotionStatus_Discarded;
+
+	lock_guard<mutex> lock { m_state->m_mutex };
+	return m_state->m_status;
+}
+
+EMotionStatus CMotionHandle::Wait() const
+{
+	DEBUG_METHOD();
+
+	if (!m_state)
+		return EMotionStatus_Discarded;
+
+	unique_lock<mutex> lock { m_state->m_mutex };
+	m_state->m_ended.wait(lock, [this] {return m_state->m_status != EMotionStatus_Pending;});
+	return m_state->m_status;
+}
+
+bool CMotionHandle::WaitFor(uint32_t timeout) const
+{
+	DEBUG_METHOD();
+
+	if (!m_state)
+		return true;
+
+	unique_lock<mutex> lock { m_state->m_mutex };
+	return m_state->m_ended.wait_for(lock, chrono::milliseconds(timeout),
+			[this] {return m_state->m_status != EMotionStatus_Pending;});
+}
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CMotionPoller::CMotionPoller(uint32_t period)
+		: m_period { period > 0 ? period : 1 }, m_running { false }, m_stopping { false }, m_polls { 0 }
+{
+	DEBUG_METHOD();
+}
+
+CMotionPoller::~CMotionPoller()
+{
+	DEBUG_METHOD();
+
+	{
+		lock_guard<mutex> lock { m_mutex };
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function sends a motion without stalling, and starts the poller thread if it is not
+ * running. Exception_SPITimeout is passed on if the PIC does not queue the motion.
+ */
+CMotionHandle CMotionPoller::Send(state_t state, condition_t termination, uint16_t termination_val)
+{
+	DEBUG_METHOD();
+
+	lock_guard<mutex> lock { m_mutex };
+
+	shared_ptr<CMotionHandle::SState> motion = make_shared<CMotionHandle::SState>();
+	motion->m_sequence = pic_write_state_async(state, termination, termination_val);
+	motion->m_sent = chrono::steady_clock::now();
+	motion->m_status = EMotionStatus_Pending;
+	m_pending.push_back(motion);
+
+	// The thread stops when nothing is pending; it has let go of the mutex, so it can be joined
+	if (!m_running)
+	{
+		if (m_thread.joinable())
+			m_thread.join();
+		m_running = true;
+		m_thread = thread { &CMotionPoller::Run, this };
+	}
+
+	return CMotionHandle { motion };
+}
+
+CMotionPoller& CMotionPoller::Default()
+{
+	static CMotionPoller poller;
+	return poller;
+}
+
+unsigned int CMotionPoller::GetPending() const
+{
+	lock_guard<mutex> lock { m_mutex };
+	return m_pending.size();
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function is the poller thread. Each period it collects the DONEs which have come and
+ * resolves their motions, then resolves the motions which are no longer pending on the Pi (they
+ * were discarded) or have taken too long. It stops once nothing is pending.
+ */
+void CMotionPoller::Run()
+{
+	// Logging each poll would fill the log while the robot drives
+	DEBUG_MUTE_THREAD(true);
+
+	unique_lock<mutex> lock { m_mutex };
+	while (!m_stopping && !m_pending.empty())
+	{
+		uint16_t finished[PIC_MOTION_QUEUE_LENGTH];
+		uint32_t count = pic_poll_motions(finished, PIC_MOTION_QUEUE_LENGTH);
+		++m_polls;
+
+		uint32_t motionTimeout = get_spi_wait_policy().motion_timeout_us;
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		for (size_t i = 0; i < m_pending.size();)
+		{
+			CMotionHandle::SState& motion = *m_pending[i];
+			if (find(finished, finished + count, motion.m_sequence) != finished + count)
+				Resolve(motion, EMotionStatus_Done);
+			else if (!pic_motion_pending(motion.m_sequence))
+				Resolve(motion, EMotionStatus_Discarded);
+			else if (motionTimeout && now - motion.m_sent >= chrono::microseconds(motionTimeout))
+			{
+				// Given up on, so pi_spi no longer waits for its DONE either
+				pic_forget_motion(motion.m_sequence);
+				Resolve(motion, EMotionStatus_TimedOut);
+			}
+			else
+			{
+				++i;
+				continue;
+			}
+			m_pending.erase(m_pending.begin() + i);
+		}
+
+		if (!m_pending.empty())
+			m_wake.wait_for(lock, chrono::microseconds(m_period), [this] {return m_stopping;});
+	}
+	m_running = false;
+
+	DEBUG_MUTE_THREAD(false);
+}
+
+void CMotionPoller::Resolve(CMotionHandle::SState& state, EMotionStatus status)
+{
+	{
+		lock_guard<mutex> lock { state.m_mutex };
+		state.m_status = status;
+	}
+	state.m_ended.notify_all();
+}
@@ -0,0 +1,142 @@
+/*
+ * CMotionPoller.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMOTIONPOLLER_H_
+#define SRC_CMOTIONPOLLER_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "pic_enums.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ~~~ ENUMS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// How a motion sent without stalling ended
+enum EMotionStatus
+{
+	EMotionStatus_Pending,		// Not finished yet
+	EMotionStatus_Done,			// The PIC sent its DONE
+	EMotionStatus_Discarded,	// Thrown away by STOPPED or a flush before it finished
+	EMotionStatus_TimedOut		// No DONE within the motion timeout of the SPI wait policy
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a handle on one motion sent without stalling, like a future: it can be looked at
+ * without waiting, waited on, or waited on for at most a time. It is resolved by a CMotionPoller.
+ *
+ * Handles are cheap to copy; copies share the motion.
+ *
+ * Public Methods:
+ *    - IsValid() - Whether the handle is on a motion (a default constructed one is not).
+ *    - IsDone() - Whether the motion has ended, however it ended. Does not wait.
+ *    - GetStatus() - How the motion ended, or EMotionStatus_Pending. Does not wait.
+ *    - Wait() - Waits for the motion to end, and returns how it ended.
+ *    - WaitFor(timeout) - Waits at most timeout milliseconds. Returns whether the motion ended.
+ *    - GetSequence() - The sequence number of the motion's frame.
+ *
+ */
+class CMotionHandle
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CMotionHandle() {}
+
+	// === Public Functions =========================================================================
+	bool IsValid() const {return m_state != nullptr;}
+	bool IsDone() const {return GetStatus() != EMotionStatus_Pending;}
+	EMotionStatus GetStatus() const;
+	EMotionStatus Wait() const;
+	bool WaitFor(uint32_t timeout) const;
+	uint16_t GetSequence() const {return m_state ? m_state->m_sequence : 0;}
+
+private:
+	friend class CMotionPoller;
+
+	// === Private Types ============================================================================
+	struct SState
+	{
+		uint16_t m_sequence;
+		std::chrono::steady_clock::time_point m_sent;
+		EMotionStatus m_status;
+		std::mutex m_mutex;
+		std::condition_variable m_ended;
+	};
+
+	// === Private Functions ========================================================================
+	explicit CMotionHandle(const std::shared_ptr<SState>& state) : m_state { state } {}
+
+	// === Member Variables =========================================================================
+	std::shared_ptr<SState> m_state;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to send motions without stalling and find out when each one finishes, so the
+ * program can get on with planning or camera work while the robot drives.
+ *
+ * Send queues the motion on the PIC (pic_write_state_async) and returns a CMotionHandle on it.
+ * While any motion is pending, a poller thread collects the DONEs from the PIC every period
+ * (pic_poll_motions) and resolves the handles they belong to, matching them by sequence number.
+ * It also resolves the motions thrown away by STOPPED or a flush, and those which take longer than
+ * the motion timeout of the SPI wait policy. The thread stops when no motion is pending, so the
+ * link is left alone when there is nothing to wait for.
+ *
+ * Each poll holds the SPI link for one read, so other commands (and CSensorAcquisition) go on
+ * between polls. The poller collects the DONEs itself, so Wait_Done (CGoodsOut::WaitMotionDone,
+ * CMotionQueue) must not be used for motions sent through it.
+ *
+ * Public Constructors:
+ *    - CMotionPoller(period) - Polls every period microseconds while a motion is pending.
+ *
+ * Public Methods:
+ *    - Send(state, termination, value) - Sends a motion without stalling. Returns its handle.
+ *    - GetPending() - The motions sent and not yet ended.
+ *    - GetPolls() - The polls made so far.
+ *    - Default() - The poller used by CGoodsOut.
+ *
+ */
+class CMotionPoller
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMotionPoller(uint32_t period = 1000);
+	~CMotionPoller();
+
+	CMotionPoller(const CMotionPoller&) = delete;
+	CMotionPoller& operator=(const CMotionPoller&) = delete;
+
+	// === Public Functions =========================================================================
+	CMotionHandle Send(state_t state, condition_t termination, uint16_t termination_val);
+	static CMotionPoller& Default();
+
+	// Access functions
+	unsigned int GetPending() const;
+	uint64_t GetPolls() const {return m_polls.load();}
+
+private:
+	// === Private Functions ========================================================================
+	void Run();
+	static void Resolve(CMotionHandle::SState& state, EMotionStatus status);
+
+	// === Member Variables =========================================================================
+	const uint32_t m_period;		// Microseconds
+
+	// Held while sending and while polling, so a DONE is never collected before its motion is known
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::vector<std::shared_ptr<CMotionHandle::SState> > m_pending;
+	bool m_running;
+	bool m_stopping;
+	std::atomic<uint64_t> m_polls;
+
+	std::thread m_thread;
+};
+
+#endif /* SRC_CMOTIONPOLLER_H_ */
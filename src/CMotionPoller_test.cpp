@@ -0,0 +1,120 @@
+/*
+ * CMotionPoller_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CMotionPoller.h"
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include "Manouvre.h"
+#include "pi_spi.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that motions sent without stalling can be followed through their handles while the program
+// does other work on the link, that the handles resolve in order, and that waits time out and
+// flushed or overdue motions are reported as such
+int CMotionPoller_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CMotionPoller_test--\n\n";
+
+	int result = 0;
+
+	CPicEmulator pic;
+	pic.Attach();
+
+	// Each motion takes 20 polls to finish
+	SPicLatency latency;
+	latency.m_motionPolls = 20;
+	pic.SetLatency(latency);
+
+	// -- Carrying on while a motion is driven -- //
+	CMotionHandle handle = CGoodsOut::ForwardAsync(600, false);
+	bool pendingAtFirst = !handle.IsDone() && handle.IsValid();
+
+	unsigned int reads = 0;
+	while (!handle.IsDone())
+	{
+		pic_read_compass();
+		++reads;
+		this_thread::sleep_for(chrono::microseconds(200));
+	}
+	if (!pendingAtFirst || handle.Wait() != EMotionStatus_Done || reads == 0 || pic.GetExecutedMotions().size() != 1)
+	{
+		cout << "Motion was not followed while working\n";
+		result = 1;
+	}
+	cout << "Motion finished after " << reads << " compass reads on the same link, "
+			<< CMotionPoller::Default().GetPolls() << " polls\n";
+
+	// -- Several motions, resolved in order -- //
+	vector<SMotion> motions = {
+			{ EMotion_Forward, 300, true },
+			{ EMotion_TurnLeft90, 0, false },
+			{ EMotion_Forward, 600, false } };
+	vector<CMotionHandle> handles;
+	for (unsigned int i = 0; i < motions.size(); ++i)
+		handles.push_back(CManouvre::StartMotion(motions[i]));
+
+	bool inOrder = handles[0].Wait() == EMotionStatus_Done && !handles[2].IsDone();
+	inOrder = inOrder && handles[1].Wait() == EMotionStatus_Done && handles[2].Wait() == EMotionStatus_Done;
+	if (!inOrder || pic.GetExecutedMotions().size() != 4 || pic.GetExecutedMotions()[2].m_type != EMotion_TurnLeft90)
+	{
+		cout << "Motions were not resolved in order\n";
+		result = 1;
+	}
+
+	// -- Timed out waits and flushed motions -- //
+	latency.m_motionPolls = 1000000;
+	pic.SetLatency(latency);
+
+	handle = CGoodsOut::TurnRight90Async();
+	if (handle.WaitFor(5))
+	{
+		cout << "Wait did not time out\n";
+		result = 1;
+	}
+	CGoodsOut::FlushMotions();
+	if (handle.Wait() != EMotionStatus_Discarded)
+	{
+		cout << "Flushed motion was not discarded\n";
+		result = 1;
+	}
+
+	spi_wait_policy_t defaultPolicy = get_spi_wait_policy();
+	spi_wait_policy_t shortPolicy = defaultPolicy;
+	shortPolicy.motion_timeout_us = 20000;
+	set_spi_wait_policy(shortPolicy);
+	handle = CGoodsOut::TurnRight90Async();
+	if (handle.Wait() != EMotionStatus_TimedOut || pic_motion_pending(handle.GetSequence()))
+	{
+		cout << "Overdue motion did not time out, or was still followed\n";
+		result = 1;
+	}
+	set_spi_wait_policy(defaultPolicy);
+	CGoodsOut::FlushMotions();
+
+	if (CMotionPoller::Default().GetPending() != 0 || CMotionHandle().IsValid())
+	{
+		cout << "Motions were left pending\n";
+		result = 1;
+	}
+
+	pic.Detach();
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
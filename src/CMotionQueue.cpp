@@ -0,0 +1,90 @@
+/*
+ * CMotionQueue.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CMotionQueue.h"
+#include "GoodsOut.h"
+#include "DebugLog.hpp"
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CMotionQueue::CMotionQueue(unsigned int depth)
+		: m_depth { depth < 1 ? 1 : (depth > PIC_MOTION_QUEUE_LENGTH ? PIC_MOTION_QUEUE_LENGTH : depth) },
+		  m_inFlight { 0 }, m_completed { 0 }
+{
+	DEBUG_METHOD();
+}
+
+CMotionQueue::~CMotionQueue()
+{
+	DEBUG_METHOD();
+
+	if (m_inFlight == 0)
+		return;
+
+	// Only left with motions on the PIC if something threw, so this must not throw as well
+	try
+	{
+		Abort();
+	}
+	catch (...)
+	{
+		DEBUG_MESSAGE("Motions left on the PIC could not be flushed");
+	}
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function sends a motion to the PIC without stalling. If depth motions are already on the
+ * PIC, it first waits for the oldest to finish.
+ */
+void CMotionQueue::Push(const SMotion& motion)
+{
+	DEBUG_METHOD();
+
+	while (m_inFlight >= m_depth)
+		WaitForOne();
+
+	switch (motion.m_type)
+	{
+	case EMotion_Forward:
+		CGoodsOut::Forward(motion.m_distance, motion.m_watchSensors, false);
+		break;
+	case EMotion_TurnLeft90:
+		CGoodsOut::TurnLeft90(false);
+		break;
+	case EMotion_TurnRight90:
+		CGoodsOut::TurnRight90(false);
+		break;
+	}
+	++m_inFlight;
+}
+
+void CMotionQueue::Drain()
+{
+	DEBUG_METHOD();
+
+	while (m_inFlight > 0)
+		WaitForOne();
+}
+
+void CMotionQueue::Abort()
+{
+	DEBUG_METHOD();
+
+	CGoodsOut::FlushMotions();
+	m_inFlight = 0;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+// Reads the DONE of the oldest motion on the PIC
+void CMotionQueue::WaitForOne()
+{
+	CGoodsOut::WaitMotionDone();
+	--m_inFlight;
+	++m_completed;
+}
@@ -0,0 +1,69 @@
+/*
+ * CMotionQueue.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CMOTIONQUEUE_H_
+#define SRC_CMOTIONQUEUE_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "Manouvre.h"
+#include "pic_enums.h"
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to keep the next motions queued on the PIC, so that the robot goes from one
+ * motion to the next without stopping for the SPI handshake in between.
+ *
+ * Motions are sent through CGoodsOut without stalling, and the PIC sends a DONE as each one
+ * finishes. At most 'depth' motions are sent but not finished at once: Push waits for the oldest
+ * DONE before sending another. A depth of 1 drives one motion at a time, as sending with stall
+ * does; a depth of 2 or more lets the next motion be waiting on the PIC when the current one ends.
+ *
+ * Abort stops the robot at once with CGoodsOut::FlushMotions, which also discards the DONEs of
+ * the motions thrown away, so the queue can be used again straight after. A queue which goes with
+ * motions still on the PIC (e.g. because waiting for one threw) aborts them, so they are not left
+ * to drive on their own.
+ *
+ * Public Constructors:
+ *    - CMotionQueue(depth) - An empty queue, with at most depth motions on the PIC (limited to
+ *    	PIC_MOTION_QUEUE_LENGTH).
+ *
+ * Public Methods:
+ *    - Push(motion) - Sends a motion, first waiting for one to finish if depth are on the PIC.
+ *    - Drain() - Waits for every motion sent to finish.
+ *    - Abort() - Stops the robot and discards every motion not finished.
+ *    - GetInFlight/GetDepth/GetCompleted - The state of the queue.
+ *
+ */
+class CMotionQueue
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CMotionQueue(unsigned int depth = 2);
+	~CMotionQueue();
+
+	CMotionQueue(const CMotionQueue&) = delete;
+	CMotionQueue& operator=(const CMotionQueue&) = delete;
+
+	// === Public Functions =========================================================================
+	void Push(const SMotion& motion);
+	void Drain();
+	void Abort();
+
+	// Access functions
+	unsigned int GetInFlight() const {return m_inFlight;}
+	unsigned int GetDepth() const {return m_depth;}
+	unsigned int GetCompleted() const {return m_completed;}
+
+private:
+	// === Private Functions ========================================================================
+	void WaitForOne();
+
+	// === Member Variables =========================================================================
+	unsigned int m_depth;
+	unsigned int m_inFlight;		// Motions sent whose DONE has not been read
+	unsigned int m_completed;		// DONEs read
+};
+
+#endif /* SRC_CMOTIONQUEUE_H_ */
@@ -0,0 +1,228 @@
+/*
+ * CMotionQueue_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CMotionQueue.h"
+#include "CPicEmulator.h"
+#include "CMazeGeometry.h"
+#include "Instructions.h"
+#include "Manouvre.h"
+#include "pi_spi.h"
+#include <future>
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that queued motions are driven in order on an emulated PIC, blending from one to the next,
+// that the lookahead is bounded by the depth, and that aborting (or failing) flushes them safely.
+// Also that a streamed route is driven as the same commands as the whole route.
+int CMotionQueue_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CMotionQueue_test--\n\n";
+
+	int result = 0;
+
+	vector<SMotion> motions = {
+			{ EMotion_Forward, 300, true },
+			{ EMotion_TurnLeft90, 0, false },
+			{ EMotion_Forward, 600, false },
+			{ EMotion_TurnRight90, 0, false },
+			{ EMotion_Forward, 300, true } };
+
+	// -- Stalling on each motion: the robot stops after every one -- //
+	{
+		CPicEmulator pic;
+		pic.Attach();
+
+		CManouvre::ExecuteMotions(motions);
+		if (pic.GetExecutedMotions() != motions || pic.GetBlendedTransitions() != 0 || pic.GetStops() != motions.size())
+		{
+			cout << "Stalled motions were not driven one at a time\n";
+			result = 1;
+		}
+		cout << "Stalled: " << pic.GetStops() << " stops, " << pic.GetBlendedTransitions() << " blended transitions\n";
+	}
+
+	// -- Lookahead of two -- //
+	{
+		CPicEmulator pic;
+		pic.Attach();
+
+		CMotionQueue queue(2);
+		for (unsigned int i = 0; i < motions.size(); ++i)
+		{
+			queue.Push(motions[i]);
+			if (queue.GetInFlight() > queue.GetDepth() || pic.GetQueuedMotions() > queue.GetDepth())
+				result = 1;
+		}
+		queue.Drain();
+
+		if (pic.GetExecutedMotions() != motions || queue.GetInFlight() != 0 || queue.GetCompleted() != motions.size())
+		{
+			cout << "Queued motions were not all driven in order\n";
+			result = 1;
+		}
+		if (pic.GetBlendedTransitions() != motions.size() - 1 || pic.GetStops() != 1 || pic.GetMaxMotionsQueued() != 2)
+		{
+			cout << "Queued motions did not blend (" << pic.GetBlendedTransitions() << " blended, " << pic.GetStops()
+					<< " stops, " << pic.GetMaxMotionsQueued() << " queued at most)\n";
+			result = 1;
+		}
+		cout << "Lookahead 2: " << pic.GetStops() << " stops, " << pic.GetBlendedTransitions() << " blended transitions\n";
+
+		// The depth is limited to what the PIC can hold
+		if (CMotionQueue(0).GetDepth() != 1 || CMotionQueue(100).GetDepth() != PIC_MOTION_QUEUE_LENGTH)
+		{
+			cout << "Depth was not limited\n";
+			result = 1;
+		}
+	}
+
+	// -- Through CManouvre -- //
+	{
+		CPicEmulator pic;
+		pic.Attach();
+
+		CManouvre::SetMotionLookahead(2);
+		CManouvre::ExecuteMotions(motions);
+		CManouvre::SetMotionLookahead(0);
+
+		if (pic.GetExecutedMotions() != motions || pic.GetBlendedTransitions() != motions.size() - 1)
+		{
+			cout << "ExecuteMotions did not use the lookahead\n";
+			result = 1;
+		}
+	}
+
+	// -- Abort with motions still queued -- //
+	{
+		CPicEmulator pic;
+		pic.Attach();
+
+		CMotionQueue queue(2);
+		queue.Push(motions[0]);
+		queue.Push(motions[1]);
+		queue.Abort();
+
+		if (pic.GetQueuedMotions() != 0 || queue.GetInFlight() != 0 || !pic.GetExecutedMotions().empty())
+		{
+			cout << "Abort did not flush the queued motions\n";
+			result = 1;
+		}
+
+		// The queue can be used straight after, without reading stale DONEs
+		queue.Push(motions[2]);
+		queue.Push(motions[3]);
+		queue.Drain();
+		if (pic.GetExecutedMotions() != vector<SMotion> { motions[2], motions[3] } || pic.GetQueuedMotions() != 0)
+		{
+			cout << "Motions after an abort were not driven\n";
+			result = 1;
+		}
+	}
+
+	// -- A wait which throws leaves nothing on the PIC -- //
+	{
+		CPicEmulator pic;
+		pic.Attach();
+		SPicLatency latency;
+		latency.m_motionPolls = 1000000;
+		pic.SetLatency(latency);
+
+		spi_wait_policy_t defaultPolicy = get_spi_wait_policy();
+		spi_wait_policy_t shortPolicy = defaultPolicy;
+		shortPolicy.motion_timeout_us = 20000;
+		set_spi_wait_policy(shortPolicy);
+
+		bool threw = false;
+		CManouvre::SetMotionLookahead(2);
+		try
+		{
+			CManouvre::ExecuteMotions(motions);
+		}
+		catch (Exception_SPITimeout& e)
+		{
+			threw = true;
+		}
+		CManouvre::SetMotionLookahead(0);
+		set_spi_wait_policy(defaultPolicy);
+
+		if (!threw || pic.GetQueuedMotions() != 0)
+		{
+			cout << "Motions were left on the PIC after a failed wait\n";
+			result = 1;
+		}
+	}
+
+	// -- Streamed routes: the same joined commands as following the whole route -- //
+	// North up a corridor from the entrance, then right and on East
+	{
+		CMazeGeometry geometry { 10, 10 };
+		vector<int> route = { geometry.RoomVertex(90, EOrientation_South) };
+		for (int room = 90; room >= 60; room -= 10)
+			route.push_back(geometry.RoomVertex(room, EOrientation_North));
+		route.push_back(geometry.RoomVertex(50, EOrientation_East));
+		route.push_back(geometry.RoomVertex(51, EOrientation_East));
+		CInstructions instructions { route, 10 };
+
+		vector<SMotion> whole;
+		{
+			CPicEmulator pic;
+			pic.Attach();
+			CManouvre::FollowInstructions(instructions.GetInstructions());
+			whole = pic.GetExecutedMotions();
+		}
+
+		// One vertex at a time, driving what is known after each
+		vector<SMotion> available;
+		{
+			CPicEmulator pic;
+			pic.Attach();
+			CInstructionStream stream { geometry };
+			for (unsigned int i = 0; i < route.size(); ++i)
+			{
+				stream.Append(route[i]);
+				CManouvre::FollowAvailableInstructions(stream);
+			}
+			stream.Close();
+			CManouvre::FollowAvailableInstructions(stream);
+			available = pic.GetExecutedMotions();
+		}
+
+		// Read on another thread while the route is extended
+		vector<SMotion> followed;
+		{
+			CPicEmulator pic;
+			pic.Attach();
+			CInstructionStream stream { geometry };
+			future<unsigned int> drive = async(launch::async, [&stream]() {
+				return CManouvre::FollowStream(stream);
+			});
+			for (unsigned int i = 0; i < route.size(); ++i)
+				stream.Append(route[i]);
+			stream.Close();
+			drive.get();
+			followed = pic.GetExecutedMotions();
+		}
+
+		if (whole.size() != 4 || available != whole || followed != whole)
+		{
+			cout << "Streamed route was not driven as the whole route (" << whole.size() << ", " << available.size()
+					<< " and " << followed.size() << " commands)\n";
+			result = 1;
+		}
+	}
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,688 @@
+/*
+ * CPicEmulator.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CPicEmulator.h"
+#include "CRouteProgram.h"
+#include "pi_spi.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+SPicLatency::SPicLatency()
+		: m_replyPolls { 0 }, m_motionPolls { 0 }, m_replyDelay { 0 }, m_transferTime { 0 }, m_byteTime { 0 }
+{
+}
+
+CPicEmulator::CPicEmulator()
+		: m_sequence { 0 }, m_lastSequence { 0 }, m_dataPending { false }, m_payloadBytes { 0 }, m_payloadChecksum { 0 },
+		  m_payloadIsBatch { false }, m_batchCommandsLeft { 0 }, m_replyPollsLeft { 0 }, m_readyLine { false }, m_transferCount { 0 },
+		  m_bytesTransferred { 0 }, m_busyReads { 0 }, m_corruptNextRoute { false }, m_corruptNextData { false },
+		  m_stallPolls { 0 }, m_dropNextReply { false }, m_bitErrorRate { 0 }, m_bitsToNextError { 0 },
+		  m_bitErrors { 0 }, m_corruptFrames { 0 }, m_replays { 0 }, m_grabber { GRAB_OPEN }, m_motorSpeeds { 0, 0 }, m_encoders { 0, 0 }, m_compass { 0 },
+		  m_led { OFF }, m_dip { 0 }, m_roomType { ERoom_Unknown }, m_photosensors(PHOTOSENSORS),
+		  m_photosensorPositions(PHOTOSENSORS, 0), m_frameSequence { 0 },
+		  m_startTime { chrono::steady_clock::now() }, m_routeStatus { ROUTE_IDLE }, m_completed { 0 },
+		  m_advanceOnProgressRead { true }, m_motionPollsLeft { 0 }, m_maxMotionsQueued { 0 },
+		  m_blendedTransitions { 0 }, m_stops { 0 }
+{
+	DEBUG_METHOD();
+}
+
+CPicEmulator::~CPicEmulator()
+{
+	DEBUG_METHOD();
+
+	Detach();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CPicEmulator::Attach()
+{
+	DEBUG_METHOD();
+
+	set_spi_transport(this);
+}
+
+void CPicEmulator::Detach()
+{
+	DEBUG_METHOD();
+
+	if (get_spi_transport() == this)
+		set_spi_transport(nullptr);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function is one SPI transfer. It takes the real time set by the latency, spinning rather
+ * than sleeping since a transfer on the robot takes only a few microseconds.
+ */
+int CPicEmulator::Transfer(int /*channel*/, unsigned char* data, int len)
+{
+	++m_transferCount;
+	m_bytesTransferred += len;
+
+	double microseconds = m_latency.m_transferTime + len*m_latency.m_byteTime;
+	if (microseconds > 0)
+	{
+		chrono::steady_clock::time_point end = chrono::steady_clock::now()
+				+ chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, micro>(microseconds));
+		while (chrono::steady_clock::now() < end)
+			;
+	}
+
+	// Bit errors both ways: in what the Pi sends, and in what the 'PIC' sends back
+	InjectBitErrors(data, len);
+	HandleTransfer(data, len);
+	InjectBitErrors(data, len);
+	return len;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function waits for the ready line. If a reply or a motion's DONE is coming, the line is
+ * raised as soon as it is due (skipping the polls); otherwise nothing will be sent, and the wait
+ * runs to the timeout.
+ */
+bool CPicEmulator::WaitReady(uint32_t timeout_us)
+{
+	chrono::steady_clock::time_point end = chrono::steady_clock::now() + chrono::microseconds(timeout_us);
+
+	if (!m_replies.empty())
+	{
+		m_replyPollsLeft = 0;
+		this_thread::sleep_until(min(end, m_replyReadyTime));
+		return chrono::steady_clock::now() >= m_replyReadyTime;
+	}
+	if (!m_events.empty() || !m_motions.empty())
+	{
+		m_motionPollsLeft = 0;
+		return true;
+	}
+
+	this_thread::sleep_until(end);
+	return false;
+}
+
+// Complete the next word of the running route, or else the motion being driven
+void CPicEmulator::Tick()
+{
+	DEBUG_METHOD();
+
+	if (m_routeStatus != ROUTE_RUNNING)
+	{
+		CompleteMotion();
+		return;
+	}
+
+	static const uint16_t ROUTE_STATES[5] = { STOPPED, PSNS_FORWARD, ECDR_FORWARD, COMP_LEFT, COMP_RIGHT };
+	uint16_t word = m_program[m_completed];
+	ApplyMotion(ROUTE_STATES[CRouteProgram::Opcode(word)], CRouteProgram::Argument(word));
+
+	if (++m_completed == m_program.size())
+		m_routeStatus = ROUTE_COMPLETE;
+}
+
+// The samples read from one photosensor, in turn (starting again after the last)
+void CPicEmulator::SetPhotosensor(unsigned int sensor, const vector<uint16_t>& samples)
+{
+	DEBUG_METHOD();
+
+	m_photosensors.at(sensor) = samples;
+	m_photosensorPositions.at(sensor) = 0;
+}
+
+// Flip bits at random: rate is the chance of each bit being flipped, each way
+void CPicEmulator::SetBitErrorRate(double rate, unsigned int seed)
+{
+	DEBUG_METHOD();
+
+	m_bitErrorRate = rate;
+	m_random.seed(seed);
+	if (rate > 0)
+		m_bitsToNextError = geometric_distribution<uint64_t>(rate)(m_random);
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function handles one SPI transfer. SPI is full duplex: data holds what the Pi sends, and is
+ * overwritten with what the 'PIC' sends back.
+ *
+ * A 16 byte transfer is a command. A transfer straight after WRITE_ROUTE or BATCH is the route or
+ * the batch's commands. A 2 byte transfer is the Pi's closing DONE, which is just accepted, or
+ * RESEND, which queues the last reply again. Any other transfer reads the next queued reply, then
+ * the next DONE of a finished motion; the data after a DATA is read straight away, whatever its
+ * length. If there is nothing to read but a motion is being driven, it finishes (the Pi is waiting
+ * for it); otherwise the read gets zeros, meaning 'busy'.
+ */
+void CPicEmulator::HandleTransfer(unsigned char* data, int len)
+{
+	if (len == 0)
+		return;
+
+	// -- The commands of a batch, then their CRC -- //
+	if (m_payloadBytes > 0 && m_payloadIsBatch)
+	{
+		int commandBytes = 8*m_batchCommandsLeft;
+		m_payloadBytes = 0;
+		if (len != commandBytes + 2 || spi_crc16(data, commandBytes) != ((data[commandBytes] << 8) | data[commandBytes + 1]))
+		{
+			++m_corruptFrames;
+			QueueStatus(RESEND);
+			return;
+		}
+
+		for (int i = 0; i < commandBytes; i += 8)
+			RunBatchCommand(data + i);
+		QueueBatchReply();
+		FinishReply();
+		return;
+	}
+
+	// -- Route words -- //
+	if (m_payloadBytes > 0)
+	{
+		m_program.resize(len / 2);
+		for (unsigned int i = 0; i < m_program.size(); ++i)
+			m_program[i] = (data[2*i] << 8) | data[2*i + 1];
+		m_payloadBytes = 0;
+
+		if (m_corruptNextRoute && !m_program.empty())
+			m_program[0] ^= 0x0001;
+		m_corruptNextRoute = false;
+
+		bool valid = route_checksum(m_program.data(), m_program.size()) == m_payloadChecksum;
+		if (valid)
+		{
+			try
+			{
+				CRouteProgram::Decode(m_program);
+			}
+			catch (CRouteProgram::Exception_InvalidWord& e)
+			{
+				valid = false;
+			}
+		}
+
+		m_completed = 0;
+		m_executedMotions.clear();
+		m_routeStatus = valid ? (m_program.empty() ? ROUTE_COMPLETE : ROUTE_RUNNING) : ROUTE_REJECTED;
+		QueueStatus(valid ? DONE : REJECT);
+		FinishReply();
+		return;
+	}
+
+	// -- The data after a DATA -- //
+	if (m_dataPending)
+	{
+		m_dataPending = false;
+		memset(data, 0, len);
+		if (!m_replies.empty())
+		{
+			memcpy(data, m_replies.front().data(), min<size_t>(len, m_replies.front().size()));
+			m_replies.pop_front();
+		}
+		return;
+	}
+
+	// -- Commands -- //
+	if (len == 16)
+	{
+		HandleCommand(data);
+		memset(data, 0, len);
+		return;
+	}
+
+	// -- The Pi's closing DONE, or RESEND -- //
+	if (len == 2)
+	{
+		if (((data[0] << 8) | data[1]) == RESEND)
+			ReplayLastReply();
+		return;
+	}
+
+	// -- Reads -- //
+	memset(data, 0, len);
+	if (!m_replies.empty() && (m_replyPollsLeft > 0 || chrono::steady_clock::now() < m_replyReadyTime))
+	{
+		if (m_replyPollsLeft > 0)
+			--m_replyPollsLeft;
+		++m_busyReads;
+		return;
+	}
+	if (m_replies.empty() && m_events.empty() && !m_motions.empty())
+	{
+		if (m_motionPollsLeft > 0)
+		{
+			--m_motionPollsLeft;
+			++m_busyReads;
+			return;
+		}
+		CompleteMotion();
+	}
+
+	deque<vector<unsigned char> >& source = m_replies.empty() ? m_events : m_replies;
+	if (source.empty())
+	{
+		++m_busyReads;
+		return;
+	}
+
+	memcpy(data, source.front().data(), min<size_t>(len, source.front().size()));
+	uint16_t status;
+	memcpy(&status, source.front().data(), sizeof(status));
+	m_dataPending = &source == &m_replies && status == DATA;
+	source.pop_front();
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function handles a command frame. A frame whose CRC is wrong is answered RESEND (with no
+ * sequence number, since it cannot be trusted). A frame with the same sequence number as the last
+ * one carried out was sent again because the reply was lost, so the reply is repeated and the
+ * command is not carried out again.
+ */
+void CPicEmulator::HandleCommand(const unsigned char* data)
+{
+	m_replies.clear();
+	m_replyPollsLeft = m_latency.m_replyPolls + m_stallPolls;
+	m_replyReadyTime = chrono::steady_clock::now()
+			+ chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, micro>(m_latency.m_replyDelay));
+	m_stallPolls = 0;
+
+	if (spi_crc16(data, 14) != ((data[14] << 8) | data[15]))
+	{
+		++m_corruptFrames;
+		m_sequence = 0;
+		QueueStatus(RESEND);
+		return;
+	}
+
+	m_sequence = (data[12] << 8) | data[13];
+	if (m_sequence == m_lastSequence)
+	{
+		ReplayLastReply();
+		return;
+	}
+
+	uint16_t words[4];
+	ReadWords(data, words);
+
+	if (words[0] == BATCH)
+	{
+		// The commands follow in the next transfer
+		m_batchResults.clear();
+		m_batchCommandsLeft = words[1];
+		if (m_batchCommandsLeft > 0)
+		{
+			m_payloadBytes = 8*m_batchCommandsLeft + 2;
+			m_payloadIsBatch = true;
+			return;
+		}
+		QueueBatchReply();
+	}
+	else
+	{
+		vector<uint16_t> reply;
+		switch (ExecuteCommand(words, reply))
+		{
+		case EReply_Done:
+			QueueStatus(DONE);
+			break;
+		case EReply_Data:
+			QueueData(reply);
+			break;
+		case EReply_None:
+			// A route replies when its words have come
+			if (m_payloadBytes > 0)
+				return;
+
+			// A motion sent without stalling is acknowledged at once
+			if (words[3])
+				QueueStatus(QUEUED);
+			break;
+		}
+	}
+
+	FinishReply();
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function is called once a command has been carried out. The reply is kept in case the Pi
+ * asks for it again, then any fault due is applied to what is sent this time.
+ */
+void CPicEmulator::FinishReply()
+{
+	m_lastSequence = m_sequence;
+	m_lastReply = m_replies;
+
+	if (m_corruptNextData && m_replies.size() > 1)
+	{
+		uint16_t status;
+		memcpy(&status, m_replies.front().data(), sizeof(status));
+		if (status == DATA)
+		{
+			m_replies[1][0] ^= 0x01;
+			m_corruptNextData = false;
+		}
+	}
+
+	if (m_dropNextReply)
+	{
+		m_replies.clear();
+		m_dropNextReply = false;
+	}
+}
+
+// Send the reply to the last command again
+void CPicEmulator::ReplayLastReply()
+{
+	++m_replays;
+	m_replies = m_lastReply;
+	m_dataPending = false;
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function carries out one command, and gives the kind of reply and any data words to send.
+ */
+CPicEmulator::EReply CPicEmulator::ExecuteCommand(const uint16_t* words, vector<uint16_t>& reply)
+{
+	switch (words[0])
+	{
+	// -- Grabber, motors and LED -- //
+	case OPEN_GRABBER:
+	case CLOSE_GRABBER:
+		m_grabber = words[0] == OPEN_GRABBER ? GRAB_OPEN : GRAB_CLOSE;
+		return EReply_Done;
+	case READ_GRABBER:
+		reply = { m_grabber };
+		return EReply_Data;
+	case WRITE_MOTOR_LEFT:
+	case WRITE_MOTOR_RIGHT:
+		m_motorSpeeds[words[0] == WRITE_MOTOR_LEFT ? 0 : 1] = words[2] == MOT_FWD ? words[1] : -words[1];
+		return EReply_Done;
+	case READ_MOTOR_LEFT:
+	case READ_MOTOR_RIGHT:
+		reply = { static_cast<uint16_t>(m_motorSpeeds[words[0] == READ_MOTOR_LEFT ? 0 : 1]) };
+		return EReply_Data;
+	case WRITE_LED:
+		m_led = words[1];
+		return EReply_Done;
+
+	// -- Sensors -- //
+	case READ_ECDR1:
+	case READ_ECDR1_SUM:
+	case READ_ECDR2:
+	case READ_ECDR2_SUM:
+	{
+		int16_t& encoder = m_encoders[words[0] <= READ_ECDR1_SUM ? 0 : 1];
+		reply = { static_cast<uint16_t>(encoder) };
+		if (words[1])
+			encoder = 0;
+		return EReply_Data;
+	}
+	case READ_COMP:
+		reply = { m_compass };
+		return EReply_Data;
+	case READ_PSNS1:
+	case READ_PSNS2:
+	case READ_PSNS3:
+	case READ_PSNS4:
+	case READ_PSNS5:
+	case READ_PSNS6:
+	case READ_PSNSFNT:
+	case READ_PSNSCBE:
+	{
+		// The samples read are discarded only when clear is set
+		unsigned int sensor = words[0] - READ_PSNS1;
+		const vector<uint16_t>& samples = m_photosensors[sensor];
+		unsigned int& position = m_photosensorPositions[sensor];
+
+		vector<uint16_t> buffer(words[1], 0);
+		for (unsigned int i = 0; i < buffer.size() && !samples.empty(); ++i)
+			buffer[i] = samples[(position + i) % samples.size()];
+		if (words[2] && !samples.empty())
+			position = (position + buffer.size()) % samples.size();
+
+		reply = buffer;
+		return EReply_Data;
+	}
+	case READ_SENSOR_FRAME:
+	{
+		uint32_t timestamp = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - m_startTime).count();
+		reply = { m_frameSequence++, static_cast<uint16_t>(timestamp >> 16), static_cast<uint16_t>(timestamp & 0xFFFF),
+				static_cast<uint16_t>(m_encoders[0]), static_cast<uint16_t>(m_encoders[1]), m_compass };
+		for (unsigned int sensor = 0; sensor < PHOTOSENSORS; ++sensor)
+		{
+			const vector<uint16_t>& samples = m_photosensors[sensor];
+			reply.push_back(samples.empty() ? 0 : samples[m_photosensorPositions[sensor] % samples.size()]);
+		}
+		if (words[1])
+			m_encoders[0] = m_encoders[1] = 0;
+		return EReply_Data;
+	}
+	case READ_DIP:
+		reply = { m_dip };
+		return EReply_Data;
+	case READ_ROOM:
+		reply = { static_cast<uint16_t>(m_roomType) };
+		return EReply_Data;
+
+	// -- Routes -- //
+	case WRITE_ROUTE:
+		m_payloadBytes = 2*words[1];
+		m_payloadChecksum = words[2];
+		m_payloadIsBatch = false;
+		if (m_payloadBytes == 0)
+		{
+			// There is no route transfer, so accept the empty route now
+			m_program.clear();
+			m_completed = 0;
+			m_executedMotions.clear();
+			m_routeStatus = ROUTE_COMPLETE;
+			return EReply_Done;
+		}
+		return EReply_None;
+	case READ_ROUTE_PROGRESS:
+		if (m_advanceOnProgressRead)
+			Tick();
+		reply = { static_cast<uint16_t>(m_routeStatus), static_cast<uint16_t>(m_completed) };
+		return EReply_Data;
+	case ABORT_ROUTE:
+		if (m_routeStatus == ROUTE_RUNNING)
+			m_routeStatus = ROUTE_ABORTED;
+		return EReply_Done;
+
+	// -- Motions -- //
+	case STOPPED:
+		m_motions.clear();
+		return EReply_None;
+	case FLUSH_MOTIONS:
+		m_motions.clear();
+		m_events.clear();
+		return EReply_Done;
+	default:
+		if (words[0] > STOPPED && words[0] <= PSNS_REV_RIGHT)
+		{
+			QueueMotion(words);
+			return EReply_None;
+		}
+		return EReply_Done;
+	}
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function carries out one command of a batch (8 bytes), adding any data it reads to the
+ * batch results. Batches, routes and motions cannot be nested in a batch, and are ignored.
+ */
+void CPicEmulator::RunBatchCommand(const unsigned char* data)
+{
+	uint16_t words[4];
+	ReadWords(data, words);
+	if (words[0] == BATCH || words[0] == WRITE_ROUTE || words[0] == FLUSH_MOTIONS
+			|| (words[0] >= STOPPED && words[0] <= PSNS_REV_RIGHT))
+		return;
+
+	vector<uint16_t> reply;
+	if (ExecuteCommand(words, reply) == EReply_Data)
+		m_batchResults.insert(m_batchResults.end(), reply.begin(), reply.end());
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function queues the reply to a whole batch: the results of all its reads, or DONE if none of
+ * its commands read anything.
+ */
+void CPicEmulator::QueueBatchReply()
+{
+	if (m_batchResults.empty())
+		QueueStatus(DONE);
+	else
+		QueueData(m_batchResults);
+	m_batchResults.clear();
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function reads the 4 words of a command (8 bytes, most significant byte first).
+ */
+void CPicEmulator::ReadWords(const unsigned char* data, uint16_t* words)
+{
+	for (int i = 0; i < 4; ++i)
+		words[i] = (data[2*i] << 8) | data[2*i + 1];
+}
+
+void CPicEmulator::QueueMotion(const uint16_t* words)
+{
+	// A full queue would overrun on the real PIC; the Pi must wait for a DONE first
+	if (m_motions.size() == PIC_MOTION_QUEUE_LENGTH)
+		return;
+
+	if (m_motions.empty())
+		m_motionPollsLeft = m_latency.m_motionPolls;
+
+	m_motions.push_back({ words[0], words[1], words[2], m_sequence });
+	m_maxMotionsQueued = max<unsigned int>(m_maxMotionsQueued, m_motions.size());
+}
+
+// Finish the motion being driven, and send its DONE
+void CPicEmulator::CompleteMotion()
+{
+	if (m_motions.empty())
+		return;
+
+	vector<uint16_t> motion = m_motions.front();
+	ApplyMotion(motion[0], motion[1] == DISTANCE ? motion[2] : 0);
+	m_motions.pop_front();
+
+	if (m_motions.empty())
+		++m_stops;
+	else
+		++m_blendedTransitions;
+	m_motionPollsLeft = m_latency.m_motionPolls;
+
+	// The DONE carries the sequence number of the motion's frame. For a stalled motion it is also the
+	// reply to that frame, should the Pi send the frame again.
+	uint16_t event[2] = { DONE, motion[3] };
+	vector<unsigned char> bytes(sizeof(event));
+	memcpy(bytes.data(), event, bytes.size());
+	m_events.push_back(bytes);
+	if (motion[3] == m_lastSequence && m_lastReply.empty())
+		m_lastReply.push_back(bytes);
+}
+
+// Record a motion as driven, and move the encoders and compass
+void CPicEmulator::ApplyMotion(uint16_t state, uint16_t counts)
+{
+	switch (state)
+	{
+	case OL_FORWARD:
+	case COMP_FORWARD:
+	case ECDR_FORWARD:
+	case PSNS_FORWARD:
+		m_executedMotions.push_back({ EMotion_Forward, CRouteProgram::DISTANCE_PER_COUNT*counts, state == ECDR_FORWARD });
+		m_encoders[0] += counts;
+		m_encoders[1] += counts;
+		break;
+	case OL_REVERSE:
+	case COMP_REVERSE:
+	case ECDR_REVERSE:
+	case PSNS_REVERSE:
+		m_encoders[0] -= counts;
+		m_encoders[1] -= counts;
+		break;
+	case OL_LEFT:
+	case COMP_LEFT:
+	case ECDR_LEFT:
+	case PSNS_LEFT:
+		m_executedMotions.push_back({ EMotion_TurnLeft90, 0, false });
+		m_compass = (m_compass + 270) % 360;
+		break;
+	case OL_RIGHT:
+	case COMP_RIGHT:
+	case ECDR_RIGHT:
+	case PSNS_RIGHT:
+		m_executedMotions.push_back({ EMotion_TurnRight90, 0, false });
+		m_compass = (m_compass + 90) % 360;
+		break;
+	default:
+		break;
+	}
+}
+
+// A data reply: DATA, the words followed by the sequence number and the CRC of both, then DONE
+void CPicEmulator::QueueData(const vector<uint16_t>& words)
+{
+	QueueStatus(DATA);
+
+	vector<uint16_t> payload = words;
+	payload.push_back(m_sequence);
+	payload.push_back(spi_crc16(reinterpret_cast<const uint8_t*>(payload.data()), 2*payload.size()));
+	QueueWords(payload);
+
+	QueueStatus(DONE);
+}
+
+// A word of the handshake, with the sequence number of the frame it answers
+void CPicEmulator::QueueStatus(uint16_t word)
+{
+	QueueWords({ word, m_sequence });
+}
+
+// Replies are in the Pi's byte order, since pi_spi.cpp reads them straight into uint16_t
+void CPicEmulator::QueueWords(const vector<uint16_t>& words)
+{
+	vector<unsigned char> bytes(2*words.size());
+	memcpy(bytes.data(), words.data(), bytes.size());
+	m_replies.push_back(bytes);
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function flips bits of a transfer at random, at the bit error rate. The gap to the next
+ * error is drawn once per error rather than testing every bit, and carries over between transfers.
+ */
+void CPicEmulator::InjectBitErrors(unsigned char* data, int len)
+{
+	if (m_bitErrorRate <= 0)
+		return;
+
+	uint64_t bits = 8*static_cast<uint64_t>(len);
+	uint64_t position = 0;
+	while (position + m_bitsToNextError < bits)
+	{
+		position += m_bitsToNextError;
+		data[position / 8] ^= 1 << (position % 8);
+		++m_bitErrors;
+		++position;
+		m_bitsToNextError = geometric_distribution<uint64_t>(m_bitErrorRate)(m_random);
+	}
+	m_bitsToNextError -= bits - position;
+}
@@ -0,0 +1,246 @@
+/*
+ * CPicEmulator.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CPICEMULATOR_H_
+#define SRC_CPICEMULATOR_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSPITransport.h"
+#include "EnumsHeader.h"
+#include "pic_enums.h"
+#include "Manouvre.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// How long the emulated PIC takes. Polls are reads by the Pi which get 'busy' (zeros) before the
+// answer is ready; times are real time spent in each SPI transfer.
+struct SPicLatency
+{
+	unsigned int m_replyPolls;		// Before the reply to each command
+	unsigned int m_motionPolls;		// Before each motion finishes (when the Pi is waiting for it)
+	double m_replyDelay;			// Real time before the reply to each command (microseconds)
+	double m_transferTime;			// Per transfer (microseconds)
+	double m_byteTime;				// Per byte transferred (microseconds), 8 at 1MHz
+
+	SPicLatency();
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to emulate the PIC end of the SPI link, so that the pi_spi functions can be built,
+ * tested and timed without the robot (loopback).
+ *
+ * It is an SPI transport: while attached, every SPI transfer made by pi_spi.cpp goes to the
+ * emulator instead of wiringPi. The emulator answers commands as the PIC does, with a DONE, or with
+ * DATA, the data words and a DONE:
+ *    - Reads (grabber, motors, encoders, compass, photosensors, DIP, room type) - Reply with the
+ *      emulator's registers, which the Set functions fill in.
+ *    - Writes (grabber, motors, LED) - Set the registers.
+ *    - WRITE_ROUTE - Reads the route words, checks the checksum, and replies DONE (the route starts)
+ *      or REJECT.
+ *    - READ_ROUTE_PROGRESS - Replies with the route status and the number of words completed.
+ *    - ABORT_ROUTE - Stops the route.
+ *    - A state (motion) - Queues the motion, up to PIC_MOTION_QUEUE_LENGTH. A DONE is sent as each
+ *      motion finishes; if the next is already queued the robot goes straight on to it without
+ *      stopping (a blended transition).
+ *    - STOPPED - Stops at once, discarding the queued motions.
+ *    - FLUSH_MOTIONS - As STOPPED, and discards the DONEs not yet read, then replies DONE.
+ *    - READ_SENSOR_FRAME - Replies with a frame of every sensor, numbered in sequence and stamped
+ *      with the time since the emulator was created.
+ *    - BATCH - Runs the commands of the batch in order (from the transfer after the header frame,
+ *      checking their CRC) and replies with DATA and all their data words, or DONE if none of them
+ *      read anything. Motions, routes and batches within a batch are ignored.
+ *
+ * Frames are checked as the PIC checks them: a frame (or batch) whose CRC is wrong is answered
+ * RESEND, and each reply carries the frame's sequence number, data replies with a CRC. A motion sent
+ * without stalling is answered QUEUED, and its DONE carries its frame's sequence number. The last
+ * reply is sent again when the Pi sends RESEND, or sends the same frame again.
+ *
+ * Motions move the encoders (forward and reverse moves by their distance) and the compass (90
+ * degrees per turn).
+ *
+ * Time does not pass on its own: a running route completes one word per Tick(), and (if enabled)
+ * one word each time its progress is read. Without a route, Tick() finishes the motion being
+ * driven, as does a read when there is no other reply to send (after the motion latency).
+ *
+ * Faults can be injected: a route or a data reply with a flipped bit, a reply which takes longer
+ * than usual, a reply which is lost, or bits flipped at random in every transfer both ways.
+ *
+ * The emulator can have a ready line, raised whenever a read would not be 'busy'. Waiting on it
+ * skips the reply and motion polls, since emulated time passes only when the Pi looks.
+ *
+ * Only one emulator can be attached at a time. It is detached when it is destroyed.
+ *
+ * Public Methods:
+ *    - Attach()/Detach() - Routes the SPI transfers to this emulator, or back to wiringPi.
+ *    - Transfer(...) - One SPI transfer (the CSPITransport interface).
+ *    - Tick() - Completes one word of the running route, or else the motion being driven.
+ *    - SetLatency(...) - How long the emulated PIC takes.
+ *    - SetAdvanceOnProgressRead(...) - Whether reading the progress also calls Tick().
+ *    - HasReadyLine()/WaitReady(timeout) - The ready line (the CSPITransport interface).
+ *    - CorruptNextRoute()/CorruptNextData()/StallNextReply(polls)/DropNextReply() - Inject faults.
+ *    - SetBitErrorRate(rate, seed) - Flips each bit transferred with the chance rate.
+ *    - SetReadyLine(...) - Whether the emulator has a ready line.
+ *    - SetRoomType/SetCompass/SetDip/SetPhotosensor - Set what the sensors read.
+ *    - GetRouteStatus()/GetCompleted()/GetExecutedMotions() - What the 'PIC' has done.
+ *    - GetQueuedMotions()/GetMaxMotionsQueued()/GetBlendedTransitions()/GetStops() - The motion
+ *    	queue, and how the motions finished so far ended.
+ *    - GetTransferCount()/GetBytesTransferred()/GetBusyReads() - Traffic on the link.
+ *    - GetBitErrors()/GetCorruptFrames()/GetReplays() - Bits flipped, frames answered RESEND, and
+ *    	replies sent again.
+ *
+ */
+class CPicEmulator : public CSPITransport
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CPicEmulator();
+	~CPicEmulator();
+	CPicEmulator(const CPicEmulator&) = delete;
+	CPicEmulator& operator=(const CPicEmulator&) = delete;
+
+	// === Public Functions =========================================================================
+	void Attach();
+	void Detach();
+	int Transfer(int channel, unsigned char* data, int len) override;
+	bool HasReadyLine() const override {return m_readyLine;}
+	bool WaitReady(uint32_t timeout_us) override;
+	void Tick();
+
+	// Fault injection
+	void CorruptNextRoute() {m_corruptNextRoute = true;}
+	void CorruptNextData() {m_corruptNextData = true;}
+	void StallNextReply(unsigned int polls) {m_stallPolls = polls;}
+	void DropNextReply() {m_dropNextReply = true;}
+	void SetBitErrorRate(double rate, unsigned int seed = 1);
+
+	// Access functions
+	void SetLatency(const SPicLatency& latency) {m_latency = latency;}
+	const SPicLatency& GetLatency() const {return m_latency;}
+	void SetAdvanceOnProgressRead(bool advance) {m_advanceOnProgressRead = advance;}
+	void SetReadyLine(bool readyLine) {m_readyLine = readyLine;}
+	void SetRoomType(ERoom roomType) {m_roomType = roomType;}
+	void SetCompass(uint16_t degrees) {m_compass = degrees % 360;}
+	void SetDip(uint16_t dip) {m_dip = dip;}
+	void SetPhotosensor(unsigned int sensor, const std::vector<uint16_t>& samples);
+	uint16_t GetGrabber() const {return m_grabber;}
+	int16_t GetMotorSpeed(bool left) const {return m_motorSpeeds[left ? 0 : 1];}
+	uint16_t GetLed() const {return m_led;}
+	route_status_t GetRouteStatus() const {return m_routeStatus;}
+	unsigned int GetCompleted() const {return m_completed;}
+	const std::vector<SMotion>& GetExecutedMotions() const {return m_executedMotions;}
+	unsigned int GetQueuedMotions() const {return m_motions.size();}
+	unsigned int GetMaxMotionsQueued() const {return m_maxMotionsQueued;}
+	unsigned int GetBlendedTransitions() const {return m_blendedTransitions;}
+	unsigned int GetStops() const {return m_stops;}
+	unsigned int GetTransferCount() const {return m_transferCount;}
+	unsigned long GetBytesTransferred() const {return m_bytesTransferred;}
+	unsigned int GetBusyReads() const {return m_busyReads;}
+	unsigned long GetBitErrors() const {return m_bitErrors;}
+	unsigned int GetCorruptFrames() const {return m_corruptFrames;}
+	unsigned int GetReplays() const {return m_replays;}
+
+	// === Constants ================================================================================
+	// Photosensors, in the order of their READ_ commands (READ_PSNS1 to READ_PSNSCBE)
+	static const unsigned int PHOTOSENSORS = 8;
+
+private:
+	// === Private Enums ============================================================================
+	// The reply to a command
+	enum EReply
+	{
+		EReply_None,	// Nothing yet (motions and routes reply later)
+		EReply_Done,	// DONE
+		EReply_Data		// DATA, the data words and DONE
+	};
+
+	// === Private Functions ========================================================================
+	void HandleTransfer(unsigned char* data, int len);
+	void HandleCommand(const unsigned char* data);
+	void FinishReply();
+	void ReplayLastReply();
+	EReply ExecuteCommand(const uint16_t* words, std::vector<uint16_t>& reply);
+	void RunBatchCommand(const unsigned char* data);
+	void QueueBatchReply();
+	static void ReadWords(const unsigned char* data, uint16_t* words);
+	void QueueMotion(const uint16_t* words);
+	void CompleteMotion();
+	void ApplyMotion(uint16_t state, uint16_t counts);
+	void QueueData(const std::vector<uint16_t>& words);
+	void QueueStatus(uint16_t word);
+	void QueueWords(const std::vector<uint16_t>& words);
+	void InjectBitErrors(unsigned char* data, int len);
+
+	// === Member Variables =========================================================================
+	SPicLatency m_latency;
+
+	// SPI state: the sequence number of the frame being answered and of the last one carried out (with
+	// its reply), bytes of route (or batch) still to come, the replies to the next reads, and the busy
+	// polls before the next reply
+	uint16_t m_sequence;
+	uint16_t m_lastSequence;
+	std::deque<std::vector<unsigned char> > m_lastReply;
+	bool m_dataPending;				// The next read is the data after a DATA
+	unsigned int m_payloadBytes;
+	uint16_t m_payloadChecksum;
+	bool m_payloadIsBatch;
+	unsigned int m_batchCommandsLeft;
+	std::vector<uint16_t> m_batchResults;
+	std::deque<std::vector<unsigned char> > m_replies;
+	unsigned int m_replyPollsLeft;
+	std::chrono::steady_clock::time_point m_replyReadyTime;
+	bool m_readyLine;
+	unsigned int m_transferCount;
+	unsigned long m_bytesTransferred;
+	unsigned int m_busyReads;
+
+	// Faults to inject
+	bool m_corruptNextRoute;
+	bool m_corruptNextData;
+	unsigned int m_stallPolls;
+	bool m_dropNextReply;
+	double m_bitErrorRate;
+	std::mt19937 m_random;
+	uint64_t m_bitsToNextError;
+	unsigned long m_bitErrors;
+	unsigned int m_corruptFrames;
+	unsigned int m_replays;
+
+	// Registers
+	uint16_t m_grabber;
+	int16_t m_motorSpeeds[2];
+	int16_t m_encoders[2];
+	uint16_t m_compass;
+	uint16_t m_led;
+	uint16_t m_dip;
+	ERoom m_roomType;
+	std::vector<std::vector<uint16_t> > m_photosensors;
+	std::vector<unsigned int> m_photosensorPositions;
+	uint16_t m_frameSequence;
+	std::chrono::steady_clock::time_point m_startTime;	// PIC time zero, for sensor frame timestamps
+
+	// Route state
+	std::vector<uint16_t> m_program;
+	route_status_t m_routeStatus;
+	unsigned int m_completed;
+	std::vector<SMotion> m_executedMotions;
+	bool m_advanceOnProgressRead;
+
+	// Motion queue: each is [state, termination, termination value, sequence number], the front being
+	// driven. The DONEs of finished motions are kept apart from m_replies, since they outlive the next
+	// command.
+	std::deque<std::vector<uint16_t> > m_motions;
+	std::deque<std::vector<unsigned char> > m_events;
+	unsigned int m_motionPollsLeft;
+	unsigned int m_maxMotionsQueued;
+	unsigned int m_blendedTransitions;
+	unsigned int m_stops;
+};
+
+#endif /* SRC_CPICEMULATOR_H_ */
@@ -0,0 +1,437 @@
+/*
+ * CPicEmulator_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include "pi_spi.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that the pi_spi functions work against the emulated PIC through the SPI transport, including
+// the DATA/DONE handshake of reads and sensor frames, that latencies and faults are injected as set, that the Pi
+// waits for slow replies without spinning, that corrupted and lost replies are sent again, and that every result
+// is still right when bits are flipped at random on the link, and that transactions are traced cheaply
+int CPicEmulator_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CPicEmulator_test--\n\n";
+
+	int result = 0;
+
+	CPicEmulator pic;
+	pic.Attach();
+	if (get_spi_transport() != &pic)
+	{
+		cout << "Emulator was not attached as the SPI transport\n";
+		result = 1;
+	}
+
+	// -- Writes and reads -- //
+	pic_close_grabber();
+	if (pic_read_grabber() != GRAB_CLOSE || pic.GetGrabber() != GRAB_CLOSE)
+	{
+		cout << "Grabber was not closed\n";
+		result = 1;
+	}
+
+	pic_set_left_motor_speed(300, MOT_REV);
+	pic_set_right_motor_speed(200, MOT_FWD);
+	if (pic_read_left_motor_speed() != -300 || pic_read_right_motor_speed() != 200)
+	{
+		cout << "Motor speeds were not read back\n";
+		result = 1;
+	}
+
+	pic.SetRoomType(ERoom_NorthEastWest);
+	if (pic_read_roomtype() != ERoom_NorthEastWest)
+	{
+		cout << "Room type was not read\n";
+		result = 1;
+	}
+
+	// Photosensor samples are only used up when cleared
+	pic.SetPhotosensor(0, { 1, 2, 3 });
+	uint16_t samples[4];
+	pic_read_photosense1(samples, 4, 0);
+	pic_read_photosense1(samples, 4, 1);
+	bool samplesCorrect = samples[0] == 1 && samples[1] == 2 && samples[2] == 3 && samples[3] == 1;
+	pic_read_photosense1(samples, 4, 1);
+	samplesCorrect = samplesCorrect && samples[0] == 2 && samples[3] == 2;
+
+	pic.SetPhotosensor(2, { 512 });
+	float level3;
+	pic_read_photosense3(&level3, 1, 1);
+	if (!samplesCorrect || level3 != 0.5)
+	{
+		cout << "Photosensors were not read\n";
+		result = 1;
+	}
+
+	// Levels are scaled the same by the vectorised conversion as by dividing, and long reads work
+	vector<uint16_t> ramp(1027);
+	for (unsigned int i = 0; i < ramp.size(); ++i)
+		ramp[i] = i % 1024;
+	pic.SetPhotosensor(3, ramp);
+	vector<float> levels(ramp.size());
+	pic_read_photosense4(levels.data(), levels.size(), 0);
+	bool levelsCorrect = true;
+	for (unsigned int i = 0; i < ramp.size(); ++i)
+		levelsCorrect = levelsCorrect && levels[i] == static_cast<float>(ramp[i]) / 1024;
+	if (!levelsCorrect)
+	{
+		cout << "Photosensor levels were not scaled\n";
+		result = 1;
+	}
+
+	const unsigned int CONVERSIONS = 2000;
+	volatile float sink = 0;	// Keeps the conversions from being optimised away
+	chrono::steady_clock::time_point conversionStart = chrono::steady_clock::now();
+	for (unsigned int n = 0; n < CONVERSIONS; ++n)
+	{
+		for (unsigned int i = 0; i < ramp.size(); ++i)
+			levels[i] = static_cast<float>(ramp[i]) / 1024;
+		sink = sink + levels[n % levels.size()];
+	}
+	double scalarTime = chrono::duration<double, micro>(chrono::steady_clock::now() - conversionStart).count();
+	conversionStart = chrono::steady_clock::now();
+	for (unsigned int n = 0; n < CONVERSIONS; ++n)
+	{
+		photosense_to_levels(ramp.data(), levels.data(), ramp.size());
+		sink = sink + levels[n % levels.size()];
+	}
+	double vectorTime = chrono::duration<double, micro>(chrono::steady_clock::now() - conversionStart).count();
+	cout << "Scaling " << ramp.size() << " samples: " << 1000*scalarTime/CONVERSIONS << " ns dividing, "
+			<< 1000*vectorTime/CONVERSIONS << " ns with photosense_to_levels\n";
+
+	// -- Motions move the encoders and compass -- //
+	CGoodsOut::Forward(600, false);
+	CGoodsOut::TurnRight90();
+	int32_t left = pic_read_encoder_left(1);
+	int32_t right = pic_read_encoder_right(1);
+	if (left != 100 || right != 100 || pic_read_encoder_left(0) != 0 || pic_read_compass() != 90)
+	{
+		cout << "Encoders or compass did not follow the motions (encoders " << left << ", " << right << ")\n";
+		result = 1;
+	}
+
+	// -- Sensor frames -- //
+	CGoodsOut::Forward(300, false);
+	unsigned int frameTransfers = pic.GetTransferCount();
+	sensor_frame_t frame;
+	pic_read_sensor_frame(&frame, 0);
+	frameTransfers = pic.GetTransferCount() - frameTransfers;
+
+	unsigned int sensorTransfers = pic.GetTransferCount();
+	uint16_t sample;
+	float level;
+	pic_read_encoder_left(0);
+	pic_read_encoder_right(0);
+	pic_read_compass();
+	pic_read_photosense1(&sample, 1, 0);
+	pic_read_photosense2(&sample, 1, 0);
+	pic_read_photosense3(&level, 1, 0);
+	pic_read_photosense4(&level, 1, 0);
+	pic_read_photosense5(&level, 1, 0);
+	pic_read_photosense6(&level, 1, 0);
+	pic_read_photosensefront(&sample, 1, 0);
+	pic_read_photosensecube(&sample, 1, 0);
+	sensorTransfers = pic.GetTransferCount() - sensorTransfers;
+
+	sensor_frame_t nextFrame;
+	pic_read_sensor_frame(&nextFrame, 1);
+	if (frame.encoder_left != 50 || frame.encoder_right != 50 || frame.compass != 90 || frame.photosensors[0] != 3
+			|| frame.photosensors[2] != 512 || nextFrame.sequence != frame.sequence + 1
+			|| nextFrame.timestamp_us < frame.timestamp_us || pic_read_encoder_left(0) != 0)
+	{
+		cout << "Sensor frame was not read\n";
+		result = 1;
+	}
+	cout << "Sensor frame in " << frameTransfers << " transfers, " << sensorTransfers << " reading each sensor\n";
+
+	// -- Latencies -- //
+	SPicLatency latency;
+	latency.m_replyPolls = 5;
+	pic.SetLatency(latency);
+	unsigned int busyReads = pic.GetBusyReads();
+	pic_read_compass();
+	if (pic.GetBusyReads() != busyReads + 5)
+	{
+		cout << "Reply latency was not applied\n";
+		result = 1;
+	}
+
+	latency.m_replyPolls = 0;
+	latency.m_transferTime = 200;
+	pic.SetLatency(latency);
+	unsigned int transfers = pic.GetTransferCount();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	pic_read_compass();
+	double elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+	transfers = pic.GetTransferCount() - transfers;
+	if (elapsed < 200*transfers)
+	{
+		cout << "Transfer latency was not applied\n";
+		result = 1;
+	}
+	cout << "Compass read in " << transfers << " transfers, " << elapsed << " us at 200 us per transfer\n";
+	pic.SetLatency(SPicLatency());
+
+	// -- Faults -- //
+	// Corrupted data fails its CRC and is asked for again
+	reset_spi_latency_stats();
+	pic.CorruptNextData();
+	if (pic_read_compass() != 90 || pic_read_compass() != 90 || get_spi_latency_stats(READ_COMP).crc_errors != 1
+			|| get_spi_latency_stats(READ_COMP).retries != 1)
+	{
+		cout << "Corrupted data was not sent again\n";
+		result = 1;
+	}
+
+	busyReads = pic.GetBusyReads();
+	pic.StallNextReply(20);
+	pic_read_compass();
+	pic_read_compass();
+	if (pic.GetBusyReads() != busyReads + 20)
+	{
+		cout << "Reply was not stalled once\n";
+		result = 1;
+	}
+
+	// -- Waiting for slow replies -- //
+	spi_wait_policy_t defaultPolicy = get_spi_wait_policy();
+	reset_spi_latency_stats();
+	latency = SPicLatency();
+	latency.m_replyDelay = 20000;
+	pic.SetLatency(latency);
+
+	spi_wait_policy_t spinPolicy = defaultPolicy;
+	spinPolicy.spin_polls = UINT32_MAX;
+	set_spi_wait_policy(spinPolicy);
+	busyReads = pic.GetBusyReads();
+	pic_read_compass();
+	unsigned int spinReads = pic.GetBusyReads() - busyReads;
+
+	set_spi_wait_policy(defaultPolicy);
+	busyReads = pic.GetBusyReads();
+	pic_read_compass();
+	unsigned int adaptiveReads = pic.GetBusyReads() - busyReads;
+
+	pic.SetReadyLine(true);
+	spi_wait_policy_t readyPolicy = defaultPolicy;
+	readyPolicy.spin_polls = 0;
+	set_spi_wait_policy(readyPolicy);
+	busyReads = pic.GetBusyReads();
+	pic_read_compass();
+	unsigned int readyLineReads = pic.GetBusyReads() - busyReads;
+	pic.SetReadyLine(false);
+
+	spi_latency_stats_t stats = get_spi_latency_stats(READ_COMP);
+	if (adaptiveReads > defaultPolicy.spin_polls + 20 || readyLineReads > 2 || adaptiveReads >= spinReads
+			|| stats.count != 3 || stats.max_us < 20000)
+	{
+		cout << "Waits were not adaptive\n";
+		result = 1;
+	}
+	cout << "20 ms reply: " << spinReads << " busy reads spinning, " << adaptiveReads << " backing off, " << readyLineReads
+			<< " on the ready line (mean " << stats.total_us/stats.count << " us)\n";
+
+	// A lost reply is had again by sending the frame again, without carrying out the command twice
+	pic.SetLatency(SPicLatency());
+	spi_wait_policy_t shortPolicy = defaultPolicy;
+	shortPolicy.command_timeout_us = 5000;
+	set_spi_wait_policy(shortPolicy);
+	reset_spi_latency_stats();
+	unsigned int replays = pic.GetReplays();
+	pic.DropNextReply();
+	pic_set_left_motor_speed(200, MOT_FWD);
+	if (pic.GetMotorSpeed(true) != 200 || get_spi_latency_stats(WRITE_MOTOR_LEFT).retries != 1 || pic.GetReplays() != replays + 1)
+	{
+		cout << "Lost reply was not sent again\n";
+		result = 1;
+	}
+
+	// Without retries it times out rather than hanging
+	shortPolicy.max_retries = 0;
+	set_spi_wait_policy(shortPolicy);
+	pic.DropNextReply();
+	try
+	{
+		pic_read_compass();
+		cout << "Lost reply did not time out\n";
+		result = 1;
+	}
+	catch (Exception_SPITimeout& e)
+	{
+		if (e.mm_command != READ_COMP || e.mm_waited_us < 5000 || get_spi_latency_stats(READ_COMP).timeouts != 1)
+		{
+			cout << "Timeout was not reported\n";
+			result = 1;
+		}
+	}
+	if (pic_read_compass() != 90)
+	{
+		cout << "Link did not recover after a timeout\n";
+		result = 1;
+	}
+
+	// -- Random bit errors -- //
+	// One bit in a thousand flipped each way: most transactions see no error, and the rest are retried
+	spi_wait_policy_t noisyPolicy = defaultPolicy;
+	noisyPolicy.command_timeout_us = 2000;
+	noisyPolicy.max_retries = 10;
+	set_spi_wait_policy(noisyPolicy);
+	reset_spi_latency_stats();
+	pic.SetDip(5);
+	pic.SetPhotosensor(0, { 100 });
+	pic.SetBitErrorRate(1e-3, 7);
+
+	unsigned int wrong = 0;
+	unsigned int transactions = 0;
+	try
+	{
+		for (uint16_t i = 0; i < 500; ++i)
+		{
+			pic_set_left_motor_speed(i, MOT_FWD);
+			wrong += pic.GetMotorSpeed(true) != i;
+
+			wrong += pic_read_compass() != 90;
+
+			sensor_frame_t frame;
+			pic_read_sensor_frame(&frame, 0);
+			wrong += frame.compass != 90 || frame.photosensors[0] != 100;
+
+			const uint16_t commands[] = { WRITE_LED, static_cast<uint16_t>(i % 2 ? GREEN : OFF), 0, 0, READ_DIP, 1, 0, 0, READ_COMP, 1, 0, 0 };
+			uint16_t results[2] = { 0, 0 };
+			pic_write_batch(commands, 3, results, 2);
+			wrong += pic.GetLed() != (i % 2 ? GREEN : OFF) || results[0] != 0x0005 || results[1] != 90;
+
+			transactions += 4;
+		}
+	}
+	catch (Exception_SPITimeout& e)
+	{
+		cout << "Transaction gave up after " << e.mm_waited_us << " us\n";
+		++wrong;
+	}
+	pic.SetBitErrorRate(0);
+
+	unsigned int retries = get_spi_latency_stats(WRITE_MOTOR_LEFT).retries + get_spi_latency_stats(READ_COMP).retries
+			+ get_spi_latency_stats(READ_SENSOR_FRAME).retries + get_spi_latency_stats(BATCH).retries;
+	unsigned int crcErrors = get_spi_latency_stats(WRITE_MOTOR_LEFT).crc_errors + get_spi_latency_stats(READ_COMP).crc_errors
+			+ get_spi_latency_stats(READ_SENSOR_FRAME).crc_errors + get_spi_latency_stats(BATCH).crc_errors;
+	if (wrong != 0 || transactions != 2000 || pic.GetBitErrors() == 0 || retries == 0)
+	{
+		cout << "Bit errors got through (" << wrong << " wrong results)\n";
+		result = 1;
+	}
+	cout << transactions << " transactions with " << pic.GetBitErrors() << " bits flipped: " << retries << " retries, "
+			<< crcErrors << " CRC errors (" << pic.GetCorruptFrames() << " frames the PIC could not read), "
+			<< wrong << " wrong results\n";
+	set_spi_wait_policy(defaultPolicy);
+
+	// -- Tracing -- //
+	spi_trace_enable(64);
+	for (int i = 0; i < 3; ++i)
+		pic_read_compass();
+	pic_set_left_motor_speed(100, MOT_FWD);
+
+	spi_trace_record_t records[64];
+	uint32_t traced = spi_trace_records(records, 64);
+	if (traced != 4 || records[0].command != READ_COMP || records[3].command != WRITE_MOTOR_LEFT || records[0].bytes != 32
+			|| records[0].polls != 2 || records[1].sequence != static_cast<uint16_t>(records[0].sequence + 1)
+			|| records[1].start_ns < records[0].start_ns + records[0].duration_ns)
+	{
+		cout << "Transactions were not traced\n";
+		result = 1;
+	}
+
+	// The ring keeps the newest
+	for (int i = 0; i < 100; ++i)
+		pic_read_compass();
+	traced = spi_trace_records(records, 64);
+	bool newest = traced == 64 && spi_trace_count() == 104;
+	for (uint32_t i = 1; i < traced; ++i)
+		newest = newest && records[i].sequence == static_cast<uint16_t>(records[i - 1].sequence + 1);
+	spi_latency_histogram_t histogram = get_spi_latency_histogram(READ_COMP);
+	uint64_t median = spi_histogram_percentile(histogram, 50);
+	uint64_t tail = spi_histogram_percentile(histogram, 99);
+	if (!newest || histogram.count != 103 || median < histogram.min_ns || tail < median || tail > histogram.max_ns)
+	{
+		cout << "Trace ring or histogram was wrong\n";
+		result = 1;
+	}
+	cout << "READ_COMP traced: p50 " << median << " ns, p99 " << tail << " ns, max " << histogram.max_ns << " ns\n";
+
+	// Dump, and read the file back
+	const char* tracePath = "TestData/CPicEmulator_test_trace.bin";
+	spi_trace_header_t header = spi_trace_header_t();
+	spi_trace_record_t last = spi_trace_record_t();
+	bool dumped = spi_trace_dump(tracePath);
+	FILE* file = fopen(tracePath, "rb");
+	if (file)
+	{
+		dumped = dumped && fread(&header, sizeof(header), 1, file) == 1 && fseek(file, 63*sizeof(last), SEEK_CUR) == 0
+				&& fread(&last, sizeof(last), 1, file) == 1;
+		fclose(file);
+	}
+	remove(tracePath);
+	if (!dumped || string(header.magic, 4) != "SPIT" || header.count != 64 || header.recorded != 104
+			|| header.record_size != sizeof(spi_trace_record_t) || last.sequence != records[63].sequence)
+	{
+		cout << "Trace was not dumped\n";
+		result = 1;
+	}
+
+	// Overhead: the same reads with tracing off and on, taking the quickest of several runs of each
+	double fastest[2] = { 1e9, 1e9 };
+	for (int run = 0; run < 10; ++run)
+	{
+		for (int traceOn = 0; traceOn < 2; ++traceOn)
+		{
+			if (traceOn)
+				spi_trace_enable(4096);
+			else
+				spi_trace_disable();
+
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			for (int i = 0; i < 1000; ++i)
+				pic_read_compass();
+			double perRead = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / 1000;
+			fastest[traceOn] = min(fastest[traceOn], perRead);
+		}
+	}
+	spi_trace_disable();
+	traced = spi_trace_count();
+	pic_read_compass();
+	if (spi_trace_count() != traced || fastest[1] - fastest[0] > 5000)
+	{
+		cout << "Tracing was not cheap, or could not be turned off\n";
+		result = 1;
+	}
+	cout << "Compass read " << fastest[0] << " ns untraced, " << fastest[1] << " ns traced\n";
+
+	pic.Detach();
+	if (get_spi_transport() == &pic)
+	{
+		cout << "Emulator was not detached\n";
+		result = 1;
+	}
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,194 @@
+/*
+ * CReplayTransport.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CReplayTransport.h"
+#include <cstring>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ STATICS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+atomic<CReplayTransport*> CReplayTransport::s_active { nullptr };
+
+// The padding of a frame is not set when it is read, so frames are compared field by field
+static bool SameFrame(const sensor_frame_t& a, const sensor_frame_t& b)
+{
+	return a.sequence == b.sequence && a.timestamp_us == b.timestamp_us && a.encoder_left == b.encoder_left
+			&& a.encoder_right == b.encoder_right && a.compass == b.compass
+			&& memcmp(a.photosensors, b.photosensors, sizeof(a.photosensors)) == 0;
+}
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function opens the log and sorts its records into the transfers and times, which are
+ * replayed, and the notes, which are checked.
+ */
+CReplayTransport::CReplayTransport(const string& path)
+		: m_next { 0 }, m_checked { 0, 0, 0 }, m_mismatches { 0 }, m_recordedTime { 0 }
+{
+	DEBUG_METHOD();
+
+	m_log.Open(path);
+
+	size_t offset = 0;
+	STelemetryEntry record;
+	while (m_log.Read(offset, record))
+	{
+		switch (record.m_type)
+		{
+		case ETelemetry_Transfer:
+		case ETelemetry_Clock:
+			m_link.push_back(record);
+			break;
+		case ETelemetry_SensorFrame:
+			if (record.m_length == sizeof(sensor_frame_t))
+			{
+				m_sensorFrames.emplace_back();
+				memcpy(&m_sensorFrames.back(), record.m_data, sizeof(sensor_frame_t));
+			}
+			break;
+		case ETelemetry_CameraFrame:
+			m_cameraFrames.emplace_back(reinterpret_cast<const char*>(record.m_data), record.m_length);
+			break;
+		case ETelemetry_Decision:
+			m_decisions.emplace_back(reinterpret_cast<const char*>(record.m_data), record.m_length);
+			break;
+		case ETelemetry_Motion:
+			// Motion times come from the real clock, so they are neither replayed nor checked
+			break;
+		}
+		m_recordedTime = record.m_time/1e9;
+	}
+	DEBUG_VALUE_OF(m_link.size());
+}
+
+CReplayTransport::~CReplayTransport()
+{
+	DEBUG_METHOD();
+
+	Detach();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CReplayTransport::Attach()
+{
+	DEBUG_METHOD();
+
+	set_spi_transport(this);
+	s_active = this;
+}
+
+void CReplayTransport::Detach()
+{
+	DEBUG_METHOD();
+
+	CReplayTransport* self = this;
+	s_active.compare_exchange_strong(self, nullptr);
+	if (get_spi_transport() == this)
+		set_spi_transport(nullptr);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function checks a note against the next one of its type in the recording. A note past the
+ * last one recorded is a mismatch.
+ */
+bool CReplayTransport::Check(ETelemetry type, const void* data, uint32_t length)
+{
+	CReplayTransport* replay = s_active.load(memory_order_acquire);
+	if (!replay)
+		return false;
+
+	lock_guard<mutex> lock { replay->m_checkMutex };
+	bool same = false;
+	switch (type)
+	{
+	case ETelemetry_SensorFrame:
+	{
+		size_t& checked = replay->m_checked[0];
+		same = checked < replay->m_sensorFrames.size() && length == sizeof(sensor_frame_t)
+				&& SameFrame(replay->m_sensorFrames[checked], *static_cast<const sensor_frame_t*>(data));
+		++checked;
+		break;
+	}
+	case ETelemetry_CameraFrame:
+	{
+		size_t& checked = replay->m_checked[1];
+		same = checked < replay->m_cameraFrames.size()
+				&& replay->m_cameraFrames[checked] == string(static_cast<const char*>(data), length);
+		++checked;
+		break;
+	}
+	case ETelemetry_Decision:
+	{
+		size_t& checked = replay->m_checked[2];
+		same = checked < replay->m_decisions.size()
+				&& replay->m_decisions[checked] == string(static_cast<const char*>(data), length);
+		++checked;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (!same)
+		++replay->m_mismatches;
+	return true;
+}
+
+bool CReplayTransport::IsFinished() const
+{
+	return m_next == m_link.size();
+}
+
+unsigned int CReplayTransport::GetMismatches() const
+{
+	lock_guard<mutex> lock { m_checkMutex };
+	return m_mismatches;
+}
+
+
+// -/-/-/-/-/-/-/ CSPITransport /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function replays the next transfer. It throws Exception_ReplayDiverged if the program sends
+ * something other than it sent in the recording, as the replies recorded would then be wrong.
+ */
+int CReplayTransport::Transfer(int channel, unsigned char* data, int len)
+{
+	const STelemetryEntry& record = NextLinkRecord(ETelemetry_Transfer);
+
+	int32_t recordedChannel;
+	memcpy(&recordedChannel, record.m_data, 4);
+	if (record.m_length != static_cast<uint32_t>(4 + 2*len) || recordedChannel != channel
+			|| memcmp(record.m_data + 4, data, len) != 0)
+		throw Exception_ReplayDiverged { m_next - 1, ETelemetry_Transfer };
+
+	memcpy(data, record.m_data + 4 + len, len);
+	return len;
+}
+
+chrono::steady_clock::time_point CReplayTransport::Now()
+{
+	const STelemetryEntry& record = NextLinkRecord(ETelemetry_Clock);
+
+	int64_t nanoseconds;
+	memcpy(&nanoseconds, record.m_data, sizeof(nanoseconds));
+	return chrono::steady_clock::time_point { chrono::duration_cast<chrono::steady_clock::duration>(
+			chrono::nanoseconds(nanoseconds)) };
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+const STelemetryEntry& CReplayTransport::NextLinkRecord(ETelemetry wanted)
+{
+	if (m_next >= m_link.size() || m_link[m_next].m_type != wanted)
+		throw Exception_ReplayDiverged { m_next, wanted };
+
+	return m_link[m_next++];
+}
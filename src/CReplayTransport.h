@@ -0,0 +1,118 @@
+/*
+ * CReplayTransport.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CREPLAYTRANSPORT_H_
+#define SRC_CREPLAYTRANSPORT_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSPITransport.h"
+#include "CTelemetryLog.h"
+#include "pi_spi.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is an SPI transport which replays a run recorded by CTelemetryRecorder, so that pi_spi and
+ * the code above it (CGoodsOut, CChallenges...) can be run again off the robot, exactly as they ran
+ * on it, and faster.
+ *
+ * Each transfer checks that pi_spi sends what it sent in the recording, and gets back what the PIC
+ * replied. Each time pi_spi reads is the time it read in the recording, so timeouts and retries
+ * happen where they happened. The transport has a ready line which is always raised, so pi_spi
+ * never sleeps: a replay takes only as long as the code takes to run.
+ *
+ * The transfers and times are replayed in the order they were recorded. This is the order of the
+ * run if one thread drove the link; threads which shared the link (CSensorAcquisition,
+ * CMotionPoller) may take their turns in a different order, and the replay then diverges.
+ *
+ * The sensor frames, camera frames and decisions noted while replaying (see CTelemetryRecorder)
+ * are checked against those recorded; the ones which differ are counted as mismatches.
+ *
+ * Public Constructors:
+ *    - CReplayTransport(path) - Opens the log at path (see CTelemetryLog::Open).
+ *
+ * Public Methods:
+ *    - Attach()/Detach() - Routes the SPI transfers to the replay, or back to wiringPi. Detach is
+ *    	called by the destructor.
+ *    - IsReplaying() - Whether a replay is attached (so a run should not be recorded).
+ *    - IsFinished() - Whether every transfer and time recorded has been replayed.
+ *    - GetMismatches() - The notes which differed from the recording.
+ *    - GetSensorFrames/GetCameraFrames/GetDecisions() - What was noted in the recording.
+ *    - GetRecordedTime() - How long the recording took, in seconds.
+ *
+ */
+class CReplayTransport : public CSPITransport
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CReplayTransport(const std::string& path);
+	~CReplayTransport();
+
+	CReplayTransport(const CReplayTransport&) = delete;
+	CReplayTransport& operator=(const CReplayTransport&) = delete;
+
+	// === Public Functions =========================================================================
+	void Attach();
+	void Detach();
+
+	// Called by the CTelemetryRecorder Note functions. Returns false if nothing is being replayed.
+	static bool Check(ETelemetry type, const void* data, uint32_t length);
+	static bool IsReplaying() {return s_active.load() != nullptr;}
+
+	// Access functions
+	bool IsFinished() const;
+	unsigned int GetMismatches() const;
+	const std::vector<sensor_frame_t>& GetSensorFrames() const {return m_sensorFrames;}
+	const std::vector<std::string>& GetCameraFrames() const {return m_cameraFrames;}
+	const std::vector<std::string>& GetDecisions() const {return m_decisions;}
+	double GetRecordedTime() const {return m_recordedTime;}
+
+	// CSPITransport
+	int Transfer(int channel, unsigned char* data, int len) override;
+	bool HasReadyLine() const override {return true;}
+	bool WaitReady(uint32_t /*timeout_us*/) override {return true;}
+	std::chrono::steady_clock::time_point Now() override;
+
+	// === Exceptions ===============================================================================
+	// The program asked for something other than the recording has next
+	struct Exception_ReplayDiverged
+	{
+		uint64_t mm_record;			// Of the transfers and times; past the last if none are left
+		ETelemetry mm_wanted;
+		Exception_ReplayDiverged(uint64_t record, ETelemetry wanted)
+				: mm_record { record }, mm_wanted { wanted }
+		{
+		}
+	};
+
+private:
+	// === Private Functions ========================================================================
+	const STelemetryEntry& NextLinkRecord(ETelemetry wanted);
+
+	// === Member Variables =========================================================================
+	static std::atomic<CReplayTransport*> s_active;
+
+	CTelemetryLog m_log;
+
+	// The transfers and times, in order, and the next one to replay
+	std::vector<STelemetryEntry> m_link;
+	std::size_t m_next;
+
+	// What was noted, and how much of it has been checked
+	std::vector<sensor_frame_t> m_sensorFrames;
+	std::vector<std::string> m_cameraFrames;
+	std::vector<std::string> m_decisions;
+	std::size_t m_checked[3];
+	unsigned int m_mismatches;
+	mutable std::mutex m_checkMutex;
+
+	double m_recordedTime;
+};
+
+#endif /* SRC_CREPLAYTRANSPORT_H_ */
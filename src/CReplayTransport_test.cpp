@@ -0,0 +1,238 @@
+/*
+ * CReplayTransport_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CReplayTransport.h"
+#include "CTelemetryRecorder.h"
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include "pi_spi.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// A short run on the link: commands, a motion, a sensor frame, a lost reply which is sent again and
+// one which times out, and the notes of what was seen and decided. Faults are only injected when
+// there is an emulator, i.e. when recording.
+static vector<int> RunSession(CPicEmulator* pic)
+{
+	vector<int> results;
+
+	init_spi();
+	results.push_back(pic_read_compass());
+	pic_set_left_motor_speed(150, MOT_FWD);
+	CGoodsOut::Forward(300, false);
+	results.push_back(pic_read_encoder_left(1));
+
+	sensor_frame_t frame;
+	pic_read_sensor_frame(&frame, 0);
+	CTelemetryRecorder::NoteSensorFrame(frame);
+	results.push_back(frame.compass);
+	results.push_back(frame.sequence);
+
+	spi_wait_policy_t policy = get_spi_wait_policy();
+	policy.command_timeout_us = 5000;
+	set_spi_wait_policy(policy);
+	if (pic)
+		pic->DropNextReply();
+	results.push_back(pic_read_compass());
+
+	policy.max_retries = 0;
+	set_spi_wait_policy(policy);
+	if (pic)
+		pic->DropNextReply();
+	try
+	{
+		results.push_back(pic_read_compass());
+	}
+	catch (Exception_SPITimeout& e)
+	{
+		results.push_back(-1);
+	}
+
+	CTelemetryRecorder::NoteCameraFrame("TestData/Block3.jpg");
+	CTelemetryRecorder::NoteDecision("Block 3: room " + to_string(results[1]));
+	return results;
+}
+
+// Test that a run recorded against the PIC emulator replays with the emulator gone: the same
+// results, latencies and timeouts, the notes matched, faster than it ran; and that a program which
+// asks for something else is caught
+int CReplayTransport_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CReplayTransport_test--\n\n";
+
+	int result = 0;
+	const string path = "TestData/telemetry.log";
+	spi_wait_policy_t defaultPolicy = get_spi_wait_policy();
+
+	// -- Recording -- //
+	vector<int> recorded;
+	spi_latency_stats_t recordedStats;
+	double recordedTime;
+	uint64_t records;
+	{
+		CPicEmulator pic;
+		pic.Attach();
+		SPicLatency latency;
+		latency.m_replyDelay = 2000;
+		pic.SetLatency(latency);
+
+		// Small to start with, so the log has to grow
+		CTelemetryRecorder recorder(path, 4096);
+		recorder.Attach();
+
+		reset_spi_latency_stats();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		recorded = RunSession(&pic);
+		recordedTime = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		recordedStats = get_spi_latency_stats(READ_COMP);
+		records = recorder.GetRecords();
+
+		recorder.Detach();
+		pic.Detach();
+		set_spi_wait_policy(defaultPolicy);
+	}
+	cout << "Recorded " << records << " records in " << recordedTime << " us\n";
+
+	// -- Replaying -- //
+	try
+	{
+		CReplayTransport replay(path);
+		replay.Attach();
+
+		reset_spi_latency_stats();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		vector<int> replayed = RunSession(nullptr);
+		double replayTime = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		spi_latency_stats_t replayedStats = get_spi_latency_stats(READ_COMP);
+
+		if (replayed != recorded || recorded.back() != -1 || !replay.IsFinished())
+		{
+			cout << "Replay did not give the recorded results\n";
+			result = 1;
+		}
+		if (replayedStats.count != recordedStats.count || replayedStats.timeouts != 1 || replayedStats.retries != recordedStats.retries
+				|| replayedStats.total_us != recordedStats.total_us || replayedStats.max_us != recordedStats.max_us)
+		{
+			cout << "Replay did not give the recorded latencies\n";
+			result = 1;
+		}
+		if (replay.GetMismatches() != 0 || replay.GetSensorFrames().size() != 1 || replay.GetCameraFrames().size() != 1
+				|| replay.GetDecisions().size() != 1 || replay.GetDecisions()[0] != "Block 3: room " + to_string(recorded[1]))
+		{
+			cout << "Notes were not replayed\n";
+			result = 1;
+		}
+		if (replayTime >= recordedTime)
+		{
+			cout << "Replay was not faster than the recording\n";
+			result = 1;
+		}
+		cout << "Replayed in " << replayTime << " us, " << recordedTime/replayTime << " times as fast\n";
+
+		replay.Detach();
+		set_spi_wait_policy(defaultPolicy);
+	}
+	catch (CReplayTransport::Exception_ReplayDiverged& e)
+	{
+		cout << "Replay diverged at record " << e.mm_record << "\n";
+		result = 1;
+	}
+
+	// -- Diverging -- //
+	{
+		CReplayTransport replay(path);
+		replay.Attach();
+
+		init_spi();
+		try
+		{
+			pic_set_left_motor_speed(100, MOT_FWD);
+			cout << "Different command was replayed\n";
+			result = 1;
+		}
+		catch (CReplayTransport::Exception_ReplayDiverged& e)
+		{
+			if (e.mm_wanted != ETelemetry_Transfer)
+			{
+				cout << "Divergence was not reported\n";
+				result = 1;
+			}
+		}
+
+		CTelemetryRecorder::NoteDecision("Block 1: room 0");
+		if (replay.GetMismatches() != 1)
+		{
+			cout << "Different decision was not counted\n";
+			result = 1;
+		}
+		replay.Detach();
+	}
+
+	// -- A log which cannot grow -- //
+	// A file size limit stops the log growing part way through; the run goes on without it, and what
+	// was recorded before is kept. The limit is for the whole process, so this runs in a child.
+	pid_t child = fork();
+	if (child == 0)
+	{
+		signal(SIGXFSZ, SIG_IGN);
+		rlimit limit;
+		getrlimit(RLIMIT_FSIZE, &limit);
+		limit.rlim_cur = 16384;
+		setrlimit(RLIMIT_FSIZE, &limit);
+
+		CPicEmulator pic;
+		pic.Attach();
+		CTelemetryRecorder recorder(path, 4096);
+		recorder.Attach();
+		init_spi();
+		int compass = pic_read_compass();
+		unsigned int wrong = 0;
+		for (unsigned int i = 0; i < 500; ++i)
+			if (pic_read_compass() != compass)
+				++wrong;
+		_exit(wrong != 0 ? 1 : !recorder.HasFailed() ? 2 : 0);
+	}
+
+	int status = -1;
+	waitpid(child, &status, 0);
+	CTelemetryLog log;
+	try
+	{
+		log.Open(path);
+	}
+	catch (CTelemetryLog::Exception_TelemetryFile& e)
+	{
+	}
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || log.GetRecords() == 0)
+	{
+		cout << "Full log stopped the run or lost the recording\n";
+		result = 1;
+	}
+	cout << "Recording stopped at " << log.GetRecords() << " records when the log could not grow\n";
+	log.Close();
+
+	init_spi();
+	remove(path.c_str());
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,222 @@
+/*
+ * CRoutePlan.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CRoutePlan.h"
+#include "CGraph.h"
+#include "CMazeGeometry.h"
+#include "CRouteProgram.h"
+#include "CParseCSV.h"
+#include "Instructions.h"
+#include <stdexcept>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CRoutePlan::CRoutePlan()
+		: m_entranceVertex { -1 }, m_exitVertex { -1 }
+{
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function plans the route from the entrance to the exit of a map, and the next hop table.
+ *
+ * One run of Dijkstra from the exit gives both: the edges of the maze are the same both ways, so
+ * the tree of shortest routes to the exit is the tree of shortest routes from it.
+ */
+CRoutePlan CRoutePlan::Compile(const CMapSnapshot& map, const CCostModel& costModel)
+{
+	DEBUG_METHOD();
+
+	CRoutePlan plan;
+	plan.m_roomMap = map.GetRoomMap();
+
+	int room_height = map.GetRoomHeight();
+	int room_width = map.GetRoomWidth();
+	CMazeGeometry geometry { room_height, room_width };
+	plan.m_entranceVertex = geometry.RoomVertex((room_height - 1)*room_width, EOrientation_South);
+	plan.m_exitVertex = geometry.RoomVertex(room_width - 1, EOrientation_North);
+
+	vector<vector<double> > distanceMatrix = map.DistanceMatrix(costModel);
+	vector<int> labels(distanceMatrix.size());
+	for (unsigned int i = 0; i < labels.size(); ++i)
+		labels[i] = i;
+	CGraph graph { distanceMatrix, labels };
+
+	// -- Next hop table -- //
+	plan.m_nextHop.assign(distanceMatrix.size(), -1);
+	for (unsigned int vertex = 0; vertex < plan.m_nextHop.size(); ++vertex)
+		plan.m_nextHop[vertex] = graph.NextHop(vertex, plan.m_exitVertex);
+
+	// -- Route from the entrance -- //
+	plan.m_route = plan.RouteFrom(plan.m_entranceVertex);
+	if (plan.m_route.back() != plan.m_exitVertex)
+		throw Exception_NoRoute { plan.m_entranceVertex, plan.m_exitVertex };
+
+	plan.m_instructions = CInstructions(plan.m_route, geometry).GetInstructions();
+
+	// The move in from the entrance and out through the exit are joined onto the route, so that
+	// corridors at either end are driven without stopping
+	vector<SMotion> motions = { { EMotion_Forward, HALFROOMLENGTH, false } };
+	vector<SMotion> routeMotions = CManouvre::InstructionsToMotions(plan.m_instructions);
+	motions.insert(motions.end(), routeMotions.begin(), routeMotions.end());
+	motions.push_back({ EMotion_Forward, HALFROOMLENGTH, false });
+
+	plan.m_program = CRouteProgram::Encode(CManouvre::FuseMotions(motions));
+	plan.m_motions = CRouteProgram::Decode(plan.m_program);
+
+	return plan;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function loads a plan written by Write. The tables are checked against each other, so a
+ * file which was cut short or edited by hand is rejected rather than driven.
+ */
+CRoutePlan CRoutePlan::Read(const string& filepath)
+{
+	DEBUG_METHOD();
+
+	vector<vector<int> > rows;
+	try
+	{
+		rows = CParseCSV::ReadCSV_int(filepath);
+	}
+	catch (CParseCSV::Exception_CantOpenFile& e)
+	{
+		throw Exception_InvalidPlan { filepath, "can't open file" };
+	}
+	catch (logic_error& e)
+	{
+		throw Exception_InvalidPlan { filepath, "not a list of integers" };
+	}
+
+	// -- Header and room map -- //
+	if (rows.empty() || rows[0].size() != 5 || rows[0][0] != FORMAT_VERSION)
+		throw Exception_InvalidPlan { filepath, "bad header" };
+
+	CRoutePlan plan;
+	int room_height = rows[0][1];
+	int room_width = rows[0][2];
+	plan.m_entranceVertex = rows[0][3];
+	plan.m_exitVertex = rows[0][4];
+	if (room_height <= 0 || room_width <= 0 || rows.size() != 1 + room_height + 4u)
+		throw Exception_InvalidPlan { filepath, "wrong number of rows" };
+
+	for (int row = 0; row < room_height; ++row)
+	{
+		const vector<int>& rooms = rows[1 + row];
+		if (rooms.size() != (unsigned int) room_width)
+			throw Exception_InvalidPlan { filepath, "bad room map" };
+
+		plan.m_roomMap.push_back({});
+		for (int col = 0; col < room_width; ++col)
+		{
+			if (rooms[col] < ERoom_Empty || rooms[col] > ERoom_Unknown)
+				throw Exception_InvalidPlan { filepath, "bad room map" };
+			plan.m_roomMap.back().push_back(static_cast<ERoom>(rooms[col]));
+		}
+	}
+
+	// -- Tables, each prefixed with its length -- //
+	vector<vector<int> > tables;
+	for (unsigned int i = 1 + room_height; i < rows.size(); ++i)
+	{
+		if (rows[i].empty() || rows[i][0] < 0 || rows[i].size() != 1u + rows[i][0])
+			throw Exception_InvalidPlan { filepath, "bad table length" };
+		tables.push_back(vector<int>(rows[i].begin() + 1, rows[i].end()));
+	}
+
+	plan.m_route = tables[0];
+	for (unsigned int i = 0; i < tables[1].size(); ++i)
+	{
+		if (tables[1][i] < EInstruction_Stop || tables[1][i] >= EInstruction_LAST)
+			throw Exception_InvalidPlan { filepath, "bad instruction" };
+		plan.m_instructions.push_back(static_cast<EInstruction>(tables[1][i]));
+	}
+	for (unsigned int i = 0; i < tables[2].size(); ++i)
+	{
+		if (tables[2][i] < 0 || tables[2][i] > 0xFFFF)
+			throw Exception_InvalidPlan { filepath, "bad route program" };
+		plan.m_program.push_back(static_cast<uint16_t>(tables[2][i]));
+	}
+	plan.m_nextHop = tables[3];
+
+	// -- Consistency -- //
+	CMazeGeometry geometry { room_height, room_width };
+	if (plan.m_nextHop.size() < (unsigned int) geometry.GetVertexCount())
+		throw Exception_InvalidPlan { filepath, "next hop table too short" };
+
+	for (unsigned int i = 0; i < plan.m_nextHop.size(); ++i)
+	{
+		if (plan.m_nextHop[i] < -1 || plan.m_nextHop[i] >= (int) plan.m_nextHop.size())
+			throw Exception_InvalidPlan { filepath, "bad next hop" };
+	}
+	if (plan.m_route.empty() || plan.RouteFrom(plan.m_entranceVertex) != plan.m_route || plan.m_route.back() != plan.m_exitVertex)
+		throw Exception_InvalidPlan { filepath, "route does not follow the next hop table" };
+
+	try
+	{
+		plan.m_motions = CRouteProgram::Decode(plan.m_program);
+	}
+	catch (CRouteProgram::Exception_InvalidWord& e)
+	{
+		throw Exception_InvalidPlan { filepath, "bad route program" };
+	}
+
+	return plan;
+}
+
+void CRoutePlan::Write(const string& filepath) const
+{
+	DEBUG_METHOD();
+
+	int room_height = m_roomMap.size();
+	int room_width = room_height > 0 ? m_roomMap[0].size() : 0;
+
+	vector<vector<int> > rows = { { FORMAT_VERSION, room_height, room_width, m_entranceVertex, m_exitVertex } };
+	for (int row = 0; row < room_height; ++row)
+		rows.push_back(vector<int>(m_roomMap[row].begin(), m_roomMap[row].end()));
+
+	rows.push_back({ (int) m_route.size() });
+	rows.back().insert(rows.back().end(), m_route.begin(), m_route.end());
+	rows.push_back({ (int) m_instructions.size() });
+	rows.back().insert(rows.back().end(), m_instructions.begin(), m_instructions.end());
+	rows.push_back({ (int) m_program.size() });
+	rows.back().insert(rows.back().end(), m_program.begin(), m_program.end());
+	rows.push_back({ (int) m_nextHop.size() });
+	rows.back().insert(rows.back().end(), m_nextHop.begin(), m_nextHop.end());
+
+	CParseCSV::WriteCSV(rows, filepath);
+}
+
+// The next vertex on a shortest route from vertex to the exit, or -1 if there is none
+int CRoutePlan::NextHop(int vertex) const
+{
+	if (vertex < 0 || vertex >= (int) m_nextHop.size())
+		return -1;
+
+	return m_nextHop[vertex];
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function follows the next hop table from vertex, giving a shortest route to the exit as
+ * CGraph::ShortestDistance would. If the exit cannot be reached the route is just { vertex }.
+ */
+vector<int> CRoutePlan::RouteFrom(int vertex) const
+{
+	DEBUG_METHOD();
+
+	vector<int> route = { vertex };
+	while (route.size() <= m_nextHop.size() && NextHop(route.back()) != -1)
+		route.push_back(NextHop(route.back()));
+
+	return route;
+}
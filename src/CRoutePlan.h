@@ -0,0 +1,109 @@
+/*
+ * CRoutePlan.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CROUTEPLAN_H_
+#define SRC_CROUTEPLAN_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "CMapSnapshot.h"
+#include "CCostModel.h"
+#include "Manouvre.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to hold everything challenge three needs to drive from the entrance to the exit,
+ * worked out in advance (at the end of challenge two) so that nothing is planned once the robot
+ * has been told to start.
+ *
+ * A plan holds:
+ *    - The room map it was compiled from.
+ *    - The shortest route (vertices) from the entrance to the exit, and its instructions.
+ *    - The route program for the PIC (see CRouteProgram), including the moves in from the entrance
+ *      and out through the exit, with the forward moves joined up.
+ *    - A next hop table: for each vertex, the next vertex on a shortest route from it to the exit
+ *      (-1 for the exit and for vertices the exit cannot be reached from). If the robot is knocked
+ *      off the route, a new route to the exit is read from this without planning.
+ *
+ * Plans are written to file as CSV, one row per table (each but the header and room map prefixed
+ * with its length), and read back with Read. A file which does not hold a whole, valid plan is
+ * rejected, so the caller can fall back to compiling a plan from the map.
+ *
+ * Public Methods:
+ *    - Compile(map, costModel) - Plans the route and tables for a map.
+ *    - Read(filepath)/Write(filepath) - Loads and saves a plan.
+ *    - GetRoute/GetInstructions/GetProgram/GetMotions - The route from the entrance to the exit.
+ *    - NextHop(vertex)/RouteFrom(vertex) - Recovery routes to the exit from any vertex.
+ *
+ * Exceptions:
+ * 	- Exception_NoRoute - Thrown by Compile when the exit cannot be reached from the entrance.
+ * 	- Exception_InvalidPlan - Thrown by Read for a file which does not hold a valid plan.
+ *
+ */
+class CRoutePlan
+{
+public:
+	// === Public Functions =========================================================================
+	static CRoutePlan Compile(const CMapSnapshot& map, const CCostModel& costModel = CCostModel::Default());
+	static CRoutePlan Read(const std::string& filepath);
+	void Write(const std::string& filepath) const;
+
+	int NextHop(int vertex) const;
+	std::vector<int> RouteFrom(int vertex) const;
+
+	// Access functions
+	const std::vector<std::vector<ERoom> >& GetRoomMap() const {return m_roomMap;}
+	int GetEntranceVertex() const {return m_entranceVertex;}
+	int GetExitVertex() const {return m_exitVertex;}
+	const std::vector<int>& GetRoute() const {return m_route;}
+	const std::vector<EInstruction>& GetInstructions() const {return m_instructions;}
+	const std::vector<uint16_t>& GetProgram() const {return m_program;}
+	const std::vector<SMotion>& GetMotions() const {return m_motions;}
+
+	// === Exceptions ===============================================================================
+	struct Exception_NoRoute
+	{
+		int mm_entranceVertex;
+		int mm_exitVertex;
+		Exception_NoRoute(int entranceVertex, int exitVertex)
+				: mm_entranceVertex { entranceVertex }, mm_exitVertex { exitVertex }
+		{
+		}
+	};
+	struct Exception_InvalidPlan
+	{
+		std::string mm_filepath;
+		std::string mm_reason;
+		Exception_InvalidPlan(const std::string& filepath, const std::string& reason)
+				: mm_filepath { filepath }, mm_reason { reason }
+		{
+		}
+	};
+
+	// === Constants ================================================================================
+	static const int FORMAT_VERSION = 1;
+
+private:
+	// === Constructor and Destructors ==============================================================
+	CRoutePlan();
+
+	// === Member Variables =========================================================================
+	std::vector<std::vector<ERoom> > m_roomMap;
+	int m_entranceVertex;
+	int m_exitVertex;
+	std::vector<int> m_route;
+	std::vector<EInstruction> m_instructions;
+	std::vector<uint16_t> m_program;
+	std::vector<int> m_nextHop;
+
+	// The motions of m_program, decoded when the plan is made so that they are ready for driving
+	// one at a time if the PIC will not take the route
+	std::vector<SMotion> m_motions;
+};
+
+#endif /* SRC_CROUTEPLAN_H_ */
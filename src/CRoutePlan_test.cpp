@@ -0,0 +1,118 @@
+/*
+ * CRoutePlan_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CRoutePlan.h"
+#include "CMazeGenerator.h"
+#include "CMapSnapshot.h"
+#include "CGraph.h"
+#include "CRouteProgram.h"
+#include <fstream>
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that a route plan gives a shortest route from the entrance to the exit, that its next hop
+// table gives shortest routes from everywhere else, and that it is the same after being written to
+// file and read back
+int CRoutePlan_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CRoutePlan_test--\n\n";
+
+	int result = 0;
+
+	CMapSnapshot map { CMazeGenerator::Generate(10, 10, 7, 0.5), {} };
+	CRoutePlan plan = CRoutePlan::Compile(map);
+
+	// -- The route is a shortest route -- //
+	vector<vector<double> > distanceMatrix = map.DistanceMatrix();
+	vector<int> labels(distanceMatrix.size());
+	for (unsigned int i = 0; i < labels.size(); ++i)
+		labels[i] = i;
+	CGraph graph { distanceMatrix, labels };
+
+	vector<int> shortestRoute;
+	graph.ShortestDistance(plan.GetEntranceVertex(), plan.GetExitVertex(), shortestRoute);
+	if (plan.GetRoute().front() != plan.GetEntranceVertex() || plan.GetRoute().back() != plan.GetExitVertex()
+			|| plan.GetRoute().size() != shortestRoute.size())
+	{
+		cout << "Route is not a shortest route from the entrance to the exit\n";
+		result = 1;
+	}
+	if (plan.GetProgram() != CRouteProgram::Encode(plan.GetMotions()) || plan.GetInstructions().empty())
+	{
+		cout << "Route program does not match the route\n";
+		result = 1;
+	}
+	cout << "Route of " << plan.GetRoute().size() << " vertices, " << plan.GetInstructions().size() << " instructions, "
+			<< plan.GetProgram().size() << " route words\n";
+
+	// -- Recovery routes from every vertex -- //
+	unsigned int reachable = 0;
+	for (unsigned int vertex = 0; vertex < distanceMatrix.size(); ++vertex)
+	{
+		vector<int> route;
+		double distance = graph.ShortestDistance(vertex, plan.GetExitVertex(), route);
+		vector<int> recovery = plan.RouteFrom(vertex);
+
+		if (distance == -1)
+		{
+			if (recovery.size() != 1)
+				result = 1;
+			continue;
+		}
+
+		double recoveryDistance = 0;
+		for (unsigned int i = 1; i < recovery.size(); ++i)
+			recoveryDistance += distanceMatrix[recovery[i - 1]][recovery[i]];
+		if (recovery.back() != plan.GetExitVertex() || recoveryDistance != distance)
+		{
+			cout << "Recovery route from " << vertex << " is not a shortest route\n";
+			result = 1;
+		}
+		++reachable;
+	}
+	cout << reachable << " of " << distanceMatrix.size() << " vertices have a recovery route\n";
+
+	// -- Write and read back -- //
+	plan.Write("TestData/RoutePlan_test.txt");
+	CRoutePlan loaded = CRoutePlan::Read("TestData/RoutePlan_test.txt");
+	if (loaded.GetRoomMap() != plan.GetRoomMap() || loaded.GetRoute() != plan.GetRoute() || loaded.GetInstructions() != plan.GetInstructions()
+			|| loaded.GetProgram() != plan.GetProgram() || loaded.GetMotions().size() != plan.GetMotions().size()
+			|| loaded.RouteFrom(0) != plan.RouteFrom(0))
+	{
+		cout << "Plan changed when written and read back\n";
+		result = 1;
+	}
+
+	// A file cut short is rejected
+	{
+		ifstream file("TestData/RoutePlan_test.txt");
+		string line;
+		ofstream truncated("TestData/RoutePlan_test_truncated.txt");
+		for (int i = 0; i < 12 && getline(file, line); ++i)
+			truncated << line << '\n';
+	}
+	try
+	{
+		CRoutePlan::Read("TestData/RoutePlan_test_truncated.txt");
+		cout << "Truncated plan was not rejected\n";
+		result = 1;
+	}
+	catch (CRoutePlan::Exception_InvalidPlan& e)
+	{
+	}
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,96 @@
+/*
+ * CRouteProgram.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CRouteProgram.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function encodes a list of motions as a route program.
+ *
+ * When a forward move is split, only the last word watches for junctions: the sensors are there to
+ * stop the robot at the end of the move.
+ */
+vector<uint16_t> CRouteProgram::Encode(const vector<SMotion>& motions)
+{
+	DEBUG_METHOD();
+
+	vector<uint16_t> program;
+	program.reserve(motions.size());
+
+	for (unsigned int i = 0; i < motions.size(); ++i)
+	{
+		switch (motions[i].m_type)
+		{
+		case EMotion_Forward:
+		{
+			// Every word of a split move is driven the same way as the move
+			unsigned int counts = CGoodsOut::DistanceToCounts(motions[i].m_distance);
+			route_op_t op = motions[i].m_watchSensors ? ROUTE_FORWARD_WATCH : ROUTE_FORWARD;
+			while (counts > MAX_COUNTS)
+			{
+				program.push_back((op << 12) | MAX_COUNTS);
+				counts -= MAX_COUNTS;
+			}
+			program.push_back((op << 12) | counts);
+			break;
+		}
+		case EMotion_TurnLeft90:
+			program.push_back(ROUTE_LEFT << 12);
+			break;
+		case EMotion_TurnRight90:
+			program.push_back(ROUTE_RIGHT << 12);
+			break;
+		}
+	}
+
+	return program;
+}
+
+vector<uint16_t> CRouteProgram::FromInstructions(const vector<EInstruction>& instructions)
+{
+	DEBUG_METHOD();
+
+	return Encode(CManouvre::FuseMotions(CManouvre::InstructionsToMotions(instructions)));
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function decodes a route program back into motions, one motion per word (split forward
+ * moves are not joined back up).
+ */
+vector<SMotion> CRouteProgram::Decode(const vector<uint16_t>& program)
+{
+	DEBUG_METHOD();
+
+	vector<SMotion> motions;
+	motions.reserve(program.size());
+
+	for (unsigned int i = 0; i < program.size(); ++i)
+	{
+		switch (Opcode(program[i]))
+		{
+		case ROUTE_FORWARD:
+			motions.push_back({ EMotion_Forward, Argument(program[i])*DISTANCE_PER_COUNT, false });
+			break;
+		case ROUTE_FORWARD_WATCH:
+			motions.push_back({ EMotion_Forward, Argument(program[i])*DISTANCE_PER_COUNT, true });
+			break;
+		case ROUTE_LEFT:
+			motions.push_back({ EMotion_TurnLeft90, 0, false });
+			break;
+		case ROUTE_RIGHT:
+			motions.push_back({ EMotion_TurnRight90, 0, false });
+			break;
+		default:
+			throw Exception_InvalidWord { program[i] };
+		}
+	}
+
+	return motions;
+}
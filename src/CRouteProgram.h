@@ -0,0 +1,63 @@
+/*
+ * CRouteProgram.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CROUTEPROGRAM_H_
+#define SRC_CROUTEPROGRAM_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "EnumsHeader.h"
+#include "GoodsOut.h"
+#include "Manouvre.h"
+#include "pic_enums.h"
+#include <cstdint>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to convert motion commands to and from route programs, which are sent to the PIC
+ * in one transfer (WRITE_ROUTE) and then driven by the PIC without waiting for the Pi.
+ *
+ * Each motion is one 16 bit word: a route_op_t in the top 4 bits and, for forward moves, the
+ * distance in encoder counts in the bottom 12 bits. Forward moves longer than the largest count
+ * are split over several words, each driven the same way as the move.
+ *
+ * Public Methods:
+ *    - Encode(motions) - The route program for a list of motions.
+ *    - FromInstructions(instructions) - The route program for a list of instructions, with the
+ *    	forward moves joined up as CManouvre::FuseMotions.
+ *    - Decode(program) - The motions of a route program (forward distances are rounded to whole
+ *    	encoder counts).
+ *
+ * Exceptions:
+ * 	- Exception_InvalidWord - Thrown by Decode for a word with an unknown opcode.
+ *
+ */
+class CRouteProgram
+{
+public:
+	// === Constants ================================================================================
+	static constexpr double DISTANCE_PER_COUNT = CGoodsOut::DISTANCE_PER_COUNT;
+	static constexpr uint16_t MAX_COUNTS = 0x0FFF;
+
+	// === Public Functions =========================================================================
+	static std::vector<uint16_t> Encode(const std::vector<SMotion>& motions);
+	static std::vector<uint16_t> FromInstructions(const std::vector<EInstruction>& instructions);
+	static std::vector<SMotion> Decode(const std::vector<uint16_t>& program);
+
+	static route_op_t Opcode(uint16_t word) {return static_cast<route_op_t>(word >> 12);}
+	static uint16_t Argument(uint16_t word) {return word & MAX_COUNTS;}
+
+	// === Exceptions ===============================================================================
+	struct Exception_InvalidWord
+	{
+		uint16_t mm_word;
+		explicit Exception_InvalidWord(uint16_t word)
+				: mm_word { word }
+		{
+		}
+	};
+};
+
+#endif /* SRC_CROUTEPROGRAM_H_ */
@@ -0,0 +1,147 @@
+/*
+ * CRouteProgram_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CRouteProgram.h"
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include "pi_spi.h"
+#include <iostream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that route programs encode and decode motions, and that they are sent to, driven by and
+// aborted on a (loopback) emulated PIC
+int CRouteProgram_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CRouteProgram_test--\n\n";
+
+	int result = 0;
+
+	// -- Encoding -- //
+	vector<SMotion> motions = {
+			{ EMotion_Forward, 600, false },
+			{ EMotion_Forward, 300, true },
+			{ EMotion_TurnLeft90, 0, false },
+			{ EMotion_Forward, 900, false },
+			{ EMotion_TurnRight90, 0, false },
+			{ EMotion_Forward, 1200, true } };
+	vector<uint16_t> program = CRouteProgram::Encode(motions);
+	if (program.size() != motions.size() || CRouteProgram::Decode(program) != motions)
+	{
+		cout << "Motions changed when encoded and decoded\n";
+		result = 1;
+	}
+
+	// A move too long for one word is split, each word driven the same way as the move
+	for (bool watch : { false, true })
+	{
+		vector<uint16_t> longProgram = CRouteProgram::Encode({ { EMotion_Forward, 6*(CRouteProgram::MAX_COUNTS + 10), watch } });
+		route_op_t op = watch ? ROUTE_FORWARD_WATCH : ROUTE_FORWARD;
+		if (longProgram.size() != 2 || CRouteProgram::Opcode(longProgram[0]) != op || CRouteProgram::Opcode(longProgram[1]) != op
+				|| CRouteProgram::Argument(longProgram[1]) != 10)
+		{
+			cout << "Long move was not split correctly\n";
+			result = 1;
+		}
+	}
+
+	// The modes of a fused route survive encoding: the corridor follows the line and only the
+	// approach to the turn watches the encoders
+	// (distances come back rounded to whole counts, so only the kinds and modes are compared)
+	vector<SMotion> fused = CManouvre::FuseMotions(CManouvre::InstructionsToMotions(
+			{ EInstruction_Straight, EInstruction_Straight, EInstruction_TurnRight, EInstruction_Straight }));
+	vector<SMotion> decoded = CRouteProgram::Decode(CRouteProgram::FromInstructions(
+			{ EInstruction_Straight, EInstruction_Straight, EInstruction_TurnRight, EInstruction_Straight }));
+	bool sameModes = decoded.size() == fused.size();
+	for (size_t i = 0; sameModes && i < fused.size(); i++)
+	{
+		sameModes = decoded[i].m_type == fused[i].m_type && decoded[i].m_watchSensors == fused[i].m_watchSensors;
+	}
+	if (!sameModes)
+	{
+		cout << "Fused route changed mode when encoded and decoded\n";
+		result = 1;
+	}
+
+	// Instructions give one word per fused motion: the straights, the approach to the turn, the turn
+	// and the straight out of it
+	vector<EInstruction> instructions = { EInstruction_Straight, EInstruction_Straight, EInstruction_TurnRight, EInstruction_Straight };
+	if (CRouteProgram::FromInstructions(instructions).size() != 4)
+	{
+		cout << "Route program from instructions has the wrong length\n";
+		result = 1;
+	}
+
+	// -- Driving a route on the emulated PIC -- //
+	CPicEmulator pic;
+	pic.Attach();
+
+	vector<unsigned int> progressReports;
+	bool rightTotal = true;
+	route_status_t status = CGoodsOut::RunRoute(program, [&](unsigned int completed, unsigned int total) {
+		progressReports.push_back(completed);
+		rightTotal = rightTotal && total == program.size();
+		return true;
+	}, 0);
+	if (status != ROUTE_COMPLETE || pic.GetExecutedMotions() != motions)
+	{
+		cout << "Route was not driven (status " << status << ")\n";
+		result = 1;
+	}
+	for (unsigned int i = 1; i < progressReports.size(); ++i)
+	{
+		if (progressReports[i] < progressReports[i - 1])
+			result = 1;
+	}
+	if (progressReports.empty() || progressReports.back() != program.size() || !rightTotal)
+	{
+		cout << "Progress was not reported up to the end of the route\n";
+		result = 1;
+	}
+	cout << "Route of " << program.size() << " words driven with " << pic.GetTransferCount() << " SPI transfers, "
+			<< progressReports.size() << " progress reports\n";
+
+	// Abort part way through
+	status = CGoodsOut::RunRoute(program, [&](unsigned int completed, unsigned int /*total*/) {
+		return completed < 2;
+	}, 0);
+	if (status != ROUTE_ABORTED || pic.GetCompleted() != 2)
+	{
+		cout << "Route was not aborted after two words (status " << status << ", completed " << pic.GetCompleted() << ")\n";
+		result = 1;
+	}
+
+	// A route corrupted on the way is rejected and not driven
+	pic.CorruptNextRoute();
+	if (CGoodsOut::RunRoute(program, nullptr, 0) != ROUTE_REJECTED || !pic.GetExecutedMotions().empty())
+	{
+		cout << "Corrupted route was not rejected\n";
+		result = 1;
+	}
+
+	// A distance between two counts is driven the same distance as a command and in a route
+	CGoodsOut::Forward(604, false);
+	vector<SMotion> routed = CRouteProgram::Decode(CRouteProgram::Encode({ { EMotion_Forward, 604, false } }));
+	if (pic.GetExecutedMotions().empty() || pic.GetExecutedMotions().back().m_distance != routed[0].m_distance
+			|| routed[0].m_distance != 606)
+	{
+		cout << "Commands and routes convert distances to counts differently\n";
+		result = 1;
+	}
+
+	pic.Detach();
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
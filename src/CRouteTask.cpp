@@ -0,0 +1,55 @@
+/*
+ * CRouteTask.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CRouteTask.h"
+#include "pi_spi.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CRouteTask::CRouteTask(const vector<uint16_t>& program, chrono::steady_clock::duration pollInterval)
+		: CTask { "Route" }, m_program { program }, m_pollInterval { pollInterval }, m_uploaded { false },
+		  m_abortRequested { false }, m_status { ROUTE_IDLE }, m_completed { 0 }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function uploads the program on the first resume, and reads the progress on each resume
+ * after that.
+ */
+SAwait CRouteTask::Resume(CTaskLoop& loop)
+{
+	DEBUG_METHOD();
+
+	if (!m_uploaded)
+	{
+		m_uploaded = true;
+		if (!pic_write_route(m_program.data(), static_cast<uint16_t>(m_program.size())))
+		{
+			m_status = ROUTE_REJECTED;
+			return SAwait::Done();
+		}
+		m_status = ROUTE_RUNNING;
+		return loop.Sleep(m_pollInterval);
+	}
+
+	if (m_abortRequested)
+		pic_abort_route();
+
+	m_status = pic_read_route_progress(&m_completed);
+	DEBUG_VALUE_OF(m_completed);
+
+	if (m_status == ROUTE_RUNNING)
+		return loop.Sleep(m_pollInterval);
+
+	return SAwait::Done();
+}
@@ -0,0 +1,62 @@
+/*
+ * CRouteTask.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CROUTETASK_H_
+#define SRC_CROUTETASK_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CTaskLoop.h"
+#include "pic_enums.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a task which drives a route program (see CRouteProgram) on the PIC without blocking, as
+ * CGoodsOut::RunRoute does but on a CTaskLoop.
+ *
+ * The first resume uploads the program. Every resume after that reads the progress once (a single
+ * SPI transfer) and sleeps for the poll interval, so other tasks run while the robot drives. The
+ * task finishes when the route is no longer running. Other tasks can wait for it with
+ * SAwait::Condition on IsDone.
+ *
+ * Public Constructors:
+ *    - CRouteTask(program, pollInterval) - A task to drive the program, reading the progress every
+ *    	pollInterval.
+ *
+ * Public Methods:
+ *    - Abort() - Stops the robot at the next resume.
+ *    - GetStatus() - ROUTE_IDLE before the upload, then as pic_read_route_progress.
+ *    - GetCompleted()/GetLength() - Route words completed, and the length of the program.
+ *
+ */
+class CRouteTask : public CTask
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CRouteTask(const std::vector<uint16_t>& program,
+			std::chrono::steady_clock::duration pollInterval = std::chrono::milliseconds(10));
+
+	// === Public Functions =========================================================================
+	SAwait Resume(CTaskLoop& loop) override;
+	void Abort() {m_abortRequested = true;}
+
+	// Access functions
+	route_status_t GetStatus() const {return m_status;}
+	unsigned int GetCompleted() const {return m_completed;}
+	unsigned int GetLength() const {return m_program.size();}
+
+private:
+	// === Member Variables =========================================================================
+	std::vector<uint16_t> m_program;
+	std::chrono::steady_clock::duration m_pollInterval;
+	bool m_uploaded;
+	bool m_abortRequested;
+	route_status_t m_status;
+	uint16_t m_completed;
+};
+
+#endif /* SRC_CROUTETASK_H_ */
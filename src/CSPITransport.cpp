@@ -0,0 +1,32 @@
+/*
+ * CSPITransport.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSPITransport.h"
+#include "wiringPiSPI.h"
+
+/* For reference:
+    int wiringPiSPISetup (int channel, int speed) ;
+    int wiringPiSPIDataRW (int channel, unsigned char *data, int len) ;
+*/
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CWiringPiTransport& CWiringPiTransport::Instance()
+{
+	static CWiringPiTransport transport;
+	return transport;
+}
+
+void CWiringPiTransport::Setup(int channel, int speed, int mode)
+{
+	wiringPiSPISetupMode(channel, speed, mode);
+}
+
+int CWiringPiTransport::Transfer(int channel, unsigned char* data, int len)
+{
+	return wiringPiSPIDataRW(channel, data, len);
+}
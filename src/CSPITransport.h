@@ -0,0 +1,73 @@
+/*
+ * CSPITransport.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CSPITRANSPORT_H_
+#define SRC_CSPITRANSPORT_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include <chrono>
+#include <cstdint>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is an interface for the link the pi_spi functions talk to the PIC over.
+ *
+ * Every SPI transfer made by pi_spi.cpp goes through the transport set with set_spi_transport.
+ * On the robot this is CWiringPiTransport; off the robot it can be a PIC emulator (CPicEmulator),
+ * so that the whole I/O path can be built, tested and timed on any machine.
+ *
+ * SPI is full duplex: Transfer sends the len bytes of data and overwrites them with the bytes
+ * received.
+ *
+ * A transport may also have a ready line, which the PIC raises when it has something to send (e.g.
+ * a GPIO pin on an interrupt). The Pi then blocks on the line rather than polling over SPI.
+ *
+ * pi_spi reads the time (for its timeouts and latencies) from the transport, so that a transport
+ * replaying a recorded run (CReplayTransport) can give the times of the run.
+ *
+ * Public Methods:
+ *    - Setup(channel, speed, mode) - Opens the channel (does nothing by default).
+ *    - Transfer(channel, data, len) - One SPI transfer. Returns len, or -1 on failure.
+ *    - HasReadyLine() - Whether there is a ready line (none by default).
+ *    - WaitReady(timeout) - Blocks until the ready line is raised, for at most timeout
+ *    	microseconds. Returns whether it was raised.
+ *    - Now() - The time (steady_clock by default).
+ *
+ */
+class CSPITransport
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	virtual ~CSPITransport() {}
+
+	// === Public Functions =========================================================================
+	virtual void Setup(int /*channel*/, int /*speed*/, int /*mode*/) {}
+	virtual int Transfer(int channel, unsigned char* data, int len) = 0;
+	virtual bool HasReadyLine() const {return false;}
+	virtual bool WaitReady(uint32_t /*timeout_us*/) {return false;}
+	virtual std::chrono::steady_clock::time_point Now() {return std::chrono::steady_clock::now();}
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is the SPI transport on the robot, which passes each transfer to wiringPi.
+ *
+ * There is only one SPI bus, so there is only one of these, got with Instance().
+ *
+ */
+class CWiringPiTransport : public CSPITransport
+{
+public:
+	// === Public Functions =========================================================================
+	static CWiringPiTransport& Instance();
+
+	void Setup(int channel, int speed, int mode) override;
+	int Transfer(int channel, unsigned char* data, int len) override;
+
+private:
+	// === Constructor and Destructors ==============================================================
+	CWiringPiTransport() {}
+};
+
+#endif /* SRC_CSPITRANSPORT_H_ */
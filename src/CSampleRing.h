@@ -0,0 +1,136 @@
+/*
+ * CSampleRing.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CSAMPLERING_H_
+#define SRC_CSAMPLERING_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a ring of the most recent samples, written by one thread and read by others without
+ * locks, for publishing sensor readings (see CSensorAcquisition).
+ *
+ * Unlike CBoundedQueue, the writer never waits: each Push overwrites the oldest sample, and readers
+ * look at the newest samples without taking them. Each slot carries the number of the sample in it,
+ * which the writer clears before writing and sets after, so a reader can tell when the slot it
+ * copied was being overwritten at the same time, and reads it again (or leaves it out of a history).
+ *
+ * Samples must be trivially copyable, since they are copied while they may be being written. The
+ * ring is allocated once, in the constructor, so neither pushing nor reading allocates.
+ *
+ * The whole class is in the header because it is templated.
+ *
+ * Public Constructors:
+ *    - CSampleRing(capacity) - An empty ring holding the last capacity (at least two) samples.
+ *
+ * Public Methods:
+ *    - Push(sample) - Adds a sample, overwriting the oldest. Only one thread may push.
+ *    - Latest(sample) - Copies the newest sample. Returns false if there is none yet.
+ *    - History(samples, count) - Copies up to count of the newest samples, oldest first, and
+ *    	returns how many it copied.
+ *    - GetPushed/GetCapacity - The samples pushed so far, and the size of the ring.
+ *
+ */
+template<typename T>
+class CSampleRing
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Samples are copied while they may be being written");
+
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CSampleRing(std::size_t capacity)
+			: m_capacity { capacity > 2 ? capacity : 2 }, m_slots { new SSlot[m_capacity] }, m_pushed { 0 }
+	{
+		for (std::size_t i = 0; i < m_capacity; ++i)
+			m_slots[i].m_number.store(0, std::memory_order_relaxed);
+	}
+
+	CSampleRing(const CSampleRing&) = delete;
+	CSampleRing& operator=(const CSampleRing&) = delete;
+
+	// === Public Functions =========================================================================
+	void Push(const T& sample)
+	{
+		uint64_t number = m_pushed.load(std::memory_order_relaxed);
+		SSlot& slot = m_slots[number % m_capacity];
+
+		slot.m_number.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.m_sample = sample;
+		slot.m_number.store(number + 1, std::memory_order_release);
+
+		m_pushed.store(number + 1, std::memory_order_release);
+	}
+
+	bool Latest(T& sample) const
+	{
+		while (true)
+		{
+			uint64_t pushed = m_pushed.load(std::memory_order_acquire);
+			if (pushed == 0)
+				return false;
+			if (Read(pushed - 1, sample))
+				return true;
+		}
+	}
+
+	std::size_t History(T* samples, std::size_t count) const
+	{
+		// The slot after the newest may be being written, so at most capacity - 1 can be read
+		uint64_t pushed = m_pushed.load(std::memory_order_acquire);
+		uint64_t available = pushed < m_capacity - 1 ? pushed : m_capacity - 1;
+		if (count > available)
+			count = available;
+
+		// Samples overwritten while copying are left out, and only the newer ones are kept
+		std::size_t copied = 0;
+		for (uint64_t number = pushed - count; number < pushed; ++number)
+		{
+			if (Read(number, samples[copied]))
+				++copied;
+			else
+				copied = 0;
+		}
+		return copied;
+	}
+
+	// Access functions
+	uint64_t GetPushed() const {return m_pushed.load(std::memory_order_acquire);}
+	std::size_t GetCapacity() const {return m_capacity;}
+
+private:
+	// === Private Types ============================================================================
+	struct SSlot
+	{
+		std::atomic<uint64_t> m_number;		// Number of the sample in the slot plus one (0 while writing)
+		T m_sample;
+	};
+
+	// === Private Functions ========================================================================
+	// Copies sample number (counting from 0), returning false if it has been overwritten
+	bool Read(uint64_t number, T& sample) const
+	{
+		const SSlot& slot = m_slots[number % m_capacity];
+		if (slot.m_number.load(std::memory_order_acquire) != number + 1)
+			return false;
+
+		sample = slot.m_sample;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot.m_number.load(std::memory_order_relaxed) == number + 1;
+	}
+
+	// === Member Variables =========================================================================
+	const std::size_t m_capacity;
+	std::unique_ptr<SSlot[]> m_slots;
+	std::atomic<uint64_t> m_pushed;
+};
+
+#endif /* SRC_CSAMPLERING_H_ */
@@ -0,0 +1,127 @@
+/*
+ * CSensorAcquisition.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSensorAcquisition.h"
+#include "CTelemetryRecorder.h"
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CSensorAcquisition::CSensorAcquisition(uint32_t period, size_t history)
+		: m_period { period > 0 ? period : 1 }, m_samples { history }, m_running { false }, m_runTime { 0 },
+		  m_drops { 0 }, m_timeouts { 0 }, m_totalJitter { 0 }, m_maxJitter { 0 }, m_starts { 0 }
+{
+	DEBUG_METHOD();
+}
+
+CSensorAcquisition::~CSensorAcquisition()
+{
+	DEBUG_METHOD();
+
+	Stop();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function starts the acquisition thread, if it is not already running. The first frame is
+ * read straight away.
+ */
+void CSensorAcquisition::Start()
+{
+	DEBUG_METHOD();
+
+	if (m_thread.joinable())
+		return;
+
+	m_startTime = chrono::steady_clock::now();
+	m_running = true;
+	m_thread = thread { &CSensorAcquisition::Run, this };
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function stops the acquisition thread, waiting for the frame being read to finish. The
+ * samples and counters are kept.
+ */
+void CSensorAcquisition::Stop()
+{
+	DEBUG_METHOD();
+
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+double CSensorAcquisition::GetMeanJitter() const
+{
+	uint64_t starts = m_starts.load();
+	return starts > 0 ? m_totalJitter.load() / starts : 0;
+}
+
+double CSensorAcquisition::GetRate() const
+{
+	double runTime = m_runTime.load();
+	return runTime > 0 ? GetSamples() / runTime : 0;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function is the acquisition thread. Frames are scheduled on a fixed grid of periods from
+ * Start, so a late frame does not delay the ones after it; periods which have passed entirely
+ * while a frame was late are skipped and counted as drops.
+ */
+void CSensorAcquisition::Run()
+{
+	// Logging each frame would take longer than reading it
+	DEBUG_MUTE_THREAD(true);
+
+	const chrono::microseconds period { m_period };
+	chrono::steady_clock::time_point next = m_startTime;
+
+	while (m_running)
+	{
+		this_thread::sleep_until(next);
+
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		double jitter = chrono::duration<double, micro>(now - next).count();
+		m_totalJitter = m_totalJitter.load() + jitter;
+		if (jitter > m_maxJitter.load())
+			m_maxJitter = jitter;
+		++m_starts;
+
+		try
+		{
+			SSensorSample sample;
+			pic_read_sensor_frame(&sample.m_frame, 0);
+			CTelemetryRecorder::NoteSensorFrame(sample.m_frame);
+			sample.m_time = chrono::steady_clock::now();
+			m_samples.Push(sample);
+		}
+		catch (Exception_SPITimeout& e)
+		{
+			++m_timeouts;
+			++m_drops;
+		}
+
+		now = chrono::steady_clock::now();
+		m_runTime = chrono::duration<double>(now - m_startTime).count();
+
+		// Skip the periods already over
+		next += period;
+		if (now > next)
+		{
+			uint64_t missed = (now - next) / period + 1;
+			m_drops += missed;
+			next += missed*period;
+		}
+	}
+
+	DEBUG_MUTE_THREAD(false);
+}
@@ -0,0 +1,105 @@
+/*
+ * CSensorAcquisition.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CSENSORACQUISITION_H_
+#define SRC_CSENSORACQUISITION_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSampleRing.h"
+#include "pi_spi.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// One sensor frame, with the time the Pi received it
+struct SSensorSample
+{
+	sensor_frame_t m_frame;
+	std::chrono::steady_clock::time_point m_time;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to read the sensors on a thread of their own, at a fixed rate, so that sampling
+ * does not wait on the planner and the planner does not wait on the SPI link.
+ *
+ * The acquisition thread reads a sensor frame (pic_read_sensor_frame) every period and pushes it
+ * into a CSampleRing. Other threads read the newest sample, or the last few, from the ring without
+ * locks and without allocating.
+ *
+ * The thread shares the SPI link with the rest of the program. pi_spi holds the link for each
+ * whole transaction, so a frame may wait for another thread's command; that shows up as jitter. A
+ * stalled motion (or Wait_Done) takes the link only for each poll while it waits for its DONE, so
+ * frames are read between its polls.
+ *
+ * Counters, readable at any time:
+ *    - Samples - Frames read and published.
+ *    - Drops - Periods in which no frame was published: the frame was late by a whole period or
+ *      more, or the read timed out.
+ *    - Jitter - How late each frame was started after its scheduled time (mean and worst).
+ *    - Rate - Frames published per second since Start.
+ *
+ * Public Constructors:
+ *    - CSensorAcquisition(period, history) - Reads a frame every period microseconds, keeping the
+ *    	last history frames.
+ *
+ * Public Methods:
+ *    - Start()/Stop() - Starts and stops the acquisition thread. Stop is called by the destructor.
+ *    - Latest(sample) - The newest sample. Returns false if there is none yet.
+ *    - History(samples, count) - Up to count of the newest samples, oldest first.
+ *    - GetSamples/GetDrops/GetTimeouts/GetMeanJitter/GetMaxJitter/GetRate - The counters.
+ *
+ */
+class CSensorAcquisition
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CSensorAcquisition(uint32_t period = 5000, std::size_t history = 256);
+	~CSensorAcquisition();
+
+	CSensorAcquisition(const CSensorAcquisition&) = delete;
+	CSensorAcquisition& operator=(const CSensorAcquisition&) = delete;
+
+	// === Public Functions =========================================================================
+	void Start();
+	void Stop();
+	bool Latest(SSensorSample& sample) const {return m_samples.Latest(sample);}
+	std::size_t History(SSensorSample* samples, std::size_t count) const {return m_samples.History(samples, count);}
+
+	// Counters
+	uint64_t GetSamples() const {return m_samples.GetPushed();}
+	uint64_t GetDrops() const {return m_drops.load();}
+	uint64_t GetTimeouts() const {return m_timeouts.load();}
+	double GetMeanJitter() const;
+	double GetMaxJitter() const {return m_maxJitter.load();}
+	double GetRate() const;
+	uint32_t GetPeriod() const {return m_period;}
+
+private:
+	// === Private Functions ========================================================================
+	void Run();
+
+	// === Member Variables =========================================================================
+	const uint32_t m_period;			// Microseconds
+	CSampleRing<SSensorSample> m_samples;
+
+	std::atomic<bool> m_running;
+	std::chrono::steady_clock::time_point m_startTime;
+	std::atomic<double> m_runTime;		// Seconds from Start to the last frame
+
+	// Counters
+	std::atomic<uint64_t> m_drops;
+	std::atomic<uint64_t> m_timeouts;
+	std::atomic<double> m_totalJitter;	// Microseconds
+	std::atomic<double> m_maxJitter;
+	std::atomic<uint64_t> m_starts;		// Frames started (on time or late)
+
+	std::thread m_thread;
+};
+
+#endif /* SRC_CSENSORACQUISITION_H_ */
@@ -0,0 +1,115 @@
+/*
+ * CSensorAcquisition_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CSensorAcquisition.h"
+#include "CSampleRing.h"
+#include "CPicEmulator.h"
+#include "GoodsOut.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that the sample ring keeps the newest samples in order, and that the acquisition thread
+// keeps publishing sensor frames at its rate while the robot is driven from the test thread, even
+// while the test thread waits for a stalled motion
+int CSensorAcquisition_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CSensorAcquisition_test--\n\n";
+
+	int result = 0;
+
+	// -- Sample ring -- //
+	CSampleRing<int> ring(4);
+	int latest = -1;
+	if (ring.Latest(latest))
+	{
+		cout << "Empty ring had a sample\n";
+		result = 1;
+	}
+	for (int i = 0; i < 10; ++i)
+		ring.Push(i);
+
+	int history[10];
+	size_t count = ring.History(history, 10);
+	if (!ring.Latest(latest) || latest != 9 || count != 3 || history[0] != 7 || history[2] != 9 || ring.GetPushed() != 10)
+	{
+		cout << "Ring did not keep the newest samples\n";
+		result = 1;
+	}
+
+	// -- Acquisition alongside driving -- //
+	CPicEmulator pic;
+	pic.Attach();
+
+	CSensorAcquisition acquisition(1000, 64);
+	acquisition.Start();
+	for (int i = 0; i < 5; ++i)
+	{
+		CGoodsOut::Forward(60, false);
+		pic_read_compass();
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+	this_thread::sleep_for(chrono::milliseconds(20));
+	acquisition.Stop();
+
+	SSensorSample samples[64];
+	count = acquisition.History(samples, 64);
+	bool ordered = count > 0;
+	for (size_t i = 1; i < count; ++i)
+	{
+		ordered = ordered && samples[i].m_frame.sequence == static_cast<uint16_t>(samples[i - 1].m_frame.sequence + 1)
+				&& samples[i].m_time > samples[i - 1].m_time
+				&& samples[i].m_frame.encoder_left >= samples[i - 1].m_frame.encoder_left;
+	}
+
+	SSensorSample newest;
+	if (!acquisition.Latest(newest) || newest.m_frame.encoder_left != 50 || !ordered || acquisition.GetSamples() < 20
+			|| acquisition.GetTimeouts() != 0)
+	{
+		cout << "Frames were not published in order (" << acquisition.GetSamples() << " samples)\n";
+		result = 1;
+	}
+	cout << acquisition.GetSamples() << " frames at " << acquisition.GetRate() << " per second (1 ms period), jitter mean "
+			<< acquisition.GetMeanJitter() << " us, worst " << acquisition.GetMaxJitter() << " us, " << acquisition.GetDrops()
+			<< " drops\n";
+
+	// -- Acquisition during a stalled motion -- //
+	// The motion takes the link only for each poll, so frames are read while it is driven
+	SPicLatency latency;
+	latency.m_motionPolls = 200;
+	pic.SetLatency(latency);
+
+	CSensorAcquisition stalledAcquisition(1000, 64);
+	stalledAcquisition.Start();
+	this_thread::sleep_for(chrono::milliseconds(5));
+	uint64_t before = stalledAcquisition.GetSamples();
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	CGoodsOut::Forward(60, false);
+	double driven = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	uint64_t during = stalledAcquisition.GetSamples() - before;
+	stalledAcquisition.Stop();
+
+	if (during < driven/4)
+	{
+		cout << "Only " << during << " frames were read during a " << driven << " ms stalled motion\n";
+		result = 1;
+	}
+
+	pic.Detach();
+
+	// Report success
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
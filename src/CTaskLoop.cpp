@@ -0,0 +1,154 @@
+/*
+ * CTaskLoop.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CTaskLoop.h"
+#include <thread>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+
+// -/-/-/-/-/-/-/ SAwait /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+SAwait SAwait::Yield()
+{
+	return SAwait { EAwait_Ready, chrono::steady_clock::time_point(), nullptr };
+}
+
+SAwait SAwait::Until(chrono::steady_clock::time_point until)
+{
+	return SAwait { EAwait_Time, until, nullptr };
+}
+
+SAwait SAwait::Condition(function<bool()> condition)
+{
+	return SAwait { EAwait_Condition, chrono::steady_clock::time_point(), condition };
+}
+
+SAwait SAwait::Done()
+{
+	return SAwait { EAwait_Done, chrono::steady_clock::time_point(), nullptr };
+}
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CTaskLoop::CTaskLoop(bool simulatedTime)
+		: m_simulatedTime { simulatedTime }, m_simulatedNow { }, m_turns { 0 }, m_resumes { 0 }
+{
+	DEBUG_METHOD();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CTaskLoop::Spawn(shared_ptr<CTask> pTask)
+{
+	DEBUG_METHOD();
+
+	m_tasks.push_back({ pTask, SAwait::Yield() });
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function runs one turn of the loop: every task which is ready is resumed once, in the order
+ * they were spawned, and finished tasks are removed.
+ *
+ * Tasks may spawn other tasks while being resumed, so the list is indexed rather than iterated and
+ * the task is held by a copy of its pointer.
+ */
+bool CTaskLoop::RunOnce()
+{
+	++m_turns;
+
+	for (unsigned int i = 0; i < m_tasks.size(); ++i)
+	{
+		if (!IsReady(m_tasks[i].m_await))
+			continue;
+
+		shared_ptr<CTask> pTask = m_tasks[i].m_pTask;
+		SAwait await = pTask->Resume(*this);
+		++m_resumes;
+
+		if (await.m_type == EAwait_Done)
+			pTask->m_done = true;
+		m_tasks[i].m_await = await;
+	}
+
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < m_tasks.size(); ++i)
+	{
+		if (!m_tasks[i].m_pTask->IsDone())
+			m_tasks[kept++] = m_tasks[i];
+	}
+	m_tasks.resize(kept);
+
+	return !m_tasks.empty();
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function runs the loop until every task has finished.
+ *
+ * Between turns, if no task is ready, the loop sleeps until the first timer is due (on simulated
+ * time the clock jumps there). If there are no timers then the tasks wait on conditions, which on
+ * the real clock may be changed by the outside world (e.g. the PIC), so the loop just yields the
+ * processor and checks again.
+ */
+void CTaskLoop::Run()
+{
+	DEBUG_METHOD();
+
+	while (RunOnce())
+	{
+		bool anyReady = false;
+		bool anyTimer = false;
+		chrono::steady_clock::time_point firstTimer = chrono::steady_clock::time_point::max();
+		for (unsigned int i = 0; i < m_tasks.size() && !anyReady; ++i)
+		{
+			const SAwait& await = m_tasks[i].m_await;
+			if (IsReady(await))
+				anyReady = true;
+			else if (await.m_type == EAwait_Time && await.m_until < firstTimer)
+			{
+				anyTimer = true;
+				firstTimer = await.m_until;
+			}
+		}
+		if (anyReady)
+			continue;
+
+		if (m_simulatedTime)
+		{
+			if (!anyTimer)
+				throw Exception_Stalled { GetTaskCount() };
+			m_simulatedNow = firstTimer;
+		}
+		else if (anyTimer)
+			this_thread::sleep_until(firstTimer);
+		else
+			this_thread::yield();
+	}
+}
+
+chrono::steady_clock::time_point CTaskLoop::Now() const
+{
+	return m_simulatedTime ? m_simulatedNow : chrono::steady_clock::now();
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+bool CTaskLoop::IsReady(const SAwait& await) const
+{
+	switch (await.m_type)
+	{
+	case EAwait_Ready:
+		return true;
+	case EAwait_Time:
+		return Now() >= await.m_until;
+	case EAwait_Condition:
+		return await.m_condition();
+	default:
+		return false;
+	}
+}
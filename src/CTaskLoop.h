@@ -0,0 +1,168 @@
+/*
+ * CTaskLoop.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CTASKLOOP_H_
+#define SRC_CTASKLOOP_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CTaskLoop;
+
+// ~~~ ENUMS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// What a task is waiting for before it is resumed again
+enum EAwait
+{
+	EAwait_Ready,			// Resume on the next turn of the loop
+	EAwait_Time,			// Resume once the loop's clock reaches a time
+	EAwait_Condition,		// Resume once a condition holds (checked once per turn)
+	EAwait_Done				// The task has finished
+};
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The value returned by CTask::Resume. Use the static functions, or CTaskLoop::Sleep, to make one.
+struct SAwait
+{
+	EAwait m_type;
+	std::chrono::steady_clock::time_point m_until;
+	std::function<bool()> m_condition;
+
+	static SAwait Yield();
+	static SAwait Until(std::chrono::steady_clock::time_point until);
+	static SAwait Condition(std::function<bool()> condition);
+	static SAwait Done();
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is the base class for the tasks run by a CTaskLoop.
+ *
+ * A task is a state machine. Each call to Resume does a short, non-blocking piece of work (e.g.
+ * one SPI transfer or one planning step) and returns what the task waits for before it should be
+ * resumed again. A task must never block, since that would stop every other task on the loop.
+ *
+ */
+class CTask
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CTask(const std::string& name) : m_name { name }, m_done { false } {}
+	virtual ~CTask() {}
+
+	// === Public Functions =========================================================================
+	virtual SAwait Resume(CTaskLoop& loop) = 0;
+
+	// Access functions
+	const std::string& GetName() const {return m_name;}
+	bool IsDone() const {return m_done;}
+
+private:
+	// === Member Variables =========================================================================
+	friend class CTaskLoop;
+	std::string m_name;
+	bool m_done;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a task whose Resume is a function, usually a lambda keeping its state in captured
+ * variables.
+ */
+class CFunctionTask : public CTask
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CFunctionTask(const std::string& name, std::function<SAwait(CTaskLoop&)> step) : CTask { name }, m_step { step } {}
+
+	// === Public Functions =========================================================================
+	SAwait Resume(CTaskLoop& loop) override {return m_step(loop);}
+
+private:
+	// === Member Variables =========================================================================
+	std::function<SAwait(CTaskLoop&)> m_step;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a single threaded event loop, so that several tasks (e.g. driving a route, polling
+ * sensors and planning) can be interleaved on one core without threads.
+ *
+ * Each turn of the loop resumes every task which is ready, in the order the tasks were spawned, so
+ * the scheduling is deterministic. When no task is ready the loop sleeps until the first timer is
+ * due. A task spawned during a turn is first resumed in that same turn.
+ *
+ * With simulated time the clock only moves when the loop would otherwise sleep, and then jumps
+ * straight to the next timer. The same tasks then always run the same way, which is what the tests
+ * use.
+ *
+ * An exception thrown by a task is passed on out of RunOnce/Run.
+ *
+ * Public Constructors:
+ *    - CTaskLoop(simulatedTime) - An empty loop, on the steady clock or on simulated time.
+ *
+ * Public Methods:
+ *    - Spawn(pTask) - Adds a task, to be resumed on the next turn.
+ *    - RunOnce() - Runs one turn. Returns whether any tasks are left.
+ *    - Run() - Runs until every task has finished.
+ *    - Now() - The time on the loop's clock.
+ *    - Sleep(duration) - The SAwait for resuming after a time.
+ *    - GetTaskCount/GetTurnCount/GetResumeCount - The state of the loop.
+ *
+ * Exceptions:
+ * 	- Exception_Stalled - Thrown by Run on simulated time if the remaining tasks all wait on
+ * 	conditions and none of them holds, since nothing could ever change.
+ *
+ */
+class CTaskLoop
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CTaskLoop(bool simulatedTime = false);
+
+	// === Public Functions =========================================================================
+	void Spawn(std::shared_ptr<CTask> pTask);
+	bool RunOnce();
+	void Run();
+
+	std::chrono::steady_clock::time_point Now() const;
+	SAwait Sleep(std::chrono::steady_clock::duration duration) const {return SAwait::Until(Now() + duration);}
+
+	// Access functions
+	unsigned int GetTaskCount() const {return m_tasks.size();}
+	unsigned long GetTurnCount() const {return m_turns;}
+	unsigned long GetResumeCount() const {return m_resumes;}
+
+	// === Exceptions ===============================================================================
+	struct Exception_Stalled
+	{
+		unsigned int mm_tasks;
+		explicit Exception_Stalled(unsigned int tasks)
+				: mm_tasks { tasks }
+		{
+		}
+	};
+
+private:
+	// === Private Functions ========================================================================
+	bool IsReady(const SAwait& await) const;
+
+	// === Member Variables =========================================================================
+	struct STaskEntry
+	{
+		std::shared_ptr<CTask> m_pTask;
+		SAwait m_await;
+	};
+	std::vector<STaskEntry> m_tasks;
+
+	bool m_simulatedTime;
+	std::chrono::steady_clock::time_point m_simulatedNow;
+
+	unsigned long m_turns;
+	unsigned long m_resumes;
+};
+
+#endif /* SRC_CTASKLOOP_H_ */
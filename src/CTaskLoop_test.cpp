@@ -0,0 +1,125 @@
+/*
+ * CTaskLoop_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#include "CTaskLoop.h"
+#include "CRouteTask.h"
+#include "CRouteProgram.h"
+#include "CPicEmulator.h"
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include "DebugLog.hpp"
+
+using namespace std;
+
+// Test that tasks on the event loop are interleaved deterministically, and that a route is driven
+// on the emulated PIC while another task runs
+int CTaskLoop_test()
+{
+	DEBUG_METHOD();
+
+	cout << "--CTaskLoop_test--\n\n";
+
+	int result = 0;
+
+	// -- Two sleeping tasks, and a third waiting for the first to finish, on simulated time -- //
+	CTaskLoop loop { true };
+	chrono::steady_clock::time_point start = loop.Now();
+	ostringstream trace;
+	auto makeTask = [&](const string& name, int period, int count) {
+		shared_ptr<int> pRuns = make_shared<int>(0);
+		return make_shared<CFunctionTask>(name, [&trace, &start, name, period, count, pRuns](CTaskLoop& taskLoop) {
+			trace << name << chrono::duration_cast<chrono::milliseconds>(taskLoop.Now() - start).count() << ' ';
+			if (++*pRuns == count)
+				return SAwait::Done();
+			return taskLoop.Sleep(chrono::milliseconds(period));
+		});
+	};
+	shared_ptr<CTask> pA = makeTask("A", 30, 3);
+	loop.Spawn(pA);
+	loop.Spawn(makeTask("B", 20, 4));
+	loop.Spawn(make_shared<CFunctionTask>("C", [&](CTaskLoop& taskLoop) {
+		if (!pA->IsDone())
+			return SAwait::Condition([pA] { return pA->IsDone(); });
+		trace << "C" << chrono::duration_cast<chrono::milliseconds>(taskLoop.Now() - start).count();
+		return SAwait::Done();
+	}));
+	loop.Run();
+	cout << "Trace: " << trace.str() << '\n';
+	if (trace.str() != "A0 B0 B20 A30 B40 A60 B60 C60" || loop.GetTaskCount() != 0)
+	{
+		cout << "The tasks were not interleaved as expected\n";
+		result = 1;
+	}
+
+	// -- A loop whose only task waits on a condition which never holds has stalled -- //
+	CTaskLoop stalledLoop { true };
+	stalledLoop.Spawn(make_shared<CFunctionTask>("Stuck", [](CTaskLoop&) { return SAwait::Condition([] { return false; }); }));
+	bool stalled = false;
+	try
+	{
+		stalledLoop.Run();
+	}
+	catch (const CTaskLoop::Exception_Stalled& e)
+	{
+		stalled = e.mm_tasks == 1;
+	}
+	if (!stalled)
+	{
+		cout << "The stalled loop was not detected\n";
+		result = 1;
+	}
+
+	// -- A route driven on the emulated PIC, with another task polling alongside it -- //
+	CPicEmulator pic;
+	pic.Attach();
+
+	vector<SMotion> motions = { { EMotion_Forward, 3*HALFROOMLENGTH, true }, { EMotion_TurnLeft90, 0, false },
+			{ EMotion_Forward, HALFROOMLENGTH, false }, { EMotion_TurnRight90, 0, false }, { EMotion_Forward, ROOMLENGTH, false } };
+	vector<uint16_t> program = CRouteProgram::Encode(motions);
+
+	CTaskLoop routeLoop { true };
+	shared_ptr<CRouteTask> pRoute = make_shared<CRouteTask>(program, chrono::milliseconds(10));
+	unsigned int polls = 0;
+	routeLoop.Spawn(pRoute);
+	routeLoop.Spawn(make_shared<CFunctionTask>("Poll", [&](CTaskLoop& taskLoop) {
+		if (pRoute->IsDone())
+			return SAwait::Done();
+		++polls;
+		return taskLoop.Sleep(chrono::milliseconds(4));
+	}));
+	routeLoop.Run();
+
+	cout << "Route of " << program.size() << " words driven in " << routeLoop.GetTurnCount() << " turns, with "
+			<< polls << " polls alongside\n";
+	if (pRoute->GetStatus() != ROUTE_COMPLETE || pRoute->GetCompleted() != program.size()
+			|| pic.GetExecutedMotions().size() != program.size() || polls < program.size())
+	{
+		cout << "The route was not driven alongside the polling task\n";
+		result = 1;
+	}
+
+	// A rejected route finishes straight away
+	pic.CorruptNextRoute();
+	CTaskLoop rejectLoop { true };
+	shared_ptr<CRouteTask> pRejected = make_shared<CRouteTask>(program);
+	rejectLoop.Spawn(pRejected);
+	rejectLoop.Run();
+	if (pRejected->GetStatus() != ROUTE_REJECTED)
+	{
+		cout << "The corrupted route was not rejected\n";
+		result = 1;
+	}
+
+	pic.Detach();
+
+	if (result == 0)
+		cout << "Test successful\n";
+	else
+		cout << "Test failed\n";
+
+	return result;
+}
@@ -0,0 +1,222 @@
+/*
+ * CTelemetryLog.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CTelemetryLog.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ CONSTANTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static const char MAGIC[8] = { 'T', 'E', 'L', 'E', 'M', 'L', 'O', 'G' };
+static const uint32_t VERSION = 1;
+
+// Records are padded to 8 bytes, so every record header is aligned
+static size_t Padded(size_t length)
+{
+	return (length + 7) & ~static_cast<size_t>(7);
+}
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CTelemetryLog::CTelemetryLog()
+		: m_file { -1 }, m_mapping { nullptr }, m_size { 0 }, m_writable { false }
+{
+	DEBUG_METHOD();
+}
+
+CTelemetryLog::~CTelemetryLog()
+{
+	DEBUG_METHOD();
+
+	Close();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CTelemetryLog::Create(const string& path, size_t size)
+{
+	DEBUG_METHOD();
+
+	Close();
+	m_path = path;
+	m_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_file < 0)
+		throw Exception_TelemetryFile { path, errno };
+
+	Map(max(size, sizeof(SHeader)), true);
+	SHeader* header = Header();
+	memcpy(header->m_magic, MAGIC, sizeof(MAGIC));
+	header->m_version = VERSION;
+	header->m_headerSize = sizeof(SHeader);
+	header->m_bytes = 0;
+	header->m_records = 0;
+}
+
+void CTelemetryLog::Open(const string& path)
+{
+	DEBUG_METHOD();
+
+	Close();
+	m_path = path;
+	m_file = open(path.c_str(), O_RDONLY);
+	if (m_file < 0)
+		throw Exception_TelemetryFile { path, errno };
+
+	struct stat status;
+	if (fstat(m_file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SHeader))
+	{
+		Close();
+		throw Exception_TelemetryFile { path, 0 };
+	}
+
+	Map(status.st_size, false);
+	const SHeader* header = Header();
+	if (memcmp(header->m_magic, MAGIC, sizeof(MAGIC)) != 0 || header->m_version != VERSION
+			|| header->m_headerSize != sizeof(SHeader) || sizeof(SHeader) + header->m_bytes > m_size)
+	{
+		Close();
+		throw Exception_TelemetryFile { path, 0 };
+	}
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function closes the log. A log being written is cut down to its records first; if it was
+ * never mapped, the file is left as it is.
+ */
+void CTelemetryLog::Close()
+{
+	DEBUG_METHOD();
+
+	if (m_mapping)
+	{
+		size_t used = sizeof(SHeader) + Header()->m_bytes;
+		munmap(m_mapping, m_size);
+		if (m_writable && ftruncate(m_file, used) != 0)
+			DEBUG_VALUE_OF(errno);
+	}
+	if (m_file >= 0)
+		close(m_file);
+
+	m_file = -1;
+	m_mapping = nullptr;
+	m_size = 0;
+	m_writable = false;
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function appends a record. It is not thread safe: CTelemetryRecorder serialises appends.
+ *
+ * Exception_TelemetryFile is thrown if the log is not open to append to, or cannot grow (e.g. the
+ * disk is full). The log is left as it was, with the records already appended.
+ */
+void CTelemetryLog::Append(ETelemetry type, uint64_t time, const void* data, uint32_t length)
+{
+	if (!IsOpen() || !m_writable)
+		throw Exception_TelemetryFile { m_path, EBADF };
+
+	SHeader* header = Header();
+	size_t offset = sizeof(SHeader) + header->m_bytes;
+	size_t recordSize = sizeof(SRecordHeader) + Padded(length);
+	if (offset + recordSize > m_size)
+	{
+		Grow(max(2*m_size, offset + recordSize));
+		header = Header();
+	}
+
+	SRecordHeader record = { static_cast<uint32_t>(type), length, time };
+	memcpy(m_mapping + offset, &record, sizeof(record));
+	memcpy(m_mapping + offset + sizeof(record), data, length);
+
+	// Counted only once it is all there
+	header->m_bytes += recordSize;
+	++header->m_records;
+}
+
+bool CTelemetryLog::Read(size_t& offset, STelemetryEntry& record) const
+{
+	if (!m_mapping)
+		return false;
+
+	size_t end = sizeof(SHeader) + Header()->m_bytes;
+	size_t position = sizeof(SHeader) + offset;
+	if (position + sizeof(SRecordHeader) > end)
+		return false;
+
+	SRecordHeader header;
+	memcpy(&header, m_mapping + position, sizeof(header));
+	if (position + sizeof(SRecordHeader) + header.m_length > end)
+		return false;
+
+	record.m_type = static_cast<ETelemetry>(header.m_type);
+	record.m_time = header.m_time;
+	record.m_data = m_mapping + position + sizeof(SRecordHeader);
+	record.m_length = header.m_length;
+	offset += sizeof(SRecordHeader) + Padded(header.m_length);
+	return true;
+}
+
+uint64_t CTelemetryLog::GetRecords() const
+{
+	return m_mapping ? Header()->m_records : 0;
+}
+
+uint64_t CTelemetryLog::GetBytes() const
+{
+	return m_mapping ? Header()->m_bytes : 0;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+// Maps a log being created or opened. The log is closed if it cannot be.
+void CTelemetryLog::Map(size_t size, bool writable)
+{
+	if (writable && ftruncate(m_file, size) != 0)
+	{
+		int error = errno;
+		Close();
+		throw Exception_TelemetryFile { m_path, error };
+	}
+
+	void* mapping = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_file, 0);
+	if (mapping == MAP_FAILED)
+	{
+		int error = errno;
+		Close();
+		throw Exception_TelemetryFile { m_path, error };
+	}
+
+	m_mapping = static_cast<unsigned char*>(mapping);
+	m_size = size;
+	m_writable = writable;
+}
+
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function makes the file bigger, and maps it again. The old mapping is kept until the new
+ * one is made, so if the file cannot grow the log is still open with all its records.
+ */
+void CTelemetryLog::Grow(size_t size)
+{
+	DEBUG_METHOD();
+
+	if (ftruncate(m_file, size) != 0)
+		throw Exception_TelemetryFile { m_path, errno };
+
+	void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+	if (mapping == MAP_FAILED)
+		throw Exception_TelemetryFile { m_path, errno };
+
+	munmap(m_mapping, m_size);
+	m_mapping = static_cast<unsigned char*>(mapping);
+	m_size = size;
+}
@@ -0,0 +1,127 @@
+/*
+ * CTelemetryLog.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CTELEMETRYLOG_H_
+#define SRC_CTELEMETRYLOG_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ~~~ ENUMS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// What a telemetry record holds
+enum ETelemetry
+{
+	ETelemetry_Transfer = 1,	// One SPI transfer: channel, length, the bytes sent, the bytes received
+	ETelemetry_Clock,			// A time read by pi_spi (nanoseconds on the steady clock)
+	ETelemetry_SensorFrame,		// A sensor_frame_t
+	ETelemetry_CameraFrame,		// The reference (e.g. file name) of a camera frame used
+	ETelemetry_Decision,		// A planner decision, as text
+	ETelemetry_Motion			// A motion command driven: EMotion (int32), distance and seconds to DONE (doubles)
+};
+
+// ~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A record read from a log. m_data points into the mapped file, so it lasts as long as the log.
+struct STelemetryEntry
+{
+	ETelemetry m_type;
+	uint64_t m_time;			// Nanoseconds from the start of the recording
+	const unsigned char* m_data;
+	uint32_t m_length;
+};
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is an append-only binary log of telemetry records, kept in a memory-mapped file, for
+ * recording a run on the robot (CTelemetryRecorder) and replaying it (CReplayTransport).
+ *
+ * Appending a record copies it into the mapping; there is no system call unless the file has to
+ * grow (it doubles). The count of records in the file header is only updated once a record has
+ * been written, so the records counted are always whole, even if the program dies part way
+ * through. The file is cut down to the records written when the log is closed.
+ *
+ * File layout: a header ("TELEMLOG", version, bytes and number of records), then the records,
+ * each [type, length, time] then its data, padded to 8 bytes. Numbers are in the Pi's byte order.
+ *
+ * Public Constructors:
+ *    - CTelemetryLog() - A closed log.
+ *
+ * Public Methods:
+ *    - Create(path, size) - Creates (or empties) a log to append to, size bytes to start with.
+ *    - Open(path) - Opens a log to read.
+ *    - Close() - Closes the log. Called by the destructor.
+ *    - Append(type, time, data, length) - Appends a record (logs opened with Create). Throws if the
+ *    	log cannot grow, leaving the records already appended.
+ *    - Read(offset, record) - Reads the record at offset (0 for the first), and moves offset on to
+ *    	the next. Returns false after the last.
+ *    - GetRecords/GetBytes - The records, and the bytes of them, in the log.
+ *
+ */
+class CTelemetryLog
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	CTelemetryLog();
+	~CTelemetryLog();
+
+	CTelemetryLog(const CTelemetryLog&) = delete;
+	CTelemetryLog& operator=(const CTelemetryLog&) = delete;
+
+	// === Public Functions =========================================================================
+	void Create(const std::string& path, std::size_t size = 1 << 20);
+	void Open(const std::string& path);
+	void Close();
+	void Append(ETelemetry type, uint64_t time, const void* data, uint32_t length);
+	bool Read(std::size_t& offset, STelemetryEntry& record) const;
+
+	// Access functions
+	bool IsOpen() const {return m_mapping != nullptr;}
+	uint64_t GetRecords() const;
+	uint64_t GetBytes() const;
+
+	// === Exceptions ===============================================================================
+	struct Exception_TelemetryFile
+	{
+		std::string mm_path;
+		int mm_error;				// errno, or 0 if the file is not a telemetry log
+		Exception_TelemetryFile(const std::string& path, int error)
+				: mm_path { path }, mm_error { error }
+		{
+		}
+	};
+
+private:
+	// === Private Types ============================================================================
+	struct SHeader
+	{
+		char m_magic[8];
+		uint32_t m_version;
+		uint32_t m_headerSize;
+		uint64_t m_bytes;			// Of whole records, after the header
+		uint64_t m_records;
+	};
+
+	struct SRecordHeader
+	{
+		uint32_t m_type;
+		uint32_t m_length;			// Of the data, without the padding
+		uint64_t m_time;
+	};
+
+	// === Private Functions ========================================================================
+	void Map(std::size_t size, bool writable);
+	void Grow(std::size_t size);
+	SHeader* Header() const {return reinterpret_cast<SHeader*>(m_mapping);}
+
+	// === Member Variables =========================================================================
+	std::string m_path;
+	int m_file;
+	unsigned char* m_mapping;
+	std::size_t m_size;				// Of the mapping
+	bool m_writable;
+};
+
+#endif /* SRC_CTELEMETRYLOG_H_ */
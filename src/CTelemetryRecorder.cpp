@@ -0,0 +1,187 @@
+/*
+ * CTelemetryRecorder.cpp
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CTelemetryRecorder.h"
+#include "CReplayTransport.h"
+#include <cstring>
+#include <vector>
+#include "DebugLog.hpp"
+
+// ~~~ NAMESPACES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+using namespace std;
+
+// ~~~ STATICS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+atomic<CTelemetryRecorder*> CTelemetryRecorder::s_active { nullptr };
+
+
+// -/-/-/-/-/-/-/ CONSTRUCTORS AND DESTRUCTORS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+CTelemetryRecorder::CTelemetryRecorder(const string& path, size_t size)
+		: m_inner { nullptr }, m_startTime { chrono::steady_clock::now() }, m_failed { false }
+{
+	DEBUG_METHOD();
+
+	m_log.Create(path, size);
+}
+
+CTelemetryRecorder::~CTelemetryRecorder()
+{
+	DEBUG_METHOD();
+
+	Detach();
+}
+
+
+// -/-/-/-/-/-/-/ PUBLIC FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function starts recording. The transport pi_spi was using is kept, and used through the
+ * recorder until Detach.
+ */
+void CTelemetryRecorder::Attach()
+{
+	DEBUG_METHOD();
+
+	if (get_spi_transport() == this)
+		return;
+
+	m_inner = get_spi_transport();
+	set_spi_transport(this);
+	s_active = this;
+}
+
+void CTelemetryRecorder::Detach()
+{
+	DEBUG_METHOD();
+
+	CTelemetryRecorder* self = this;
+	s_active.compare_exchange_strong(self, nullptr);
+	if (get_spi_transport() == this)
+		set_spi_transport(m_inner);
+}
+
+void CTelemetryRecorder::NoteSensorFrame(const sensor_frame_t& frame)
+{
+	CTelemetryRecorder* recorder = s_active.load(memory_order_acquire);
+	if (recorder)
+		recorder->Append(ETelemetry_SensorFrame, &frame, sizeof(frame));
+	else
+		CReplayTransport::Check(ETelemetry_SensorFrame, &frame, sizeof(frame));
+}
+
+void CTelemetryRecorder::NoteCameraFrame(const string& reference)
+{
+	CTelemetryRecorder* recorder = s_active.load(memory_order_acquire);
+	if (recorder)
+		recorder->Append(ETelemetry_CameraFrame, reference.data(), reference.size());
+	else
+		CReplayTransport::Check(ETelemetry_CameraFrame, reference.data(), reference.size());
+}
+
+void CTelemetryRecorder::NoteDecision(const string& text)
+{
+	CTelemetryRecorder* recorder = s_active.load(memory_order_acquire);
+	if (recorder)
+		recorder->Append(ETelemetry_Decision, text.data(), text.size());
+	else
+		CReplayTransport::Check(ETelemetry_Decision, text.data(), text.size());
+}
+
+void CTelemetryRecorder::NoteMotion(EMotion type, double distance, double duration)
+{
+	CTelemetryRecorder* recorder = s_active.load(memory_order_acquire);
+	if (!recorder)
+		return;
+
+	unsigned char record[4 + 2*sizeof(double)];
+	int32_t type32 = type;
+	memcpy(record, &type32, 4);
+	memcpy(record + 4, &distance, sizeof(double));
+	memcpy(record + 4 + sizeof(double), &duration, sizeof(double));
+	recorder->Append(ETelemetry_Motion, record, sizeof(record));
+}
+
+uint64_t CTelemetryRecorder::GetRecords() const
+{
+	lock_guard<mutex> lock { m_mutex };
+	return m_log.GetRecords();
+}
+
+
+// -/-/-/-/-/-/-/ CSPITransport /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+void CTelemetryRecorder::Setup(int channel, int speed, int mode)
+{
+	m_inner->Setup(channel, speed, mode);
+}
+
+/* ~~~ FUNCTION (public) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function passes a transfer on, and records [channel, the bytes sent, the bytes received].
+ * The bytes sent are kept on the stack first, as the transfer overwrites them.
+ */
+int CTelemetryRecorder::Transfer(int channel, unsigned char* data, int len)
+{
+	unsigned char record[4 + 2*64];
+	vector<unsigned char> largeRecord;
+	unsigned char* buffer = record;
+	if (len > 64)
+	{
+		largeRecord.resize(4 + 2*len);
+		buffer = largeRecord.data();
+	}
+
+	int32_t channel32 = channel;
+	memcpy(buffer, &channel32, 4);
+	memcpy(buffer + 4, data, len);
+	int result = m_inner->Transfer(channel, data, len);
+	memcpy(buffer + 4 + len, data, len);
+
+	Append(ETelemetry_Transfer, buffer, 4 + 2*len);
+	return result;
+}
+
+bool CTelemetryRecorder::HasReadyLine() const
+{
+	return m_inner->HasReadyLine();
+}
+
+bool CTelemetryRecorder::WaitReady(uint32_t timeout_us)
+{
+	return m_inner->WaitReady(timeout_us);
+}
+
+chrono::steady_clock::time_point CTelemetryRecorder::Now()
+{
+	chrono::steady_clock::time_point now = m_inner->Now();
+	int64_t nanoseconds = chrono::duration_cast<chrono::nanoseconds>(now.time_since_epoch()).count();
+	Append(ETelemetry_Clock, &nanoseconds, sizeof(nanoseconds));
+	return now;
+}
+
+
+// -/-/-/-/-/-/-/ PRIVATE FUNCTIONS /-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/-/
+/* ~~~ FUNCTION (private) ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This function appends a record to the log. If the log cannot take it (e.g. the disk is full), the
+ * recording stops there rather than the run: the error is not passed on to pi_spi or whoever noted
+ * the record, and the records already written are kept.
+ */
+void CTelemetryRecorder::Append(ETelemetry type, const void* data, uint32_t length)
+{
+	if (m_failed.load(memory_order_relaxed))
+		return;
+
+	uint64_t time = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_startTime).count();
+
+	lock_guard<mutex> lock { m_mutex };
+	try
+	{
+		m_log.Append(type, time, data, length);
+	}
+	catch (CTelemetryLog::Exception_TelemetryFile& e)
+	{
+		DEBUG_METHOD();
+		DEBUG_VALUE_OF(e.mm_error);
+		m_failed = true;
+	}
+}
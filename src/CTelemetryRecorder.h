@@ -0,0 +1,96 @@
+/*
+ * CTelemetryRecorder.h
+ *
+ *  Created on: 18 Oct 2026
+ */
+
+#ifndef SRC_CTELEMETRYRECORDER_H_
+#define SRC_CTELEMETRYRECORDER_H_
+
+// ~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#include "CSPITransport.h"
+#include "CTelemetryLog.h"
+#include "EnumsHeader.h"
+#include "pi_spi.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/* ~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * This is a class to record a run into a CTelemetryLog, so that it can be replayed off the robot
+ * with CReplayTransport.
+ *
+ * Attach puts the recorder between pi_spi and the transport it was using (wiringPi, or an
+ * emulator), so that every SPI transfer and every time pi_spi reads is recorded on the way
+ * through. The rest of the program notes what it sees and decides with the static Note functions:
+ * the sensor frames read by CSensorAcquisition, the camera frames read by CBlockReader and the
+ * routes planned by CChallenges.
+ *
+ * Each challenge records its run this way, to Telemetry<challenge>.log (see Challenges.cpp).
+ *
+ * When nothing is being recorded or replayed the Note functions only check a pointer, so they can
+ * be left in the code. When a run is being replayed they check what is noted against what was
+ * recorded instead (CReplayTransport::GetMismatches).
+ *
+ * Public Constructors:
+ *    - CTelemetryRecorder(path, size) - Records into a new log at path (see CTelemetryLog::Create).
+ *
+ * Public Methods:
+ *    - Attach()/Detach() - Starts recording the SPI link, and stops. Called by the destructor.
+ *    - NoteSensorFrame(frame) - Records a sensor frame.
+ *    - NoteCameraFrame(reference) - Records which camera frame was used (e.g. its file name).
+ *    - NoteDecision(text) - Records a decision of the planner.
+ *    - NoteMotion(type, distance, duration) - Records a motion command and how long it took, for
+ *    	fitting the motion time cost model (see CMotionTimeCostModel::ReadTelemetry). The times are
+ *    	the real clock's, so unlike the other notes they are not checked on a replay.
+ *    - GetRecords() - The records written so far.
+ *    - HasFailed() - Whether the recording stopped because the log could not take a record (e.g.
+ *    	the disk was full). The run goes on; the records written before are kept.
+ *
+ */
+class CTelemetryRecorder : public CSPITransport
+{
+public:
+	// === Constructor and Destructors ==============================================================
+	explicit CTelemetryRecorder(const std::string& path, std::size_t size = 1 << 20);
+	~CTelemetryRecorder();
+
+	CTelemetryRecorder(const CTelemetryRecorder&) = delete;
+	CTelemetryRecorder& operator=(const CTelemetryRecorder&) = delete;
+
+	// === Public Functions =========================================================================
+	void Attach();
+	void Detach();
+
+	static void NoteSensorFrame(const sensor_frame_t& frame);
+	static void NoteCameraFrame(const std::string& reference);
+	static void NoteDecision(const std::string& text);
+	static void NoteMotion(EMotion type, double distance, double duration);
+
+	// Access functions
+	uint64_t GetRecords() const;
+	bool HasFailed() const {return m_failed.load();}
+
+	// CSPITransport
+	void Setup(int channel, int speed, int mode) override;
+	int Transfer(int channel, unsigned char* data, int len) override;
+	bool HasReadyLine() const override;
+	bool WaitReady(uint32_t timeout_us) override;
+	std::chrono::steady_clock::time_point Now() override;
+
+private:
+	// === Private Functions ========================================================================
+	void Append(ETelemetry type, const void* data, uint32_t length);
+
+	// === Member Variables =========================================================================
+	static std::atomic<CTelemetryRecorder*> s_active;
+
+	CTelemetryLog m_log;
+	mutable std::mutex m_mutex;		// Appends come from the acquisition and motion threads too
+	CSPITransport* m_inner;
+	std::chrono::steady_clock::time_point m_startTime;
+	std::atomic<bool> m_failed;		// The log could not take a record, so the recording has stopped
+};
+
+#endif /* SRC_CTELEMETRYRECORDER_H_ */
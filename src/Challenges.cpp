@@ -14,18 +14,98 @@
 #include "GoodsIn.h"
 #include "GoodsOut.h"
 #include "Manouvre.h"
+#include <algorithm>
 #include <climits>
 #include "DebugLog.hpp"
 #include "CMazeMapper.h"
+#include "CExplorationSession.h"
+#include "CCostModel.h"
+#include "CMazeGeometry.h"
+#include "CMotionExecutor.h"
+#include "CTaskLoop.h"
+#include "CRouteTask.h"
+#include "CRouteProgram.h"
+#include "CMissionPlanner.h"
+#include "CRoutePlan.h"
+#include "CMapSnapshot.h"
+#include "CTelemetryRecorder.h"
+#include "CReplayTransport.h"
+#include <chrono>
+#include <future>
+#include <memory>
 
 // ~~~ DEFINITIONS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 int LOCATION_UNKNOWN = -1;
+const int MAZE_ROOM_HEIGHT = 10;	//Size of the challenge maze in rooms
+const int MAZE_ROOM_WIDTH = 10;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Start a new session on the SPI link for a challenge, recorded to Telemetry<name>.log so the run
+// can be replayed off the robot with CReplayTransport. The recording stops when the recorder
+// returned goes. Nothing is recorded while a run is being replayed, and a run goes on without a
+// recording if the log cannot be made.
+static std::unique_ptr<CTelemetryRecorder> StartSession(const std::string& name)
+{
+	DEBUG_METHOD();
+
+	std::unique_ptr<CTelemetryRecorder> pRecorder;
+	if (!CReplayTransport::IsReplaying())
+	{
+		try
+		{
+			pRecorder.reset(new CTelemetryRecorder("Telemetry" + name + ".log"));
+			pRecorder->Attach();
+		}
+		catch (CTelemetryLog::Exception_TelemetryFile& e)
+		{
+			DEBUG_VALUE_OF(e.mm_error);
+		}
+	}
+
+	init_spi();
+	return pRecorder;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// The motion time cost model fitted to the motions noted in the recordings of earlier runs, or
+// null if too few have been recorded to fit it (the planners then keep the unit costs). This must
+// be called before a session starts, as starting one empties its recording.
+static std::shared_ptr<const CCostModel> FittedCostModel()
+{
+	DEBUG_METHOD();
+
+	const unsigned int MIN_MOTIONS = 20;
+	const char* names[] = { "ChallengeOne", "ChallengeTwo", "ChallengeThree", "ChallengeFour" };
+
+	std::vector<STelemetryRecord> telemetry;
+	for (const char* name : names)
+	{
+		try
+		{
+			CTelemetryLog aLog;
+			aLog.Open(std::string("Telemetry") + name + ".log");
+			std::vector<STelemetryRecord> motions = CMotionTimeCostModel::ReadTelemetry(aLog);
+			telemetry.insert(telemetry.end(), motions.begin(), motions.end());
+		}
+		catch (CTelemetryLog::Exception_TelemetryFile& e)
+		{
+			DEBUG_VALUE_OF(e.mm_error);
+		}
+	}
+
+	DEBUG_VALUE_OF(telemetry.size());
+	if (telemetry.size() < MIN_MOTIONS)
+		return nullptr;
+
+	return std::make_shared<CMotionTimeCostModel>(CMotionTimeCostModel::Fit(telemetry));
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Basic outline of challenge 1 I am not sure how the interupts will work exactly.
 void CChallenges::ChallengeOne()
 {
 	DEBUG_METHOD();
+	std::unique_ptr<CTelemetryRecorder> pRecorder = StartSession("ChallengeOne");
 
 	CSignals::Start();
 
@@ -45,54 +125,82 @@ void CChallenges::ChallengeOne()
 void CChallenges::ChallengeTwo()
 {
 	DEBUG_METHOD();
+	std::shared_ptr<const CCostModel> pCostModel = FittedCostModel();
+	std::unique_ptr<CTelemetryRecorder> pRecorder = StartSession("ChallengeTwo");
 
 
 	//////////////////////////////////////////////////////////////////////
-	// Creat empty map
-
-	CMap aMap = CMap(10, 10);
-
-	///////////////////////////////////////////////////////////////////
-	// Flag as to whether a vertex is needed.
-
-	bool is_next_vertex;
-
-	do{
-
-		/////////////////////////////////////////////////////////////////////////////////
-		// Find room type of current room and save it into the map.
+	// Start an exploration session with an empty map. The session keeps the map, graph and
+	// vertices to explore for the whole challenge.
+
+	// Each step looks ahead at tours of the nearest vertices to explore for up to 5ms (a search
+	// usually takes about 1ms), which is well inside the time the robot takes to drive a room.
+	// Routes minimise the driving time of the robot as it drove on earlier runs, when there are
+	// enough of them; the plan for challenge three is made with the same costs.
+	CExplorationSession aSession { MAZE_ROOM_HEIGHT, MAZE_ROOM_WIDTH };
+	aSession.SetPlanningBudget(5000);
+	if (pCostModel)
+		aSession.SetCostModel(pCostModel);
+	CMazeGeometry aGeometry { aSession.GetMap().GetRoomHeight(), aSession.GetMap().GetRoomWidth() };
+	std::vector<int> outputRoute;
 
-		ERoom currentRoomType = CManouvre::DetectRoomType();
-		aMap.SetCurrentRoom(currentRoomType);
+	while (true)
+	{
+		////////////////////////////////////////////////////////////////////////////////
+		// Move to the next vertex to explore. The robot follows the stream on its own thread, so
+		// it sets off as soon as the planner has put the first two vertices of the route in it.
 
+		CInstructionStream aStream { aGeometry };
+		std::future<unsigned int> aDrive = std::async(std::launch::async, [&aStream]() {
+			return CManouvre::FollowStream(aStream);
+		});
 
-		///////////////////////////////////////////////////////////////////////////////
-		// Find next route to explore. Create MazeMapper to choose next vertex and 
-		// route to it.
+		bool isNextTarget = false;
+		try
+		{
+			isNextTarget = aSession.ComputeNextTarget(outputRoute);
+			if (isNextTarget)
+				aStream.Append(outputRoute);
+		}
+		catch (...)
+		{
+			aStream.Close();
+			aDrive.wait();
+			throw;
+		}
+		aStream.Close();
+		aDrive.get();
 
-		CMazeMapper aMazeMapper = CMazeMapper(&aMap);
-		std::vector<int> outputRoute;
-		is_next_vertex = aMazeMapper.ComputeNextVertex(aMap.GetCurrentVertex(), outputRoute);
+		if (!isNextTarget)
+			break;
+		DEBUG_VALUE_OF(aSession.GetLastStepLatency());
+		aSession.SetCurrentVertex(outputRoute.back());
 
 
-		////////////////////////////////////////////////////////////////////////////////
-		// If the next vertex was found move to next vertex.
+		/////////////////////////////////////////////////////////////////////////////////
+		// Find room type of the room beyond the vertex and save it into the map.
 
-		if(is_next_vertex)
-		{
-			CInstructions aInstructions = CInstructions(outputRoute, 10);
-			aMap.FollowInstructions(aInstructions);
-		}
+		int row, col;
+		if (!aSession.RoomBeyondVertex(outputRoute.back(), row, col))
+			break;
 
+		aSession.ObserveRoom(row, col, CManouvre::DetectRoomType());
 	}
-	while(is_next_vertex);
 
 
 	///////////////////////////////////////////////////////////////////////////////////////////
 	// Map now completel known. Write to file.
 
 	std::string filepath = "ExportMap.txt";
-	aMap.WriteCellMap(filepath);
+	aSession.GetMap().WriteCellMap(filepath);
+
+
+	///////////////////////////////////////////////////////////////////////////////////////////
+	// Plan challenge three now, while there is time, so that it can start driving as soon as
+	// it is told to start.
+
+	CRoutePlan aPlan = CRoutePlan::Compile(CMapSnapshot(aSession.GetMap()), aSession.GetCostModel());
+	aPlan.Write("RoutePlan.txt");
 
 
 	//////////////////////////////////////////////////////////////////////////////////////////
@@ -105,52 +213,49 @@ void CChallenges::ChallengeTwo()
 void CChallenges::ChallengeThree()
 {
 	DEBUG_METHOD();
-	std::string filepath;
-
-	filepath = std::string("example.txt");
-
-	CMap aMap = CMap(filepath);
-	int entrance_vertex = aMap.GetEntranceVertex();
-	int exit_vertex = aMap.GetExitVertex();
-
-	std::vector<std::vector<double>> distanceMatrix;
-	std::vector<int> labels;
-	///////////////////////////// Call Johns Function to populate these
-
-
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// Generate graph of map.
-
-	CGraph aGraph = CGraph(distanceMatrix, labels);
-
+	std::unique_ptr<CTelemetryRecorder> pRecorder = StartSession("ChallengeThree");
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// Calculate shortest route from start to finish.
-
-
-	std::vector<int> outputRoute;
-	aGraph.ShortestDistance(entrance_vertex, exit_vertex, outputRoute);
+	// Load the plan made at the end of challenge two. If it is missing or damaged, plan again from
+	// the map challenge two exported. Either way this is done before the start signal.
 
+	std::unique_ptr<CRoutePlan> pPlan;
+	try
+	{
+		pPlan.reset(new CRoutePlan(CRoutePlan::Read("RoutePlan.txt")));
+	}
+	catch (CRoutePlan::Exception_InvalidPlan& e)
+	{
+		DEBUG_VALUE_OF(e.mm_reason);
+		pPlan.reset(new CRoutePlan(CRoutePlan::Compile(CMapSnapshot(CMap("ExportMap.txt")))));
+	}
 
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// Compute macro instructions.
-
-	CInstructions aInstructions = CInstructions(outputRoute, 10);
-
-	std::vector<EInstruction> macroInstructions = aInstructions.GetInstructions();
+	CSignals::Start();
 
 
 	//////////////////////////////////////////////////////////////////////////////////////////////
 	// Now we know our route, execute it
 
-	CManouvre::MoveToStartVertex();
+	// The route is driven by a task on an event loop, which uploads it to the PIC and polls its
+	// progress without blocking.
+	CTaskLoop aLoop;
+	std::shared_ptr<CRouteTask> pRoute = std::make_shared<CRouteTask>(pPlan->GetProgram());
+	aLoop.Spawn(pRoute);
+	aLoop.Run();
 
-	for(unsigned int i=0; i<macroInstructions.size(); i++)
+	// If the PIC would not take the route, drive it one motion at a time instead. If it stopped
+	// part way (aborted, or reset and lost the route), drive the words it had not finished.
+	if (pRoute->GetStatus() == ROUTE_REJECTED)
 	{
-		CManouvre::InstructionToManouvre(macroInstructions[i]);
+		CManouvre::ExecuteMotions(pPlan->GetMotions());
+	}
+	else if (pRoute->GetStatus() != ROUTE_COMPLETE)
+	{
+		DEBUG_VALUE_OF(pRoute->GetStatus());
+		const std::vector<uint16_t>& program = pPlan->GetProgram();
+		std::vector<uint16_t> remaining(program.begin() + std::min<std::size_t>(pRoute->GetCompleted(), program.size()), program.end());
+		CManouvre::ExecuteMotions(CRouteProgram::Decode(remaining));
 	}
-
-	CManouvre::ExitMap();
 
 	CGoodsOut::Stop();
 
@@ -162,6 +267,8 @@ void CChallenges::ChallengeThree()
 void CChallenges::ChallengeFour()
 {
 	DEBUG_METHOD();
+	std::unique_ptr<CTelemetryRecorder> pRecorder = StartSession("ChallengeFour");
+
 	///////////////////////////////////////////////////////////////////////
 	// Import map
 	std::string filepath;
@@ -181,14 +288,13 @@ void CChallenges::ChallengeFour()
 	int next_value = 1;
 
 	///////////////////////////////////////////////////////////////////////
-	// Locations of blocks, the block with an image of one has its location
-	// stored in the first entry, image of two in the second etc.
+	// Locations of blocks, the room of the block with an image of one is
+	// stored in the entry 1, image of two in entry 2 etc.
 	// if unknown -1 or LOCATION UNKNOWN
 	
 	
 	int LOCATION_UNKNOWN = -1;
-	std::vector<int> block_location;
-	block_location = {LOCATION_UNKNOWN, LOCATION_UNKNOWN, LOCATION_UNKNOWN, LOCATION_UNKNOWN, LOCATION_UNKNOWN};
+	std::vector<int> block_location(6, LOCATION_UNKNOWN);
 
 
 	//////////////////////////////////////////////////////////////////////
@@ -204,303 +310,271 @@ void CChallenges::ChallengeFour()
 	std::vector<int> rooms_with_a_block;
 	rooms_with_a_block = unknown_block_rooms;
 
-	
-	while(next_value <=5)
-	{
-		/////////////////////////////////////////////////////////////////////////////////////////////////
-		// Create variable to hold next path.
-
-		std::vector<int> planned_path;
-
-		std::vector<std::vector<double>> distanceMatrix;
-		std::vector<int> labels;
+	/////////////////////////////////////////////////////////////////////
+	// The robot is driven on its own thread, so that each leg is planned
+	// while the one before it is driven.
 
+	CMotionExecutor aExecutor;
 
-		// Calculated by Johns function.
 
-		CGraph aGraph { distanceMatrix, labels };
+	/////////////////////////////////////////////////////////////////////
+	// Generate graph of map. The map does not change, so this is done once.
 
-		//////////////////////////////////////////////////////////////////////
-		// Check if location of next block is known.
+	std::vector<std::vector<double>> distanceMatrix = aMap.DistanceMatrix();
+	std::vector<int> labels(distanceMatrix.size());
+	for (unsigned int i = 0; i < labels.size(); i++)
+		labels[i] = i;
 
-		if(block_location[next_value] == LOCATION_UNKNOWN)
-		{
+	CGraph aGraph { distanceMatrix, labels };
 
-			//////////////////////////////////////////////////////////////////////////////////
-			// Keep track of shortest distance and path and start vertex
 
-			int start_vertex;
-			double shortest_distance = LONG_MAX;
-			std::vector<int> shortest_path;
-			bool end_straight = false;
+	/////////////////////////////////////////////////////////////////////
+	// Table of travel between the exit (site 0) and the rooms with blocks
+	// (site i + 1 is block_rooms[i]), for the mission planner. This is also
+	// done once, so replanning after each photograph is quick.
 
-			//////////////////////////////////////////////////////////////////////
-			// Get current room type and the vertex labels of adjacent vertices.
+	const std::vector<int> block_rooms = rooms_with_a_block;
+	std::vector<std::vector<int>> site_vertices = { { start_vertex } };
+	for (unsigned int i = 0; i < block_rooms.size(); i++)
+	{
+		std::vector<int> existingVerticesOfRoom = aMap.GetRoomVertices(aMap.GetRoomType(block_rooms[i]));
+		std::vector<int> room_vertices = aMap.CalculateRoomVertices(block_rooms[i]);
 
-			ERoom start_room_type = aMap.GetRoomType(current_room);
-			std::vector<int> verticesOfStartRoom = aMap.CalculateRoomVertices(current_room);
+		site_vertices.push_back({});
+		for (int j = 0; j < 4; j++)
+		{
+			if (existingVerticesOfRoom[j] == 1) site_vertices.back().push_back(room_vertices[j]);
+		}
+	}
 
+	CMissionPlanner aPlanner { CMissionPlanner::SiteCosts(aGraph, site_vertices) };
 
-			/////////////////////////////////////////////////////////////////////////////
-			// Check which of these vertices exist.
+	
+	while(next_value <=5)
+	{
+		/////////////////////////////////////////////////////////////////////////////////////////////////
+		// Choose the room to go to next. If we know where the block is we go straight there, otherwise
+		// we go to the first room of the probe order which minimises the expected travel.
 
-			std::vector<int> existingVerticesOfStartRoom;
-			existingVerticesOfStartRoom = aMap.GetRoomVertices(start_room_type);
-			
+		int target_room;
 
-			//////////////////////////////////////////////////////////////////////////////
-			// For each vertex of the current room check shorteset path to each
-			for(int k=0; k<4; k++)
+		if(block_location[next_value] != LOCATION_UNKNOWN)
+		{
+			target_room = block_location[next_value];
+		}
+		else
+		{
+			if(unknown_block_rooms.empty())
 			{
-				/////////////////////////////////////////////////////////////////////////
-				// Vertex doesn't exist move on 
-
-				if(existingVerticesOfStartRoom[k] == 0) continue;
-
-				/////////////////////////////////////////////////////////////////////////
-				// Otherwise consider this vertex.
+				// Every block has been seen and the one we want was not among them.
+				CSignals::Error();
+				break;
+			}
 
-				int current_vertex = verticesOfStartRoom[k];
+			int current_site = CMissionPlanner::EXIT_SITE;
+			std::vector<int> candidate_sites;
+			for(unsigned int i=0; i<block_rooms.size(); i++)
+			{
+				if(block_rooms[i] == current_room) current_site = i + 1;
+				if(std::find(unknown_block_rooms.begin(), unknown_block_rooms.end(), block_rooms[i]) != unknown_block_rooms.end())
+					candidate_sites.push_back(i + 1);
+			}
 
-				//////////////////////////////////////////////////////////////////////////////////////////////
-				// Look at all blocks which havent been visited yet.
+			SProbePlan aPlan = aPlanner.PlanProbes(current_site, candidate_sites);
+			DEBUG_VALUE_OF(aPlan.m_expectedCost);
 
-				for(unsigned int i=0; i<unknown_block_rooms.size(); i++)
-				{			
-					//////////////////////////////////////////////////////////////////////////////////////////
-					// Find which of these vertices exist and their labels
-					
-					ERoom room_type = aMap.GetRoomType(unknown_block_rooms[i]);
-					std::vector<int> verticesOfStartRoom = aMap.CalculateRoomVertices(unknown_block_rooms[i]);
+			target_room = block_rooms[aPlan.m_order[0] - 1];
+		}
 
-					//////////////////////////////////////////////////////////////////////////////////////////
-					// Check which of these vertices exist.
+		/////////////////////////////////////////////////////////////////////////////////////////////
+		// Keep track of shortest distance and path and start vertex
 
-					std::vector<int> existingVerticesOfRoom;
-					existingVerticesOfRoom = aMap.GetRoomVertices(room_type);
-					std::vector<int> room_vertices = aMap.CalculateRoomVertices(unknown_block_rooms[i]);
+		std::vector<int> planned_path;
+		double shortest_distance = LONG_MAX;
+		bool end_straight = false;
 
-					for(int j=0; j<4; j++)
-					{
-						if(existingVerticesOfRoom[j] == 0) continue;
+		/////////////////////////////////////////////////////////////////////////////////////////////
+		// Get current room type and the vertex labels of adjacent vertices.
 
-						std::vector<int> current_shortest_path;
-						double current_shortest_distance = aGraph.ShortestDistance(current_vertex, room_vertices[j], current_shortest_path);
+		ERoom start_room_type = aMap.GetRoomType(current_room);
+		std::vector<int> verticesOfStartRoom = aMap.CalculateRoomVertices(current_room);
 
-						int size = current_shortest_path.size();
-						CInstructions aInstructions = CInstructions({current_shortest_path[size -2], current_shortest_path[size -1]}, 10);
-						std::vector<EInstruction> instruction = aInstructions.GetInstructions();
+		////////////////////////////////////////////////////////////////////////////////////////////
+		// Check which of these vertices exist for the start room.
 
-						bool replace = false;
+		std::vector<int> existingVerticesOfStartRoom;
+		existingVerticesOfStartRoom = aMap.GetRoomVertices(start_room_type);
 
-						if(current_shortest_distance < shortest_distance)
-						{
-							if(!end_straight) replace = true;
-							else if(instruction[0] == EInstruction_Straight) replace = true;
-						}
-						else if(!end_straight && (instruction[0] == EInstruction_Straight)) replace = true;
 
-						if(replace)
-						{
-							shortest_distance = current_shortest_distance;
-							shortest_path = current_shortest_path;
-							start_vertex = current_vertex;
-						}
-					}
-				}
-			}
+		///////////////////////////////////////////////////////////////////////////////////////
+		// For each vertex of the current room check shortest path to vertex of room containing
+		// the target block.
 
-			planned_path = shortest_path;
-		}
-		else
+		for(int k=0; k<4; k++)
 		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// We know where we want to go next.
-
-			int target_room = block_location[next_value];
-
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Keep track of shortest distance and path and start vertex
-
-			int start_vertex;
-			double shortest_distance = LONG_MAX;
-			std::vector<int> shortest_path;
-			bool end_straight = false;
 
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Get current room type and the vertex labels of adjacent vertices.
+			/////////////////////////////////////////////////////////////////////////
+			// Vertex doesn't exist move on 
+			if(existingVerticesOfStartRoom[k] != 1) continue;
 
-			ERoom start_room_type = aMap.GetRoomType(current_room);
-			std::vector<int> verticesOfStartRoom = aMap.CalculateRoomVertices(current_room);
-
-			////////////////////////////////////////////////////////////////////////////////////////////
-			// Check which of these vertices exist for the start room.
-
-			std::vector<int> existingVerticesOfStartRoom;
-			existingVerticesOfStartRoom = aMap.GetRoomVertices(start_room_type);
+			int current_vertex = verticesOfStartRoom[k];
+		
+			ERoom room_type = aMap.GetRoomType(target_room);
 
+			/////////////////////////////////////////////////////////////////////////////
+			// Check which of these vertices exist.
 
-			///////////////////////////////////////////////////////////////////////////////////////
-			// For each vertex of the current room check shortest path to vertex of room containing
-			// the target block.
+			std::vector<int> existingVerticesOfRoom;
+			existingVerticesOfRoom = aMap.GetRoomVertices(room_type);
+			std::vector<int> room_vertices = aMap.CalculateRoomVertices(target_room);
 
-			for(int k=0; k<4; k++)
+			for(int j=0; j<4; j++)
 			{
+				//////////////////////////////////////////////////////////////////////////////
+				// Vertex doesnt exist
+
+				if(existingVerticesOfRoom[j] != 1) continue;
 
-				/////////////////////////////////////////////////////////////////////////
-				// Vertex doesn't exist move on 
-				if(existingVerticesOfStartRoom[k] == 0) continue;
+				std::vector<int> current_shortest_path;
+				double current_shortest_distance = aGraph.ShortestDistance(current_vertex, room_vertices[j], current_shortest_path);
+				if(current_shortest_path.size() < 2) continue;
 
-				int current_vertex = verticesOfStartRoom[k];
-			
-				ERoom room_type = aMap.GetRoomType(target_room);
-				std::vector<int> verticesOfStartRoom = aMap.CalculateRoomVertices(target_room);
+				int size = current_shortest_path.size();
+				CInstructions aInstructions = CInstructions({current_shortest_path[size -2], current_shortest_path[size -1]}, aMap.GetRoomWidth());
+				std::vector<EInstruction> instruction = aInstructions.GetInstructions();
 
 				/////////////////////////////////////////////////////////////////////////////
-				// Check which of these vertices exist.
+				// Take the shortest path. Between paths of the same length, prefer one which
+				// goes straight into the room, so the robot is lined up with the block.
 
-				std::vector<int> existingVerticesOfRoom;
-				existingVerticesOfRoom = aMap.GetRoomVertices(room_type);
-				std::vector<int> room_vertices = aMap.CalculateRoomVertices(target_room);
+				bool straight = (instruction[0] == EInstruction_Straight);
+				bool replace = (current_shortest_distance < shortest_distance)
+						|| (current_shortest_distance == shortest_distance && straight && !end_straight);
 
-				for(int j=0; j<4; j++)
+				if(replace)
 				{
-					//////////////////////////////////////////////////////////////////////////////
-					// Vertex doesnt exist
-
-					if(existingVerticesOfRoom[j] == 0) continue;
-
-					std::vector<int> current_shortest_path;
-					double current_shortest_distance = aGraph.ShortestDistance(current_vertex, room_vertices[j], current_shortest_path);
-					
-					int size = current_shortest_path.size();
-					CInstructions aInstructions = CInstructions({current_shortest_path[size -2], current_shortest_path[size -1]}, 10);
-					std::vector<EInstruction> instruction = aInstructions.GetInstructions();
-
-					bool replace = false;
-
-					if(current_shortest_distance < shortest_distance)
-					{
-						if(!end_straight) replace = true;
-						else if(instruction[0] == EInstruction_Straight) replace = true;
-					}
-					else if(!end_straight && (instruction[0] == EInstruction_Straight)) replace = true;
-
-					if(replace)
-					{
-						shortest_distance = current_shortest_distance;
-						shortest_path = current_shortest_path;
-						start_vertex = current_vertex;
-					}
+					shortest_distance = current_shortest_distance;
+					planned_path = current_shortest_path;
+					end_straight = straight;
 				}
-
 			}
 
-			planned_path = shortest_path;
+		}
 
+		if(planned_path.size() < 2)
+		{
+			// The room cannot be reached.
+			CSignals::Error();
+			break;
 		}
 
+		// Note the route, so a recorded run can be checked when it is replayed.
+		std::string decision = "Block " + std::to_string(next_value) + ": room " + std::to_string(target_room) + ", path";
+		for(unsigned int i=0; i<planned_path.size(); i++) decision += " " + std::to_string(planned_path[i]);
+		CTelemetryRecorder::NoteDecision(decision);
+
 		/////////////////////////////////////////////////////////////////////////////////////////////////
 		// Compute macro instructions.
 
-		CInstructions aInstructions = CInstructions(planned_path, 10);
+		CInstructions aInstructions = CInstructions(planned_path, aMap.GetRoomWidth());
 
 		//////////////////////////////////////////////////////////////////////////////////////////////
-		// Now we know our route, execute it
-
+		// Now we know our route, hand it to the motion thread. The block is photographed at the end
+		// of it, and we only wait for the photograph once the route back has been planned. If a leg
+		// fails, the executor drops the commands after it and the failure is thrown here by the next
+		// Submit or wait, so the robot never drives on from the wrong place.
 
-		aMap.FollowInstructionsNotLast(aInstructions);
+		aExecutor.Submit([&aMap, aInstructions]() mutable {
+			aMap.FollowInstructionsNotLast(aInstructions);
+			CGoodsOut::Stop();
+		});
+		std::future<int> aBlockNumber = aExecutor.Submit(CManouvre::ApproachAndPhotographBlock);
 
+		//////////////////////////////////////////////////////////////////////////////////////////////
+		// While the robot drives, compute the route back to the start in case this is the block we
+		// want. After reversing out of the room the robot is back at the last vertex before the block.
 
-	
-	CGoodsOut::Stop();
+		std::vector<int> return_path;
+		aGraph.ShortestDistance(planned_path[planned_path.size() - 2], start_vertex, return_path);
 
-	int current_block_number = CManouvre::ApproachAndPhotographBlock();
+	int current_block_number = aBlockNumber.get();
+	current_room = target_room;
 
 	//////////////////////////////////////////////////////////////////////////////////////////////////
 	// Update the location vectors
-	//***************************************************
-	block_location[next_value] = current_block_number;
-
-
 
-	if((current_block_number != next_value) && (block_location[next_value] != LOCATION_UNKNOWN))
+	if((current_block_number != next_value) && (block_location[next_value] == target_room))
 	{
 		////////////////////////////////////////////////////////////////////////////////////////
 		// We have found a block we were not expecting. Reset all blocks that have not been removed
 		// to unknown.
 
 		unknown_block_rooms = rooms_with_a_block;
+		block_location.assign(6, LOCATION_UNKNOWN);
 	}
 
-	for(size_t i=0; i<unknown_block_rooms.size(); i++)
-	{
-		/////////////////////////////////////////////////////////////////////////////////////////////
-		// Remove the current room from the list of unknown rooms as we have just discovered which 
-		// block is there.
-		if(unknown_block_rooms[i] == current_room)
-		{
-			unknown_block_rooms.erase(unknown_block_rooms.begin() + i);
-		}
-	}
-	
-	for(size_t i=0; i<unknown_block_rooms.size(); i++)
-	{
-		/////////////////////////////////////////////////////////////////////////////////////////////
-		// Remove the current room from the list of unknown rooms as we have just discovered which 
-		// block is there.
-		if(unknown_block_rooms[i] == current_room)
-		{
-			unknown_block_rooms.erase(unknown_block_rooms.begin() + i);
-		}
-	}
+	if(current_block_number >= 1 && current_block_number <= 5) block_location[current_block_number] = target_room;
+
+	/////////////////////////////////////////////////////////////////////////////////////////////
+	// Remove the current room from the list of unknown rooms as we have just discovered which 
+	// block is there.
+
+	unknown_block_rooms.erase(std::remove(unknown_block_rooms.begin(), unknown_block_rooms.end(), current_room), unknown_block_rooms.end());
 
 
 	///////////////////////////////////////////////////////////////////////////////////////
-	// If the block is not the one we are currently interested continue.
+	// If the block is not the one we are currently interested continue. The next leg is
+	// planned while the robot backs out.
 
 	if(current_block_number != next_value)
 	{
-		CManouvre::ReverseAndUTurn();
-	CSignals::Notification2();
+		aExecutor.Submit([] {
+			CManouvre::ReverseAndUTurn();
+			CSignals::Notification2();
+		});
 		continue;
 	}
 
 
 	////////////////////////////////////////////////////////////////////////////////////
-	// We are interested in this block collect it.
+	// We are interested in this block: collect it, take it back to the start along the route
+	// computed above and release it. This is all queued for the motion thread, so the next leg is
+	// planned while it is carried out.
 
-	CSignals::Notification3();
+	CInstructions aReturnInstructions = CInstructions(return_path, aMap.GetRoomWidth());
 
-	CManouvre::CollectBlock();
+	aExecutor.Submit([&aMap, aReturnInstructions]() mutable {
+		CSignals::Notification3();
 
-	CManouvre::ReverseAndUTurn();
+		CManouvre::CollectBlock();
 
-	///////////////////////////////////////////////////////////////////////////////////
-	// Compute shortest path to start.
+		CManouvre::ReverseAndUTurn();
 
-	std::vector<int> shortest_path;
-	aGraph.ShortestDistance(aMap.GetCurrentVertex(), start_vertex, shortest_path);
+		aMap.FollowInstructions(aReturnInstructions);
 
-	/////////////////////////////////////////////////////////////////////////////////////////////////
-	// Compute macro instructions.
+		///////////////////////////////////////////////////////////////////////////////////
+		// Exit map and release block.
 
-	aInstructions = CInstructions(planned_path, 10);
+		CManouvre::ExitMap();
 
-	//////////////////////////////////////////////////////////////////////////////////////////////
-	// Now we know our route, execute it
+		CManouvre::ReleaseBlock();
 
-	aMap.FollowInstructions(aInstructions);
+		CManouvre::ReverseAndUTurn();
+	});
 
-	////////////////////////////////////////////////////////////////////////////////////////////
-	// Exit map and release block.
+	////////////////////////////////////////////////////////////////////////////////////
+	// The block has gone, and we are back at the entrance.
 
-	CManouvre::ExitMap();
+	rooms_with_a_block.erase(std::remove(rooms_with_a_block.begin(), rooms_with_a_block.end(), target_room), rooms_with_a_block.end());
+	block_location[next_value] = LOCATION_UNKNOWN;
+	current_room = aMap.GetEntranceRoom();
+	next_value++;
+	}
 
-	CManouvre::ReleaseBlock();
+	//////////////////////////////////////////////////////////////////////////////////////////////
+	// Wait for the robot to finish.
 
-	CManouvre::ReverseAndUTurn();
-	}
+	aExecutor.WaitUntilIdle();
 
 	CSignals::Complete();
 }
@@ -8,16 +8,23 @@ namespace bornander
 {
 	namespace debug
 	{
-		int log::indentation = 0;
+		thread_local int log::indentation = 0;
 		std::ostream* log::stream = &std::cout;
+		std::mutex log::stream_mutex;
+		thread_local bool log::muted = false;
 
 		log::log(const std::string& ctx)
 			: context(ctx)
+			, silent(muted)
 #ifdef DEBUG_LOG_ENABLE_TIMING
-			, start_time(clock())
+			, start_time(silent ? 0 : clock())
 #endif
 		{
+			if (silent)
+				return;
+
 #ifdef DEBUG_SHOW_FUNCTIONS_ENABLE
+			std::lock_guard<std::mutex> lock(stream_mutex);
 			write_indentation();
 			*stream << "--> " << context << std::endl;
 			++indentation;
@@ -27,6 +34,10 @@ namespace bornander
 
 		log::~log()
 		{
+			if (silent)
+				return;
+
+			std::lock_guard<std::mutex> lock(stream_mutex);
 #ifdef  DEBUG_SHOW_FUNCTIONS_ENABLE
 			--indentation;
 			write_indentation(std::uncaught_exception() ? '*' : ' ');
@@ -44,6 +55,11 @@ namespace bornander
 			log::stream = &stream;
 		}
 
+		void log::set_thread_muted(bool mute)
+		{
+			log::muted = mute;
+		}
+
 
 		void log::write_indentation()
 		{
@@ -61,6 +77,10 @@ namespace bornander
 
 		void log::message(const std::string& message)
 		{
+			if (muted)
+				return;
+
+			std::lock_guard<std::mutex> lock(stream_mutex);
 			write_indentation();
 			*stream << message << std::endl;
 			stream->flush();
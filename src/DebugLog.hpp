@@ -22,6 +22,7 @@
 #define DEBUG_USING_NAMESPACE
 
 #define DEBUG_SET_STREAM(stream) 
+#define DEBUG_MUTE_THREAD(mute)
 #define DEBUG_METHOD() 
 #define DEBUG_MESSAGE(debug_message)
 #define DEBUG_VALUE_OF(variable)
@@ -52,10 +53,12 @@
 #ifdef DEBUG_LOG_ENABLE_TIMING
 #include <time.h>	
 #endif
+#include <mutex>
 
 #define DEBUG_USING_NAMESPACE using namespace bornander::debug;
 
 #define DEBUG_SET_STREAM(stream) { bornander:debug::log::set_stream(stream); }
+#define DEBUG_MUTE_THREAD(mute) { bornander::debug::log::set_thread_muted(mute); }
 #define DEBUG_METHOD() bornander::debug::log _debugLog(__FUNCTION__);
 #define DEBUG_MESSAGE(debug_message) { _debugLog.message(debug_message); }
 #define DEBUG_VALUE_OF(variable) { _debugLog.value_of(#variable, variable, false); }
@@ -126,10 +129,13 @@ namespace bornander
 		class log
 		{
 		private:	// Members
-			static int indentation;
+			static thread_local int indentation;	// Per thread, so that threads don't mess up each other's nesting
 			static std::ostream* stream;
+			static std::mutex stream_mutex;			// Serialises writes from different threads
+			static thread_local bool muted;			// Per thread, so that e.g. simulator workers can run without logging
 
 			const std::string context;
+			const bool silent;						// Whether the thread was muted when this log was created
 
 #ifdef DEBUG_LOG_ENABLE_TIMING
 			const clock_t start_time;
@@ -144,6 +150,7 @@ namespace bornander
 			template<class T> void value_of_collection(const std::string& name, const T& collection, const typename T::size_type max, const list_segment segment, const bool outputTypeInformation);
 
 			static void set_stream(std::ostream& stream);
+			static void set_thread_muted(bool mute);
 		public:		// Constructor, Destructor
 			log(const std::string& context);
 			~log();
@@ -151,6 +158,10 @@ namespace bornander
 
 		template<class T> void log::value_of(const std::string& name, const T& value, const bool outputTypeInformation)
 		{
+			if (muted)
+				return;
+
+			std::lock_guard<std::mutex> lock(stream_mutex);
 			write_indentation();
 			*stream << name;
 #ifdef DEBUG_LOG_ENABLE_TYPE_OUTPUT
@@ -166,6 +177,9 @@ namespace bornander
 
 		template<class T> void log::value_of_collection(const std::string& name, const T& collection, const typename T::size_type max, const list_segment segment, const bool outputTypeInformation)
 		{
+			if (muted)
+				return;
+
 			const typename T::size_type limit = max != 0 ? std::min<T::size_type>(max, collection.size()) : collection.size();
 			
 			typename T::size_type startIndex = 0;
@@ -182,6 +196,7 @@ namespace bornander
 
 			const typename T::size_type endIndex = startIndex + limit;
 
+			std::lock_guard<std::mutex> lock(stream_mutex);
 			write_indentation();
 			*stream << "collection(" << name; 
 #ifdef DEBUG_LOG_ENABLE_TYPE_OUTPUT
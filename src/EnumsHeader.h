@@ -59,6 +59,13 @@ enum EOrientation
 	EOrientation_West
 };
 
+enum EMotion
+{
+	EMotion_Forward,
+	EMotion_TurnLeft90,
+	EMotion_TurnRight90
+};
+
 
 
 #endif /* SRC_ENUMS_H_ */
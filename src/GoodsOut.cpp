@@ -11,45 +11,65 @@
 #include "DebugLog.hpp"
 #include "pi_spi.h"
 #include "pic_enums.h"
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <thread>
 
-void CGoodsOut::Forward(double distance, bool watch_sensors)
+//The distance of a motion command in encoder counts, which must fit in one word: longer moves
+//(e.g. following the line 'forever') go as far as the PIC can be told
+static uint16_t CommandCounts(double distance)
 {
-	DEBUG_METHOD();
+	unsigned int counts = CGoodsOut::DistanceToCounts(distance);
+	return (counts > UINT16_MAX) ? UINT16_MAX : static_cast<uint16_t>(counts);
+}
 
-	//Set distance to number of counts (each count = 6mm <> divide by 6)
-	distance = distance / 6;
+//Convert a distance (mm) to the nearest whole number of encoder counts. Everything which tells the
+//PIC a distance (the motion commands here and route programs) converts it this way, so that the
+//same move is driven the same distance however it is sent.
+unsigned int CGoodsOut::DistanceToCounts(double distance)
+{
+	double counts = distance / DISTANCE_PER_COUNT;
+	if(counts <= 0) return 0;
+	if(counts >= UINT_MAX) return UINT_MAX;
 
-	//move forwards - blocking functions for distance
-	if(watch_sensors) pic_write_state(ECDR_FORWARD, DISTANCE, (uint16_t) distance, 1);
-	else pic_write_state(PSNS_FORWARD, DISTANCE, (uint16_t) distance, 1);
+	return static_cast<unsigned int>(std::lround(counts));
 }
 
-void CGoodsOut::Reverse(double distance, bool watch_sensors)
+//With stall the functions return once the motion has finished. Without, they return at once and
+//the motion is queued on the PIC behind any others; WaitMotionDone waits for the oldest to finish.
+void CGoodsOut::Forward(double distance, bool watch_sensors, bool stall)
 {
 	DEBUG_METHOD();
 
-	//Set distance to number of counts (each count = 6mm <> divide by 6)
-	distance = distance / 6;
+	//move forwards - blocking functions for distance
+	if(watch_sensors) pic_write_state(ECDR_FORWARD, DISTANCE, CommandCounts(distance), stall);
+	else pic_write_state(PSNS_FORWARD, DISTANCE, CommandCounts(distance), stall);
+}
+
+void CGoodsOut::Reverse(double distance, bool watch_sensors, bool stall)
+{
+	DEBUG_METHOD();
 
 	//move forwards - blocking functions for distance
-	if(watch_sensors) pic_write_state(ECDR_REVERSE, DISTANCE, (uint16_t) distance, 1);
-	else pic_write_state(PSNS_REVERSE, DISTANCE, (uint16_t) distance, 1);
+	if(watch_sensors) pic_write_state(ECDR_REVERSE, DISTANCE, CommandCounts(distance), stall);
+	else pic_write_state(PSNS_REVERSE, DISTANCE, CommandCounts(distance), stall);
 }
 
-void CGoodsOut::TurnLeft90()
+void CGoodsOut::TurnLeft90(bool stall)
 {
 	DEBUG_METHOD();
 
 	//always 90%
-	pic_write_state(COMP_LEFT, NONE, 0, 1);
+	pic_write_state(COMP_LEFT, NONE, 0, stall);
 }
 
-void CGoodsOut::TurnRight90()
+void CGoodsOut::TurnRight90(bool stall)
 {
 	DEBUG_METHOD();
 
 	//always 90%
-	pic_write_state(COMP_RIGHT, NONE, 0, 1);
+	pic_write_state(COMP_RIGHT, NONE, 0, stall);
 }
 
 void CGoodsOut::Stop()
@@ -60,6 +80,83 @@ void CGoodsOut::Stop()
 	pic_write_state(STOPPED, NONE, 0, 0);
 }
 
+//Wait for the DONE of the oldest motion sent without stalling
+void CGoodsOut::WaitMotionDone()
+{
+	DEBUG_METHOD();
+
+	Wait_Done();
+}
+
+//The Async functions send the motion without stalling, as above, and return a handle which says
+//when it has finished (see CMotionPoller), so the caller can get on with something else meanwhile.
+//Their DONEs are collected by the poller, so don't use WaitMotionDone for them.
+CMotionHandle CGoodsOut::ForwardAsync(double distance, bool watch_sensors)
+{
+	DEBUG_METHOD();
+
+	return CMotionPoller::Default().Send(watch_sensors ? ECDR_FORWARD : PSNS_FORWARD, DISTANCE, CommandCounts(distance));
+}
+
+CMotionHandle CGoodsOut::ReverseAsync(double distance, bool watch_sensors)
+{
+	DEBUG_METHOD();
+
+	return CMotionPoller::Default().Send(watch_sensors ? ECDR_REVERSE : PSNS_REVERSE, DISTANCE, CommandCounts(distance));
+}
+
+CMotionHandle CGoodsOut::TurnLeft90Async()
+{
+	DEBUG_METHOD();
+
+	return CMotionPoller::Default().Send(COMP_LEFT, NONE, 0);
+}
+
+CMotionHandle CGoodsOut::TurnRight90Async()
+{
+	DEBUG_METHOD();
+
+	return CMotionPoller::Default().Send(COMP_RIGHT, NONE, 0);
+}
+
+//Stop at once, throwing away every motion sent without stalling which has not finished
+void CGoodsOut::FlushMotions()
+{
+	DEBUG_METHOD();
+
+	pic_flush_motions();
+}
+
+//Send a whole route program (see CRouteProgram) to the PIC, then poll its progress until it
+//finishes. progress is called after each poll with the number of route words completed; if it
+//returns false the route is aborted. Returns how the route ended.
+route_status_t CGoodsOut::RunRoute(const std::vector<uint16_t>& program,
+		const std::function<bool(unsigned int completed, unsigned int total)>& progress,
+		unsigned int poll_interval_ms)
+{
+	DEBUG_METHOD();
+
+	if(!pic_write_route(program.data(), (uint16_t) program.size())) return ROUTE_REJECTED;
+
+	uint16_t completed = 0;
+	route_status_t status = pic_read_route_progress(&completed);
+	while(status == ROUTE_RUNNING)
+	{
+		if(progress && !progress(completed, program.size()))
+		{
+			pic_abort_route();
+			return pic_read_route_progress(&completed);
+		}
+
+		if(poll_interval_ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(poll_interval_ms));
+		status = pic_read_route_progress(&completed);
+	}
+
+	if(progress) progress(completed, program.size());
+
+	return status;
+}
+
 ERoom CGoodsOut::GetCurrentRoomType()
 {
 	DEBUG_METHOD();
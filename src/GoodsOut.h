@@ -14,19 +14,38 @@
 
 //~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+#include "CMotionPoller.h"
 #include "EnumsHeader.h"
+#include "pic_enums.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 
 //~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 class CGoodsOut
 {
+	// === Constants ================================================================================
+public:
+	static constexpr double DISTANCE_PER_COUNT = 6;		// mm per encoder count
+
 	// === Public Functions =========================================================================
 public:
-	static void Forward(double distance, bool watch_sensors);
-	static void Reverse(double distance, bool watch_sensors);
-	static void TurnLeft90();
-	static void TurnRight90();
+	static unsigned int DistanceToCounts(double distance);
+	static void Forward(double distance, bool watch_sensors, bool stall = true);
+	static void Reverse(double distance, bool watch_sensors, bool stall = true);
+	static void TurnLeft90(bool stall = true);
+	static void TurnRight90(bool stall = true);
 	static void Stop();
+	static void WaitMotionDone();
+	static CMotionHandle ForwardAsync(double distance, bool watch_sensors);
+	static CMotionHandle ReverseAsync(double distance, bool watch_sensors);
+	static CMotionHandle TurnLeft90Async();
+	static CMotionHandle TurnRight90Async();
+	static void FlushMotions();
+	static route_status_t RunRoute(const std::vector<uint16_t>& program,
+			const std::function<bool(unsigned int completed, unsigned int total)>& progress = nullptr,
+			unsigned int poll_interval_ms = 10);
 
 	static ERoom GetCurrentRoomType();
 
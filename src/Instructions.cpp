@@ -11,7 +11,6 @@
 #include<fstream>
 #include<vector>
 #include<string>
-#include<math.h>
 #include "Instructions.h"
 #include "DebugLog.hpp"
 
@@ -20,281 +19,148 @@
 using namespace std;
 
 
+// ~~~ DEFINITIONS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The move through a room which is entered through one side and left through another. The robot
+// faces away from the side it enters through and towards the side it leaves through. Leaving
+// through the side we entered is not a move (EInstruction_LAST).
+struct SRoomMove
+{
+	EInstruction instruction;
+	EOrientation entryOrientation;
+	EOrientation exitOrientation;
+};
+
+static constexpr SRoomMove ROOM_MOVES[4][4] =
+{
+	// Entering through the North side, heading South
+	{
+		{ EInstruction_LAST, EOrientation_South, EOrientation_North },
+		{ EInstruction_TurnLeft, EOrientation_South, EOrientation_East },
+		{ EInstruction_Straight, EOrientation_South, EOrientation_South },
+		{ EInstruction_TurnRight, EOrientation_South, EOrientation_West }
+	},
+	// Entering through the East side, heading West
+	{
+		{ EInstruction_TurnRight, EOrientation_West, EOrientation_North },
+		{ EInstruction_LAST, EOrientation_West, EOrientation_East },
+		{ EInstruction_TurnLeft, EOrientation_West, EOrientation_South },
+		{ EInstruction_Straight, EOrientation_West, EOrientation_West }
+	},
+	// Entering through the South side, heading North
+	{
+		{ EInstruction_Straight, EOrientation_North, EOrientation_North },
+		{ EInstruction_TurnRight, EOrientation_North, EOrientation_East },
+		{ EInstruction_LAST, EOrientation_North, EOrientation_South },
+		{ EInstruction_TurnLeft, EOrientation_North, EOrientation_West }
+	},
+	// Entering through the West side, heading East
+	{
+		{ EInstruction_TurnLeft, EOrientation_East, EOrientation_North },
+		{ EInstruction_Straight, EOrientation_East, EOrientation_East },
+		{ EInstruction_TurnRight, EOrientation_East, EOrientation_South },
+		{ EInstruction_LAST, EOrientation_East, EOrientation_West }
+	}
+};
+
+
 // ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // This function is a constructor for the CInstructor Class. It takes a reference to the raw input data
-// and from this creates an instance of the class.
+// and from this creates an instance of the class. map_width is the width of the map in rooms.
+// Exception_InvalidRoute is thrown if two consecutive vertices are not on the walls of one room.
+//
+// The geometry tables are built for just enough rows to cover the route. Callers converting many
+// routes on the same map should build a CMazeGeometry once and use the other constructor.
 
 CInstructions::CInstructions(const std::vector<int> &vertexList, const int map_width)
 {
 	DEBUG_METHOD();
 
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// This vector contains the list of rooms that will be moved through during each instruction.
-
-	m_roomList.clear();
-	m_roomList.reserve(vertexList.size()-1);
-
-
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// This vector contains the list of the orientation of the robot BETWEEN each instruction.
-	// Note this has one more entry than the instruction list.
-
-	m_orientationBetweenInstructions.clear();
-	m_orientationBetweenInstructions.reserve(vertexList.size());
-	EOrientation current_orientation;
-
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// This vector contains the instructions to move between vertices.
-	m_instructions.resize(vertexList.size()-1);
-
-
-
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// The difference between the first two vertex labels tells us the orientation the robot should be
-	// in at the start to be facing the correct way.
-	int num_diff = vertexList[1] - vertexList[0];
-	double level_check = vertexList[0]/2*map_width;
-	
-	if(num_diff == 1)
-	{ 
-		///////////////////////////////////////////////////////////////////////////////////////////////////
-		// If the difference is 1 there are two options moving from West to North (going East) or North to East
-		// (going South) we can distinguish between the two by checking if the the first is even.
-
-		if((static_cast<int>(floor(level_check)) %2) == vertexList[0] % 2) current_orientation = EOrientation_East;
-		else current_orientation = EOrientation_South;
-	}
-	else if(num_diff == -1)
+	int max_vertex = 0;
+	for(size_t i=0; i<vertexList.size(); i++)
 	{
-		///////////////////////////////////////////////////////////////////////////////////////////////////
-		// If the difference is -1 there are two options are opposite moving from North to West 
-		// (South) or East to North (West) we can distinguish between the two by checking if the the first is even.
-
-		if((static_cast<int>(floor(level_check)) %2) == vertexList[0] % 2) current_orientation = EOrientation_West;
-		else current_orientation = EOrientation_South;
+		if(vertexList[i] > max_vertex) max_vertex = vertexList[i];
 	}
-	
-	///////////////////////////////////////////////////////////////////////////////////////////////////
-	// The other orientations are calculated in a similar manner. 
-	
-	else if(num_diff ==  2)					current_orientation = EOrientation_East;
-
-	else if(num_diff == -2)					current_orientation = EOrientation_West;
 
-	else if(num_diff ==  2*(map_width +1))	current_orientation = EOrientation_South;
-
-	else if(num_diff == -2*(map_width+1))	current_orientation = EOrientation_North;
-
-	else if(num_diff == 2*map_width)		current_orientation = EOrientation_West;
+	Compile(vertexList, CMazeGeometry(max_vertex/(2*map_width + 1) + 1, map_width));
+}
 
-	else if(num_diff ==  2*map_width)		current_orientation = EOrientation_North;
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function is a constructor for the CInstructor Class, using the precomputed geometry of the map.
 
-	else if(num_diff ==  2*map_width +2)	current_orientation = EOrientation_East;
+CInstructions::CInstructions(const std::vector<int> &vertexList, const CMazeGeometry &geometry)
+{
+	DEBUG_METHOD();
 
-	else if(num_diff ==  -(2*map_width +2))	current_orientation = EOrientation_North;
+	Compile(vertexList, geometry);
+}
 
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function converts a route to instructions in one pass, one DecodeStep per pair of
+// consecutive vertices.
 
-	/////////////////////////////////////////////////////////////////////////////////////////////
-	// Populate orientation vector with start orientation.
-	m_orientationBetweenInstructions[0] = current_orientation;
+void CInstructions::Compile(const std::vector<int> &vertexList, const CMazeGeometry &geometry)
+{
+	DEBUG_METHOD();
 
+	m_roomList.clear();
+	m_orientationBetweenInstructions.clear();
+	m_instructions.clear();
 
-	///////////////////////////////////////////////////////////////////////////////////////////////
-	// Similarly to the way we worked out the initial orientation we can compare the vertex labels
-	// of the vertices we enter and leave the room through. Because we have a specific labelling
-	// system the difference between the two labels give us there position relative to each other.
+	if (vertexList.size() < 2) return;
 
+	///////////////////////////////////////////////////////////////////////////////////////////////////
+	// The list of rooms that will be moved through during each instruction, the instructions, and
+	// the orientation of the robot BETWEEN each instruction. Note the last has one more entry than
+	// the instruction list.
 
-	//					i(2n+1) +2j +1
-	//					 _ _ _
-	//					|_ _ _|
-	//		i(2n+1) +2j	|_ _ _|		i(2n+1) + 2j + 2
-	//					|_ _ _|
-	//
-	//					(i+1)(2n+1) + 2j + 1
-	//
+	m_roomList.resize(vertexList.size()-1);
+	m_instructions.resize(vertexList.size()-1);
+	m_orientationBetweenInstructions.resize(vertexList.size());
 
 	for(size_t i=0; i<vertexList.size()-1; i++)
-	{	
-		num_diff = vertexList[i+1] - vertexList[i];
-		EInstruction current_instruction;
-
-		if(num_diff == 1)
-		{	
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Either W to N or N to E, both are left turns
-			current_instruction = EInstruction_TurnLeft;
-			break;
-		}
-		else if(num_diff == -1)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Either N to W or E to N, both are right turns
-			current_instruction = EInstruction_TurnRight;
-			break;
-		}
-		else if(num_diff == 2)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			//  W to E straight.
-			current_instruction = EInstruction_Straight;
-			break;
-		}
-		else if(num_diff == -2)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Either E to W straight
-			current_instruction = EInstruction_Straight;
-			break;
-		}
-		else if(num_diff == 2*(map_width +1))
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// N to S straight
-			current_instruction = EInstruction_Straight;
-			break;
-		}
-		else if(num_diff == -2*(map_width+1))
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// S to N straight
-			current_instruction = EInstruction_Straight;
-			break;
-		}
-		else if(num_diff == 2*map_width)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// E to S turn left
-			current_instruction = EInstruction_TurnLeft;
-			break;
-		}
-		else if(num_diff == 2*map_width)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// S to E turn right
-			current_instruction = EInstruction_TurnRight;
-			break;
-		}
-		else if(num_diff == 2*map_width + 2)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// W to S turn right
-			current_instruction = EInstruction_TurnRight;
-			break;
-		}
-
-		else if(num_diff == -2*map_width - 2)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// S to W turn left
-			current_instruction = EInstruction_TurnLeft;
-			break;
-		}
-		else
-		{
-			///////////////////////////////
-			// TODO throw exception.
-			return;
-		}
-
-		/////////////////////////////////////////////////////////////////////////////////////////////
-		// Compute new orientation
-	
-	
-		if(current_instruction == EInstruction_TurnLeft)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Rotate orientation anti clockwise
-			current_orientation = static_cast<EOrientation>((current_orientation +1) %4);
-		}
-		else if(current_instruction == EInstruction_TurnRight)
-		{
-			/////////////////////////////////////////////////////////////////////////////////////////////
-			// Rotate orientation clockwise
-			current_orientation = static_cast<EOrientation>((current_orientation -1) %4);
-		}
-
-		/////////////////////////////////////////////////////////////////////////////
-		// If the instruction is straight the orientation doesnt change.
-
-		m_orientationBetweenInstructions[i+1] = current_orientation;
-
-
-
-		/////////////////////////////////////////////////////////////////////////////
-		// Compute room the instruction moves through. The easiest way to do this is 
-		// to look at the orientation of the robot as this tells you which vertex it 
-		// relative to the room. (N S E or W) from this we can use the equations above
-		// to find the row and column of the current room.
-		//
-		// The number row is calculating by finding the number of complete rows each
-		// using (2n+1) vertices before this vertex. floor(vertex label/(2n+1))
-		// The column is found by looking the remainder when the complete rows are removed
-		// vertex label mod (2n+1).
-
-		int row_index;
-		int col_index;
+	{
+		SInstructionStep step = DecodeStep(geometry, vertexList[i], vertexList[i+1]);
 
+		m_instructions[i] = step.m_instruction;
+		m_roomList[i] = step.m_room;
+		m_orientationBetweenInstructions[i] = step.m_entryOrientation;
+		m_orientationBetweenInstructions[i+1] = step.m_exitOrientation;
+	}
+}
 
-		//////////////////////////////////////////////////////////////////////////////////////////////
-		// If the remainder after the rows is even we know we are at a vertex on a vertical line i.e. 
-		// an E or W vertex. We can then tell by our orientation which we are at
-		if(static_cast<int>(floor(vertexList[i]/(2*map_width+1)))  %2)
-		{
-			row_index = static_cast<int> (floor(vertexList[i]/(2*map_width+1)));
-
-			if(current_orientation == EOrientation_East)
-			{
-				col_index = static_cast<int> ((vertexList[i] % (2*map_width+1))/2 -1);
-			}
-			else if(current_orientation == EOrientation_West)
-			{
-				col_index = static_cast<int> ((vertexList[i] %(2*map_width+1) -1))/2;	
-			}
-		}
-		else
-		{
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function converts one move, between two consecutive vertices of a route. The geometry gives
+// the room they share and the sides of it they are on, and the instruction and orientations are
+// then looked up in ROOM_MOVES.
 
-			/////////////////////////////////////////////////////////////////////////////////////////
-			// We are on a horizontal vertex e.g. N or S
-
-			if(current_orientation == EOrientation_North)
-			{
-				row_index = static_cast<int>(floor(vertexList[i]/2*map_width));
-				col_index = (vertexList[i] %(2*map_width+1) -1)/2;	
-			}
-			else if(current_orientation == EOrientation_South)
-			{
-				////////////////////////////////////////////////////////////////////////////////
-				// Note here we have a different row calculation.
-
-				row_index = static_cast<int>(floor(vertexList[i]/2*map_width)) -1;
-				col_index = (vertexList[i] %(2*map_width+1) -1)/2;	
-			}
-		}
+SInstructionStep CInstructions::DecodeStep(const CMazeGeometry &geometry, int from_vertex, int to_vertex)
+{
+	int room;
+	EOrientation entry_side, exit_side;
+	if(!geometry.FindMove(from_vertex, to_vertex, room, entry_side, exit_side))
+		throw Exception_InvalidRoute { from_vertex, to_vertex };
 
-		m_roomList[i] = static_cast<ERoom>(row_index*map_width + col_index);
+	const SRoomMove& move = ROOM_MOVES[entry_side][exit_side];
 
-		m_instructions[i] = current_instruction;
-	}
+	return { move.instruction, static_cast<ERoom>(room), move.entryOrientation, move.exitOrientation };
 }
 
 
-vector<EInstruction> CInstructions::GetInstructions()
+const vector<EInstruction>& CInstructions::GetInstructions() const
 {
 	DEBUG_METHOD();
 
 	return m_instructions;
 }
 
-vector<ERoom> CInstructions::GetRoomList()
+const vector<ERoom>& CInstructions::GetRoomList() const
 {
 	DEBUG_METHOD();
 
 	return m_roomList;
 }
 
-vector<EOrientation> CInstructions::GetOrientations()
+const vector<EOrientation>& CInstructions::GetOrientations() const
 {
 	DEBUG_METHOD();
 
@@ -321,3 +187,98 @@ void CInstructions::TruncateAtRoom(int room_index)
 
 
 
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function is a constructor for the CInstructionStream class. The stream starts with no
+// vertices; the geometry must outlive the stream.
+
+CInstructionStream::CInstructionStream(const CMazeGeometry &geometry)
+		: m_geometry(geometry), m_next(0), m_closed(false)
+{
+	DEBUG_METHOD();
+}
+
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// These functions add vertices to the end of the route. Exception_StreamClosed is thrown if the
+// stream has been closed.
+
+void CInstructionStream::Append(int vertex)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if(m_closed) throw Exception_StreamClosed();
+
+		m_vertices.push_back(vertex);
+	}
+	m_extended.notify_all();
+}
+
+void CInstructionStream::Append(const std::vector<int> &vertexList)
+{
+	DEBUG_METHOD();
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if(m_closed) throw Exception_StreamClosed();
+
+		m_vertices.insert(m_vertices.end(), vertexList.begin(), vertexList.end());
+	}
+	m_extended.notify_all();
+}
+
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function marks the end of the route, waking a reader waiting in WaitNext.
+
+void CInstructionStream::Close()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_closed = true;
+	}
+	m_extended.notify_all();
+}
+
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function gives the next instruction, if both of its vertices are known. It returns false if
+// the route needs extending first (or has been finished). Exception_InvalidRoute is thrown as by
+// CInstructions.
+
+bool CInstructionStream::Next(SInstructionStep &step)
+{
+	lock_guard<mutex> lock(m_mutex);
+	if(m_next + 1 >= m_vertices.size()) return false;
+
+	step = CInstructions::DecodeStep(m_geometry, m_vertices[m_next], m_vertices[m_next+1]);
+	m_next++;
+
+	return true;
+}
+
+// ~~~ FUNCTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This function gives the next instruction as Next does, but waits for the route to be extended
+// if it has to. It returns false only once the stream is closed and every instruction has been
+// given.
+
+bool CInstructionStream::WaitNext(SInstructionStep &step)
+{
+	unique_lock<mutex> lock(m_mutex);
+	m_extended.wait(lock, [this]() { return m_closed || m_next + 1 < m_vertices.size(); });
+	if(m_next + 1 >= m_vertices.size()) return false;
+
+	step = CInstructions::DecodeStep(m_geometry, m_vertices[m_next], m_vertices[m_next+1]);
+	m_next++;
+
+	return true;
+}
+
+bool CInstructionStream::HasNext() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_next + 1 < m_vertices.size();
+}
+
+bool CInstructionStream::IsFinished() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_closed && m_next + 1 >= m_vertices.size();
+}
+
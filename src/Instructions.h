@@ -7,8 +7,23 @@
 #ifndef SRC_CINSTRUCTIONS_H_
 #define SRC_CINSTRUCTIONS_H_
 
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
 #include <vector>
 #include "EnumsHeader.h"
+#include "CMazeGeometry.h"
+
+//~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// One instruction of a route: the room it moves through and the orientation of the robot before and
+// after it.
+struct SInstructionStep
+{
+	EInstruction m_instruction;
+	ERoom m_room;
+	EOrientation m_entryOrientation;
+	EOrientation m_exitOrientation;
+};
 
 //~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 class CInstructions
@@ -16,6 +31,7 @@ class CInstructions
 	// === Constructors and Destructors =============================================================
 public:
 	CInstructions(const std::vector<int> &vertexList, const int map_width);
+	CInstructions(const std::vector<int> &vertexList, const CMazeGeometry &geometry);
 	
 	// === Member Variables =========================================================================
 private:
@@ -26,14 +42,74 @@ private:
 
 	// === Public Functions =========================================================================
 public:
-	std::vector<EInstruction>	GetInstructions();
+	const std::vector<EInstruction>& GetInstructions() const;
+
+	const std::vector<ERoom>& GetRoomList() const;
 
-	std::vector<ERoom> GetRoomList();
+	const std::vector<EOrientation>& GetOrientations() const;
 
-	std::vector<EOrientation> GetOrientations();
+	static SInstructionStep DecodeStep(const CMazeGeometry &geometry, int from_vertex, int to_vertex);
 
 	void TruncateAtRoom(int room_index);
 
+	// === Private Functions ========================================================================
+private:
+	void Compile(const std::vector<int> &vertexList, const CMazeGeometry &geometry);
+
+public:
+	// === Exceptions ===============================================================================
+	struct Exception_InvalidRoute
+	{
+		int mm_fromVertex;
+		int mm_toVertex;
+		Exception_InvalidRoute(int fromVertex, int toVertex)
+				: mm_fromVertex { fromVertex }, mm_toVertex { toVertex }
+		{
+		}
+	};
+
+};
+
+
+//~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// This class gives the instructions of a route one at a time, as they are needed, instead of
+// converting the whole route up front as CInstructions does. The route can be extended while it is
+// being read, so the first manouvre can start as soon as the first two vertices are known.
+//
+// The route may be extended on one thread (the planner) while it is read on another (the robot);
+// WaitNext blocks the reader until the next instruction is known or the stream is closed.
+class CInstructionStream
+{
+	// === Constructors and Destructors =============================================================
+public:
+	explicit CInstructionStream(const CMazeGeometry &geometry);
+
+	// === Member Variables =========================================================================
+private:
+	const CMazeGeometry& m_geometry;
+	std::vector<int> m_vertices;
+	std::size_t m_next;			// Index of the vertex the next instruction starts from
+	bool m_closed;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_extended;	// Signalled when vertices are appended or the stream closed
+
+	// === Public Functions =========================================================================
+public:
+	void Append(int vertex);
+	void Append(const std::vector<int> &vertexList);
+	void Close();
+
+	bool Next(SInstructionStep &step);
+	bool WaitNext(SInstructionStep &step);
+
+	// Whether Next will give an instruction, and whether the stream will never give another
+	bool HasNext() const;
+	bool IsFinished() const;
+
+	// === Exceptions ===============================================================================
+	struct Exception_StreamClosed
+	{
+	};
 };
 
 
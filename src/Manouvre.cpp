@@ -12,8 +12,16 @@
 #include "Manouvre.h"
 #include "GoodsOut.h"
 #include "GoodsIn.h"
+#include "CRouteProgram.h"
+#include "CMotionQueue.h"
+#include "CTelemetryRecorder.h"
+#include <chrono>
 #include "DebugLog.hpp"
 
+bool CManouvre::s_uploadRoutes = false;
+unsigned int CManouvre::s_motionLookahead = 0;
+std::vector<SMotion> CManouvre::s_heldMotions;
+
 
 //////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -26,15 +34,230 @@ void CManouvre::InstructionToManouvre(EInstruction instruction_type)
 	case EInstruction_Straight:
 	{
 		CManouvre::StraightAcrossRoom();
+		break;
 	}
 	case EInstruction_TurnLeft:
 	{
 		CManouvre::TurnLeftInRoom();
+		break;
 	}
 	case EInstruction_TurnRight:
 	{
 		CManouvre::TurnRightInRoom();
+		break;
+	}
+	default:
+		break;
 	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Drive a list of instructions. Rather than one manouvre per instruction, the forward moves of
+// consecutive instructions are joined up (see FuseMotions), so that a corridor is driven as one
+// continuous move instead of stopping at every vertex.
+//
+// If route uploading is on (it needs PIC firmware which understands WRITE_ROUTE) the whole route
+// is sent in one transfer and driven by the PIC, with no round trip per manouvre. If the PIC
+// rejects the route it is sent one manouvre at a time instead.
+void CManouvre::FollowInstructions(const std::vector<EInstruction>& instructions)
+{
+	DEBUG_METHOD();
+
+	std::vector<SMotion> motions = FuseMotions(InstructionsToMotions(instructions));
+
+	if(s_uploadRoutes && CGoodsOut::RunRoute(CRouteProgram::Encode(motions)) != ROUTE_REJECTED) return;
+
+	ExecuteMotions(motions);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Drive every instruction of the stream whose vertices are known so far. The moves are joined up
+// as FollowInstructions does, but the last forward move is held back (across calls) until the
+// next instruction is known, since that may extend it. Returns the number of instructions driven;
+// call again once the route has been extended, until the stream is finished, which drives the
+// move held back. Only one stream can be followed this way at a time.
+unsigned int CManouvre::FollowAvailableInstructions(CInstructionStream& stream)
+{
+	DEBUG_METHOD();
+
+	unsigned int driven = 0;
+	SInstructionStep step;
+	while(stream.Next(step))
+	{
+		DriveStreamed(s_heldMotions, { step.m_instruction }, false);
+		driven++;
+	}
+
+	if(stream.IsFinished())
+		DriveStreamed(s_heldMotions, {}, true);
+
+	return driven;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Drive the stream until it is closed, as FollowAvailableInstructions, waiting whenever the robot
+// catches up with the planner extending the route on another thread. Returns the number of
+// instructions driven.
+unsigned int CManouvre::FollowStream(CInstructionStream& stream)
+{
+	DEBUG_METHOD();
+
+	unsigned int driven = 0;
+	std::vector<SMotion> held;
+	SInstructionStep step;
+	while(stream.WaitNext(step))
+	{
+		DriveStreamed(held, { step.m_instruction }, false);
+		driven++;
+	}
+	DriveStreamed(held, {}, true);
+
+	return driven;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Drive the motions of more streamed instructions, joined to the forward move held back from the
+// last ones. Unless the stream is finished, the last forward move is held back in its turn, so
+// that a streamed route is sent as the same commands as FollowInstructions sends.
+void CManouvre::DriveStreamed(std::vector<SMotion>& held, const std::vector<EInstruction>& instructions, bool finished)
+{
+	DEBUG_METHOD();
+
+	std::vector<SMotion> motions = InstructionsToMotions(instructions);
+	held.insert(held.end(), motions.begin(), motions.end());
+	motions = FuseMotions(held);
+	held.clear();
+
+	if(!finished && !motions.empty() && motions.back().m_type == EMotion_Forward)
+	{
+		held.push_back(motions.back());
+		motions.pop_back();
+	}
+
+	if(!motions.empty())
+		ExecuteMotions(motions);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// The motion commands for a list of instructions, one manouvre per instruction exactly as
+// InstructionToManouvre sends them.
+std::vector<SMotion> CManouvre::InstructionsToMotions(const std::vector<EInstruction>& instructions)
+{
+	DEBUG_METHOD();
+
+	std::vector<SMotion> motions;
+	motions.reserve(3*instructions.size());
+
+	for(unsigned int i=0; i<instructions.size(); i++)
+	{
+		switch(instructions[i])
+		{
+		case EInstruction_Straight:
+			motions.push_back({ EMotion_Forward, ROOMLENGTH, false });
+			break;
+		case EInstruction_TurnLeft:
+			motions.push_back({ EMotion_Forward, HALFROOMLENGTH, true });
+			motions.push_back({ EMotion_TurnLeft90, 0, false });
+			motions.push_back({ EMotion_Forward, HALFROOMLENGTH, false });
+			break;
+		case EInstruction_TurnRight:
+			motions.push_back({ EMotion_Forward, HALFROOMLENGTH, true });
+			motions.push_back({ EMotion_TurnRight90, 0, false });
+			motions.push_back({ EMotion_Forward, HALFROOMLENGTH, false });
+			break;
+		default:
+			break;
+		}
+	}
+
+	return motions;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Join runs of forward moves into single moves of the total distance. A run of straights becomes
+// one move, and so does the half room out of a turn together with the straights after it.
+//
+// Only moves driven the same way are joined. Straights follow the line (PSNS), while the half room
+// into a turn watches the encoders for the junction (ECDR), so the approach to a turn stays its own
+// command rather than turning the whole corridor before it into an encoder move.
+std::vector<SMotion> CManouvre::FuseMotions(const std::vector<SMotion>& motions)
+{
+	DEBUG_METHOD();
+
+	std::vector<SMotion> fused;
+	fused.reserve(motions.size());
+
+	for(unsigned int i=0; i<motions.size(); i++)
+	{
+		if(motions[i].m_type == EMotion_Forward && !fused.empty() && fused.back().m_type == EMotion_Forward
+				&& fused.back().m_watchSensors == motions[i].m_watchSensors)
+		{
+			fused.back().m_distance += motions[i].m_distance;
+		}
+		else
+		{
+			fused.push_back(motions[i]);
+		}
+	}
+
+	return fused;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Send a list of motion commands to the PIC. With a motion lookahead, up to that many are kept
+// queued on the PIC so it can go from one to the next without stopping. Without one, each
+// command is timed and noted in the telemetry log (if a run is being recorded), so the motion
+// time cost model can be fitted to the robot later.
+void CManouvre::ExecuteMotions(const std::vector<SMotion>& motions)
+{
+	DEBUG_METHOD();
+
+	if(s_motionLookahead > 0)
+	{
+		CMotionQueue queue(s_motionLookahead);
+		for(unsigned int i=0; i<motions.size(); i++) queue.Push(motions[i]);
+		queue.Drain();
+		return;
+	}
+
+	for(unsigned int i=0; i<motions.size(); i++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		switch(motions[i].m_type)
+		{
+		case EMotion_Forward:
+			CGoodsOut::Forward(motions[i].m_distance, motions[i].m_watchSensors);
+			break;
+		case EMotion_TurnLeft90:
+			CGoodsOut::TurnLeft90();
+			break;
+		case EMotion_TurnRight90:
+			CGoodsOut::TurnRight90();
+			break;
+		}
+
+		double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		CTelemetryRecorder::NoteMotion(motions[i].m_type, motions[i].m_distance, duration);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Send one motion command to the PIC without waiting for it, and return a handle which says
+// when it has finished, so planning can go on while the robot drives.
+CMotionHandle CManouvre::StartMotion(const SMotion& motion)
+{
+	DEBUG_METHOD();
+
+	switch(motion.m_type)
+	{
+	case EMotion_TurnLeft90:
+		return CGoodsOut::TurnLeft90Async();
+	case EMotion_TurnRight90:
+		return CGoodsOut::TurnRight90Async();
+	case EMotion_Forward:
+	default:
+		return CGoodsOut::ForwardAsync(motion.m_distance, motion.m_watchSensors);
 	}
 }
 
@@ -47,6 +270,7 @@ void CManouvre::LastInstructionToManouvre(EInstruction instruction_type)
 	case EInstruction_Straight:
 	{
 		CManouvre::StraightAcrossRoom();
+		break;
 	}
 	case EInstruction_TurnLeft:
 	{
@@ -54,6 +278,7 @@ void CManouvre::LastInstructionToManouvre(EInstruction instruction_type)
 		CGoodsOut::Forward(HALFROOMLENGTH, false);
 		CManouvre::TurnRightInRoom();
 		CManouvre::TurnRightInRoom();
+		break;
 	}
 	case EInstruction_TurnRight:
 	{
@@ -61,7 +286,10 @@ void CManouvre::LastInstructionToManouvre(EInstruction instruction_type)
 		CGoodsOut::Forward(HALFROOMLENGTH, false);
 		CManouvre::TurnLeftInRoom();
 		CManouvre::TurnLeftInRoom();
+		break;
 	}
+	default:
+		break;
 	}
 }
 
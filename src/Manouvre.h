@@ -14,7 +14,29 @@
 
 //~~~ INCLUDES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
+#include "CMotionPoller.h"
 #include "Instructions.h"
+#include <vector>
+
+//~~~ STRUCTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// One motion command for the PIC, i.e. one call to CGoodsOut. The distance and watch_sensors are
+// only used by EMotion_Forward.
+struct SMotion
+{
+	EMotion m_type;
+	double m_distance;
+	bool m_watchSensors;
+};
+
+inline bool operator==(const SMotion& a, const SMotion& b)
+{
+	return a.m_type == b.m_type && a.m_distance == b.m_distance && a.m_watchSensors == b.m_watchSensors;
+}
+
+inline bool operator!=(const SMotion& a, const SMotion& b)
+{
+	return !(a == b);
+}
 
 //~~~ CLASS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 class CManouvre
@@ -24,6 +46,17 @@ class CManouvre
 public:
 
 	static void InstructionToManouvre(EInstruction instruction_type);
+	static void FollowInstructions(const std::vector<EInstruction>& instructions);
+	static unsigned int FollowAvailableInstructions(CInstructionStream& stream);
+	static unsigned int FollowStream(CInstructionStream& stream);
+	static std::vector<SMotion> InstructionsToMotions(const std::vector<EInstruction>& instructions);
+	static std::vector<SMotion> FuseMotions(const std::vector<SMotion>& motions);
+	static void ExecuteMotions(const std::vector<SMotion>& motions);
+	static CMotionHandle StartMotion(const SMotion& motion);
+	static void SetUploadRoutes(bool upload) {s_uploadRoutes = upload;}
+	static bool GetUploadRoutes() {return s_uploadRoutes;}
+	static void SetMotionLookahead(unsigned int depth) {s_motionLookahead = depth;}
+	static unsigned int GetMotionLookahead() {return s_motionLookahead;}
 	static void LastInstructionToManouvre(EInstruction instruction_type);
 	static void MoveToStartVertex();
 	static void ExitMap();
@@ -36,6 +69,18 @@ public:
 	static void TurnLeftInRoom();
 	static void TurnRightInRoom();
 	static ERoom DetectRoomType();
+
+	// === Member Variables =========================================================================
+private:
+	// Whether FollowInstructions sends each route to the PIC as one route program
+	static bool s_uploadRoutes;
+	// How many motions ExecuteMotions keeps queued on the PIC (see CMotionQueue); 0 stalls on each
+	static unsigned int s_motionLookahead;
+	// The forward move FollowAvailableInstructions holds back until the next instruction is known
+	static std::vector<SMotion> s_heldMotions;
+
+	// === Private Functions ========================================================================
+	static void DriveStreamed(std::vector<SMotion>& held, const std::vector<EInstruction>& instructions, bool finished);
 };
 
 
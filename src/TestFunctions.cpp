@@ -22,6 +22,22 @@ void CParseCSV_test2();
 int CMazeMapper_test();
 void CBlockReader_test();
 int CBlockReader_test2();
+int CMapSnapshot_test();
+int CExplorationSession_test();
+int CExplorationSimulator_test();
+int CInstruction_test();
+int CRouteProgram_test();
+int CCostModel_test();
+int CMotionExecutor_test();
+int CTaskLoop_test();
+int CMissionPlanner_test();
+int CMotionQueue_test();
+int CRoutePlan_test();
+int CPicEmulator_test();
+int CCommandBatch_test();
+int CSensorAcquisition_test();
+int CMotionPoller_test();
+int CReplayTransport_test();
 
 
 int TestAllFunctions()
@@ -44,6 +60,38 @@ int TestAllFunctions()
 	std::cout << '\n';
 	CParseCSV_test2();
 	std::cout << '\n';
+	returnVal += CMapSnapshot_test();
+	std::cout << '\n';
+	returnVal += CExplorationSession_test();
+	std::cout << '\n';
+	returnVal += CExplorationSimulator_test();
+	std::cout << '\n';
+	returnVal += CInstruction_test();
+	std::cout << '\n';
+	returnVal += CRouteProgram_test();
+	std::cout << '\n';
+	returnVal += CCostModel_test();
+	std::cout << '\n';
+	returnVal += CMotionExecutor_test();
+	std::cout << '\n';
+	returnVal += CTaskLoop_test();
+	std::cout << '\n';
+	returnVal += CMissionPlanner_test();
+	std::cout << '\n';
+	returnVal += CMotionQueue_test();
+	std::cout << '\n';
+	returnVal += CRoutePlan_test();
+	std::cout << '\n';
+	returnVal += CPicEmulator_test();
+	std::cout << '\n';
+	returnVal += CCommandBatch_test();
+	std::cout << '\n';
+	returnVal += CSensorAcquisition_test();
+	std::cout << '\n';
+	returnVal += CMotionPoller_test();
+	std::cout << '\n';
+	returnVal += CReplayTransport_test();
+	std::cout << '\n';
 	//CBlockReader_test();                // Will fail without images in the Data/SpotImageExamples folder
 	//std::cout << '\n';
 	//returnVal += CBlockReader_test2();  // Will fail without images in the Data/SpotImageExamples folder
@@ -5,124 +5,578 @@
 //
 /////////////////////////////////////////
 
-#include "wiringPiSPI.h"
+#include "CSPITransport.h"
 #include "pic_enums.h"
 #include "pi_spi.h"
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
-
-/* For reference:
-    int wiringPiSPISetup (int channel, int speed) ;
-    int wiringPiSPIDataRW (int channel, unsigned char *data, int len) ;
-*/
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define SPI_CHANNEL 0
-#define SPI_TIMEOUT 100000
+#define SPI_TIMEOUT 100000 //default command timeout (us)
+
+//nullptr means wiringPi
+static CSPITransport* spi_transport = nullptr;
+
+CSPITransport* get_spi_transport() {
+	return spi_transport ? spi_transport : &CWiringPiTransport::Instance();
+}
+
+void set_spi_transport(CSPITransport* transport) {
+	spi_transport = transport;
+}
+
+//Held for each whole transaction (command, handshake and the statistics), so that threads sharing
+//the link, e.g. CSensorAcquisition, cannot interleave their frames. The long waits for a motion's
+//DONE take it for each poll instead.
+static std::mutex spi_bus_mutex;
+
+//Bytes transferred for the current command
+static uint32_t command_bytes = 0;
+
+static int spi_transfer(int channel, unsigned char* data, int len) {
+	command_bytes += len;
+	return get_spi_transport()->Transfer(channel, data, len);
+}
+
+//The transport's time, so that a replayed run times out where it did when it was recorded
+static std::chrono::steady_clock::time_point spi_now() {
+	return get_spi_transport()->Now();
+}
+
+//WAITING-------------------------------------------------------------------------
+
+static spi_wait_policy_t wait_policy = { 100, 50, 2000, SPI_TIMEOUT, 60000000, 3 };
+static spi_latency_stats_t latency_stats[256];
+
+//Polls made while waiting for the current command, and its retries and CRC errors
+static uint32_t command_polls = 0;
+static uint32_t command_retries = 0;
+static uint32_t command_crc_errors = 0;
+
+void set_spi_wait_policy(const spi_wait_policy_t& policy) {
+	wait_policy = policy;
+}
+
+spi_wait_policy_t get_spi_wait_policy() {
+	return wait_policy;
+}
+
+spi_latency_stats_t get_spi_latency_stats(uint16_t command) {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	return latency_stats[command & 0x00FF];
+}
+
+void reset_spi_latency_stats() {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	for(int i=0;i<256;i++) latency_stats[i] = spi_latency_stats_t();
+}
+
+//CHECKED FRAMES------------------------------------------------------------------
+
+//CRC-16/CCITT-FALSE (polynomial 0x1021, starting from 0xFFFF)
+uint16_t spi_crc16(const uint8_t* data, uint32_t length) {
+	uint16_t crc = 0xFFFF;
+	for(uint32_t i=0;i<length;i++) {
+		crc ^= (uint16_t) (data[i] << 8);
+		for(int bit=0;bit<8;bit++) crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+	}
+	return crc;
+}
+
+//Sequence numbers run from 1 to 0xFFFF and round again; 0 is never sent
+static uint16_t last_sequence = 0;
+
+static uint16_t next_sequence() {
+	if(++last_sequence == 0) last_sequence = 1;
+	return last_sequence;
+}
+
+//Put the sequence number and the CRC of the rest of the frame in its last two words
+static void seal_frame(uint8_t* frame, uint16_t sequence) {
+	frame[12] = (uint8_t) (sequence >> 8);
+	frame[13] = (uint8_t) (sequence & 0x00FF);
+	uint16_t crc = spi_crc16(frame, 14);
+	frame[14] = (uint8_t) (crc >> 8);
+	frame[15] = (uint8_t) (crc & 0x00FF);
+}
 
-const uint16_t DONE = 0xFFFE;
-const uint16_t DATA = 0xFFFD;
+//Sequence numbers of the motions queued without stalling and not yet waited for (oldest first),
+//and of those whose DONE came while waiting for something else
+static std::deque<uint16_t> queued_motions;
+static std::deque<uint16_t> completed_motions;
 
+//Sequence numbers of the motions a thread is waiting for (stalled motions and those in Wait_Done),
+//and of those whose DONE another thread met while the bus was let go
+static std::deque<uint16_t> awaited_motions;
+static std::deque<uint16_t> awaited_dones;
+
+static bool is_queued_motion(uint16_t sequence) {
+	return std::find(queued_motions.begin(), queued_motions.end(), sequence) != queued_motions.end();
+}
+
+static void forget_queued_motion(uint16_t sequence) {
+	std::deque<uint16_t>::iterator motion = std::find(queued_motions.begin(), queued_motions.end(), sequence);
+	if(motion != queued_motions.end()) queued_motions.erase(motion);
+}
+
+static bool is_awaited_motion(uint16_t sequence) {
+	return std::find(awaited_motions.begin(), awaited_motions.end(), sequence) != awaited_motions.end();
+}
+
+//Whether another thread met the DONE of this awaited motion (which is then taken)
+static bool take_awaited_done(uint16_t sequence) {
+	std::deque<uint16_t>::iterator done = std::find(awaited_dones.begin(), awaited_dones.end(), sequence);
+	if(done == awaited_dones.end()) return false;
+	awaited_dones.erase(done);
+	return true;
+}
+
+static void forget_awaited_motion(uint16_t sequence) {
+	std::deque<uint16_t>::iterator motion = std::find(awaited_motions.begin(), awaited_motions.end(), sequence);
+	if(motion != awaited_motions.end()) awaited_motions.erase(motion);
+	take_awaited_done(sequence);
+}
+
+//Keep a DONE met while waiting for something else, for whoever is waiting for it
+static void keep_done(uint16_t sequence) {
+	if(is_queued_motion(sequence)) completed_motions.push_back(sequence);
+	else if(is_awaited_motion(sequence)) awaited_dones.push_back(sequence);
+}
+
+//Starts a session: sequence numbers start again from 1 and no motions are queued, as when the program
+//starts, so that a session recorded by CTelemetryRecorder can be replayed from the same state
 void init_spi() {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	last_sequence = 0;
+	queued_motions.clear();
+	completed_motions.clear();
+	awaited_motions.clear();
+	awaited_dones.clear();
+
 	//initialises channel 0 of spi with clock speed = 1MHz
-	wiringPiSPISetupMode(SPI_CHANNEL, 1000000, 1);
+	get_spi_transport()->Setup(SPI_CHANNEL, 1000000, 1);
 }
 
-void write_SPI_stall_DONE(uint8_t* send_buffer) {
-        //Send command
-        wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 16); 
+static uint16_t command_word(const uint8_t* send_buffer) {
+	return (uint16_t) ((send_buffer[0] << 8) | send_buffer[1]);
+}
+
+//TRACING-------------------------------------------------------------------------
+
+//Off unless spi_trace_enable has been called. The ring and the histograms are allocated there, so
+//recording a transaction only reads the clock twice and writes into memory already there.
+static bool trace_enabled = false;
+static std::vector<spi_trace_record_t> trace_ring;
+static uint64_t trace_recorded = 0;
+static std::vector<spi_latency_histogram_t> trace_histograms;
+
+//Sequence number and start time (CLOCK_MONOTONIC) of the current command
+static uint16_t command_sequence = 0;
+static uint64_t command_start_ns = 0;
+
+//The counters of the current command, put aside while a long wait lets go of the bus
+struct command_counters_t {
+	uint32_t polls, retries, crc_errors, bytes;
+	uint16_t sequence;
+	uint64_t start_ns;
+};
+
+static command_counters_t save_command() {
+	return { command_polls, command_retries, command_crc_errors, command_bytes, command_sequence, command_start_ns };
+}
+
+static void restore_command(const command_counters_t& counters) {
+	command_polls = counters.polls;
+	command_retries = counters.retries;
+	command_crc_errors = counters.crc_errors;
+	command_bytes = counters.bytes;
+	command_sequence = counters.sequence;
+	command_start_ns = counters.start_ns;
+}
+
+static uint64_t monotonic_ns() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec*1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+//Values below 2^SPI_HISTOGRAM_SUB_BITS have a bucket each; above, each power of two is split into
+//2^SPI_HISTOGRAM_SUB_BITS buckets, so a value is known to within 1/2^SPI_HISTOGRAM_SUB_BITS of itself
+static uint32_t histogram_bucket(uint64_t ns) {
+	const uint32_t sub_buckets = 1 << SPI_HISTOGRAM_SUB_BITS;
+	if(ns < sub_buckets) return (uint32_t) ns;
+
+#ifdef __GNUC__
+	uint32_t magnitude = 63 - __builtin_clzll(ns);
+#else
+	uint32_t magnitude = 0;
+	while(ns >> (magnitude + 1)) magnitude++;
+#endif
+	uint32_t shift = magnitude - SPI_HISTOGRAM_SUB_BITS;
+	uint32_t bucket = sub_buckets + shift*sub_buckets + (uint32_t) ((ns >> shift) - sub_buckets);
+	return std::min(bucket, (uint32_t) SPI_HISTOGRAM_BUCKETS - 1);
+}
+
+//The highest value which falls in a bucket
+static uint64_t histogram_value(uint32_t bucket) {
+	const uint32_t sub_buckets = 1 << SPI_HISTOGRAM_SUB_BITS;
+	if(bucket < sub_buckets) return bucket;
+
+	uint32_t shift = (bucket - sub_buckets) / sub_buckets;
+	uint64_t sub = (bucket - sub_buckets) % sub_buckets;
+	return ((sub_buckets + sub + 1) << shift) - 1;
+}
+
+static void trace_command(uint16_t command, bool timed_out) {
+	uint64_t end_ns = monotonic_ns();
+	uint64_t duration_ns = end_ns - command_start_ns;
+
+	spi_trace_record_t& record = trace_ring[trace_recorded++ % trace_ring.size()];
+	record.start_ns = command_start_ns;
+	record.duration_ns = (uint32_t) std::min<uint64_t>(duration_ns, UINT32_MAX);
+	record.bytes = command_bytes;
+	record.polls = command_polls;
+	record.command = command;
+	record.sequence = command_sequence;
+	record.retries = (uint16_t) std::min<uint32_t>(command_retries, UINT16_MAX);
+	record.crc_errors = (uint8_t) std::min<uint32_t>(command_crc_errors, UINT8_MAX);
+	record.timed_out = timed_out;
+
+	spi_latency_histogram_t& histogram = trace_histograms[command & 0x00FF];
+	if(histogram.count == 0 || duration_ns < histogram.min_ns) histogram.min_ns = duration_ns;
+	if(duration_ns > histogram.max_ns) histogram.max_ns = duration_ns;
+	histogram.count++;
+	histogram.buckets[histogram_bucket(duration_ns)]++;
+}
+
+void spi_trace_enable(uint32_t capacity) {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	trace_ring.assign(std::max<uint32_t>(capacity, 1), spi_trace_record_t());
+	trace_recorded = 0;
+	trace_histograms.assign(256, spi_latency_histogram_t());
+	trace_enabled = true;
+}
+
+void spi_trace_disable() {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	trace_enabled = false;
+}
+
+uint64_t spi_trace_count() {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	return trace_recorded;
+}
+
+uint32_t spi_trace_records(spi_trace_record_t* records, uint32_t max) {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	uint64_t kept = std::min<uint64_t>(trace_recorded, trace_ring.size());
+	uint32_t count = (uint32_t) std::min<uint64_t>(kept, max);
+	for(uint64_t i=trace_recorded-count;i<trace_recorded;i++) {
+		*records++ = trace_ring[i % trace_ring.size()];
+	}
+	return count;
+}
+
+spi_latency_histogram_t get_spi_latency_histogram(uint16_t command) {
+	std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+	return trace_histograms.empty() ? spi_latency_histogram_t() : trace_histograms[command & 0x00FF];
+}
+
+uint64_t spi_histogram_percentile(const spi_latency_histogram_t& histogram, double percentile) {
+	if(histogram.count == 0) return 0;
+
+	uint64_t target = (uint64_t) (percentile/100*histogram.count + 0.5);
+	target = std::max<uint64_t>(1, std::min<uint64_t>(target, histogram.count));
+	uint64_t seen = 0;
+	for(uint32_t i=0;i<SPI_HISTOGRAM_BUCKETS;i++) {
+		seen += histogram.buckets[i];
+		if(seen >= target) return std::min(histogram_value(i), histogram.max_ns);
+	}
+	return histogram.max_ns;
+}
+
+//File: the header, then the records kept, oldest first
+bool spi_trace_dump(const char* path) {
+	std::vector<spi_trace_record_t> records;
+	{
+		std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+		records.resize((size_t) std::min<uint64_t>(trace_recorded, trace_ring.size()));
+	}
+	records.resize(spi_trace_records(records.data(), records.size()));
+
+	spi_trace_header_t header;
+	memcpy(header.magic, "SPIT", 4);
+	header.version = SPI_TRACE_VERSION;
+	header.record_size = sizeof(spi_trace_record_t);
+	header.count = records.size();
+	header.recorded = spi_trace_count();
+
+	FILE* file = fopen(path, "wb");
+	if(!file) return false;
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1
+			&& fwrite(records.data(), sizeof(spi_trace_record_t), records.size(), file) == records.size();
+	return fclose(file) == 0 && written;
+}
+
+//Start timing a command: clears its counters and notes when it started
+static std::chrono::steady_clock::time_point begin_command(uint16_t sequence) {
+	command_polls = 0;
+	command_retries = 0;
+	command_crc_errors = 0;
+	command_bytes = 0;
+	command_sequence = sequence;
+	if(trace_enabled) command_start_ns = monotonic_ns();
+	return spi_now();
+}
+
+static void record_latency(uint16_t command, std::chrono::steady_clock::time_point start, bool timed_out) {
+	if(trace_enabled) trace_command(command, timed_out);
+
+	double us = std::chrono::duration<double, std::micro>(spi_now() - start).count();
+
+	spi_latency_stats_t& stats = latency_stats[command & 0x00FF];
+	stats.count++;
+	if(timed_out) stats.timeouts++;
+	stats.polls += command_polls;
+	stats.retries += command_retries;
+	stats.crc_errors += command_crc_errors;
+	stats.total_us += us;
+	if(us > stats.max_us) stats.max_us = us;
+}
+
+//Poll the PIC until it sends first, second or RESEND for the frame with this sequence number, and
+//return which it sent. A sequence number of 0 takes first or second whatever it carries. DONEs of
+//queued motions met on the way are kept for Wait_Done. Throws Exception_SPITimeout if that takes
+//longer than timeout_us.
+//Given the bus lock, the bus is let go between polls (and the ready line waited on for one sleep at
+//most), so that other threads can use it during a long wait; the DONE of the awaited motion may
+//then be met by one of them.
+static uint16_t wait_for(uint16_t command, std::chrono::steady_clock::time_point start, uint32_t timeout_us,
+        uint16_t first, uint16_t second, uint16_t sequence, std::unique_lock<std::mutex>* bus_lock = nullptr) {
+        CSPITransport* transport = get_spi_transport();
+        uint32_t sleep_us = wait_policy.min_sleep_us;
+        uint32_t polls = 0;
 
-        //Wait for response
         while(1) {
-            //Read from SPI_LINK
-            uint16_t receive_buffer;
-            receive_buffer = 0;
-            wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) &receive_buffer, 2);
-                
-            //If receive DONE, then respond with DONE, ending SPI comms
-            if(receive_buffer == DONE) {
-                send_buffer[0] = (uint8_t) (((uint16_t) DONE) >> 8);
-                send_buffer[1] = (uint8_t) (((uint16_t) DONE) & 0x00FF);
-                wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 2);
-                break;
+            //Read from SPI_LINK: [status, sequence number]
+            uint16_t receive_buffer[2];
+            receive_buffer[0] = 0;
+            receive_buffer[1] = 0;
+            spi_transfer(SPI_CHANNEL, (uint8_t*) &receive_buffer[0], 4);
+            command_polls++;
+
+            uint16_t status = receive_buffer[0];
+            if(status == first || status == second || (status == RESEND && sequence)) {
+                bool ours = !sequence || receive_buffer[1] == sequence || (status == RESEND && receive_buffer[1] == 0);
+                if(ours) return status;
+                if(status == DONE) keep_done(receive_buffer[1]);
+            } else if(status == DONE) {
+                keep_done(receive_buffer[1]);
+            }
+
+            //Give up after the timeout
+            double waited_us = std::chrono::duration<double, std::micro>(spi_now() - start).count();
+            if(timeout_us && waited_us >= timeout_us) {
+                throw Exception_SPITimeout { command, waited_us, command_polls };
+            }
+
+            //Spin at first, then wait for the ready line or sleep for longer and longer
+            uint32_t pause_us = 0;
+            if(++polls > wait_policy.spin_polls) {
+                uint32_t remaining_us = timeout_us ? timeout_us - (uint32_t) waited_us : UINT32_MAX;
+                if(transport->HasReadyLine()) {
+                    transport->WaitReady(bus_lock ? std::min(sleep_us, remaining_us) : (timeout_us ? remaining_us : wait_policy.max_sleep_us));
+                } else {
+                    pause_us = std::min(sleep_us, remaining_us);
+                }
+                sleep_us = std::min(2*sleep_us, wait_policy.max_sleep_us);
             }
-        }       
+
+            if(bus_lock) {
+                command_counters_t counters = save_command();
+                bus_lock->unlock();
+                if(pause_us) std::this_thread::sleep_for(std::chrono::microseconds(pause_us));
+                bus_lock->lock();
+                restore_command(counters);
+                if(take_awaited_done(sequence)) return DONE;
+            } else if(pause_us) {
+                std::this_thread::sleep_for(std::chrono::microseconds(pause_us));
+            }
+        }
 }
 
-void write_SPI(uint8_t* send_buffer) {
-        //Send command
-        wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 16);     
+//End SPI comms with DONE, or ask the PIC to send its reply again with RESEND
+static void send_word(uint16_t word) {
+        uint8_t send_buffer[2];
+        send_buffer[0] = (uint8_t) (((uint16_t) word) >> 8);
+        send_buffer[1] = (uint8_t) (((uint16_t) word) & 0x00FF);
+        spi_transfer(SPI_CHANNEL, (uint8_t*) send_buffer, 2);
 }
 
-void Wait_Done() {
-        //Wait for response
+//Record the latency of a transaction which failed, and throw
+static void give_up(uint16_t command, std::chrono::steady_clock::time_point start, bool queued_motion) {
+        if(queued_motion) queued_motions.pop_back();
+        forget_awaited_motion(command_sequence);
+        record_latency(command, start, true);
+        double waited_us = std::chrono::duration<double, std::micro>(spi_now() - start).count();
+        throw Exception_SPITimeout { command, waited_us, command_polls };
+}
+
+//One checked transaction. The frame is sealed with the next sequence number and its CRC and sent
+//(then the payload, if any), and the PIC's reply must carry the same sequence number:
+// - RESEND (the PIC could not read the frame or payload) sends them again.
+// - Data whose CRC or sequence number is wrong, or a DONE without the data, is asked for again by
+//   ending with RESEND instead of DONE.
+// - No reply within timeout_us sends the frame again with the same sequence number, so the PIC
+//   repeats its reply rather than carrying out the command twice.
+//Each of these is a retry; after max_retries the transaction gives up with Exception_SPITimeout.
+//A stalled motion takes the bus for each poll while it waits for its DONE.
+//Returns the PIC's last word: first or second (data_length words of data are read after DATA).
+static uint16_t transact(uint8_t* frame, const uint8_t* payload, uint32_t payload_length, uint16_t* data,
+        uint32_t data_length, uint32_t timeout_us, uint16_t first, uint16_t second, bool queued_motion = false,
+        uint16_t* sent_sequence = nullptr, bool stalled_motion = false) {
+        std::unique_lock<std::mutex> bus_lock(spi_bus_mutex);
+        uint16_t command = command_word(frame);
+        uint16_t sequence = next_sequence();
+        seal_frame(frame, sequence);
+        if(sent_sequence) *sent_sequence = sequence;
+
+        //A queued motion is known before its QUEUED arrives, since its DONE may overtake a lost QUEUED
+        if(queued_motion) queued_motions.push_back(sequence);
+        if(stalled_motion) awaited_motions.push_back(sequence);
+
+        std::chrono::steady_clock::time_point start = begin_command(sequence);
+
+        //Transfers overwrite what they send, so copies are sent
+        uint8_t sent[16];
+        static thread_local std::vector<uint8_t> sent_payload;
+        static thread_local std::vector<uint16_t> reply;
+        if(reply.size() < data_length + 2) reply.resize(data_length + 2);
+
+        bool send_frame = true;
+        bool have_data = false;
         while(1) {
-            //Read from SPI_LINK
-            uint16_t receive_buffer;
-            receive_buffer = 0;
-            wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) &receive_buffer, 2);
-                
-            //If receive DONE, then respond with DONE, ending SPI comms
-            if(receive_buffer == DONE) {
-                uint8_t send_buffer[16];
-
-                send_buffer[0] = (uint8_t) (((uint16_t) DONE) >> 8);
-                send_buffer[1] = (uint8_t) (((uint16_t) DONE) & 0x00FF);
-                wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 2);
-                break;
+            if(send_frame) {
+                memcpy(sent, frame, 16);
+                spi_transfer(SPI_CHANNEL, sent, 16);
+                if(payload_length) {
+                    sent_payload.assign(payload, payload + payload_length);
+                    spi_transfer(SPI_CHANNEL, sent_payload.data(), payload_length);
+                }
+                send_frame = false;
+                have_data = false;
+            }
+
+            uint16_t status;
+            try {
+                status = wait_for(command, spi_now(), timeout_us, first, second, sequence, stalled_motion ? &bus_lock : nullptr);
+            } catch(Exception_SPITimeout& e) {
+                if(++command_retries > wait_policy.max_retries) give_up(command, start, queued_motion);
+                send_frame = true;
+                continue;
             }
-        }   
+
+            if(status == RESEND) {
+                command_crc_errors++;
+                if(++command_retries > wait_policy.max_retries) give_up(command, start, queued_motion);
+                send_frame = true;
+                continue;
+            }
+
+            //Data, followed by [sequence number, CRC], then DONE. Zeros are clocked out rather than
+            //the last reply, so the same command always puts the same bytes on the wire.
+            if(status == DATA && data_length) {
+                std::fill(reply.begin(), reply.begin() + data_length + 2, 0);
+                spi_transfer(SPI_CHANNEL, (uint8_t*) reply.data(), 2*(data_length + 2));
+                have_data = reply[data_length] == sequence
+                        && spi_crc16((const uint8_t*) reply.data(), 2*(data_length + 1)) == reply[data_length + 1];
+                if(!have_data) command_crc_errors++;
+                continue;
+            }
+
+            if(data_length && !have_data) {
+                if(++command_retries > wait_policy.max_retries) give_up(command, start, queued_motion);
+                send_word(RESEND);
+                continue;
+            }
+
+            send_word(DONE);
+            if(data_length) memcpy(data, reply.data(), 2*data_length);
+            if(stalled_motion) forget_awaited_motion(sequence);
+            record_latency(command, start, false);
+            return status;
+        }
+}
+
+//A stalled motion: waits for the motion to finish
+void write_SPI_stall_DONE(uint8_t* send_buffer) {
+        transact(send_buffer, nullptr, 0, nullptr, 0, wait_policy.motion_timeout_us, DONE, DONE, false, nullptr, true);
+}
+
+//A motion queued without stalling: waits only for the PIC to queue it. Returns the frame's
+//sequence number, which the motion's DONE will carry.
+uint16_t write_SPI(uint8_t* send_buffer, bool queued_motion) {
+        uint16_t sequence = 0;
+        transact(send_buffer, nullptr, 0, nullptr, 0, wait_policy.command_timeout_us, QUEUED, QUEUED, queued_motion, &sequence);
+        return sequence;
+}
+
+//The bus is taken for each poll while waiting, as for a stalled motion
+void Wait_Done() {
+        std::unique_lock<std::mutex> bus_lock(spi_bus_mutex);
+
+        //The oldest queued motion (0, any DONE, if none is known)
+        uint16_t motion = queued_motions.empty() ? 0 : queued_motions.front();
+        if(!queued_motions.empty()) queued_motions.pop_front();
+        std::chrono::steady_clock::time_point start = begin_command(motion);
+
+        //Its DONE may already have come while waiting for something else
+        std::deque<uint16_t>::iterator completed = std::find(completed_motions.begin(), completed_motions.end(), motion);
+        if(motion && completed != completed_motions.end()) {
+            completed_motions.erase(completed);
+            record_latency(SPI_QUEUED_MOTION, start, false);
+            return;
+        }
+
+        //Wait for it to finish, then respond with DONE, ending SPI comms
+        if(motion) awaited_motions.push_back(motion);
+        try {
+            while(wait_for(SPI_QUEUED_MOTION, start, wait_policy.motion_timeout_us, DONE, DONE, motion, &bus_lock) != DONE);
+        } catch(Exception_SPITimeout& e) {
+            forget_awaited_motion(motion);
+            record_latency(SPI_QUEUED_MOTION, start, true);
+            throw;
+        }
+        forget_awaited_motion(motion);
+        send_word(DONE);
+
+        record_latency(SPI_QUEUED_MOTION, start, false);
 }
 
 void write_SPI_wait_DONE(uint8_t* send_buffer) {
-        //Send command
-        wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 16); 
-
-        //Wait for response
-        uint32_t n = 0;
-        while(/*n++ < SPI_TIMEOUT*/1) {
-            //Read from SPI_LINK
-            uint16_t receive_buffer;
-            receive_buffer = 0;
-            wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) &receive_buffer, 2);
-                
-            //If receive DONE, then respond with DONE, ending SPI comms
-            if(receive_buffer == DONE) {
-                send_buffer[0] = (uint8_t) (((uint16_t) DONE) >> 8);
-                send_buffer[1] = (uint8_t) (((uint16_t) DONE) & 0x00FF);
-                wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 2);
-                break;
-            }
-        }   
+        transact(send_buffer, nullptr, 0, nullptr, 0, wait_policy.command_timeout_us, DONE, DONE);
 }
 
 void write_SPI_read_wait_DONE(uint8_t* send_buffer, uint16_t* receive_buffer, uint32_t length) {
-        //Send command
-        wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 16); 
-
-        //Wait for response
-        uint32_t n = 0;
-        uint16_t result = 0;
-        while(/*n++ < SPI_TIMEOUT*/1) {
-            //Read from SPI_LINK
-            uint16_t receive_value;
-            receive_value = 0;
-            wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) &receive_value, 2);
-            
-            //If receive DONE, then respond with DONE, ending SPI comms
-            if(receive_value == DATA) {
-                receive_value = 0;
-                wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) &receive_buffer[0], length*2);
-            }
-            if(receive_value == DONE) {
-                send_buffer[0] = (uint8_t) (((uint16_t) DONE) >> 8);
-                send_buffer[1] = (uint8_t) (((uint16_t) DONE) & 0x00FF);
-                wiringPiSPIDataRW(SPI_CHANNEL, (uint8_t*) send_buffer, 2);
-                break;
-            }
-        }     
+        transact(send_buffer, nullptr, 0, receive_buffer, length, wait_policy.command_timeout_us, DATA, DONE);
 }
 
-//helper function to fill up send buffer
-void fill_buffer(uint8_t* buffer, uint16_t val0, uint16_t val1,uint16_t val2, uint16_t val3) {
+//helper function to fill up the 8 bytes of one command
+static void fill_command(uint8_t* buffer, uint16_t val0, uint16_t val1,uint16_t val2, uint16_t val3) {
     //Change orientation of bytes (MSB - LSB)
     buffer[0] = (uint8_t) (((uint16_t) val0) >> 8);
     buffer[1] = (uint8_t) (((uint16_t) val0) & 0x00FF);
@@ -132,6 +586,11 @@ void fill_buffer(uint8_t* buffer, uint16_t val0, uint16_t val1,uint16_t val2, ui
     buffer[5] = (uint8_t) (((uint16_t) val2) & 0x00FF);
     buffer[6] = (uint8_t) (((uint16_t) val3) >> 8);
     buffer[7] = (uint8_t) (((uint16_t) val3) & 0x00FF);
+}
+
+//helper function to fill up send buffer
+void fill_buffer(uint8_t* buffer, uint16_t val0, uint16_t val1,uint16_t val2, uint16_t val3) {
+    fill_command(buffer, val0, val1, val2, val3);
     for(int i=8;i<16;i++) buffer[i] = 0;
 }
 
@@ -253,158 +712,299 @@ void fill_buffer(uint8_t* buffer, uint16_t val0, uint16_t val1,uint16_t val2, ui
 
 //photosensors-----------------------------------------------------------------
 
-	void pic_read_photosense1(uint16_t* buffer, uint16_t length, uint16_t clear) {
-        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
+    //Scale 10-bit ADC samples to levels from 0 to 1, 4 (NEON, SSE2) or 1 at a time. Multiplying
+    //by 1/1024 is exact, so every path gives the same levels as dividing by 1024.
+    void photosense_to_levels(const uint16_t* samples, float* levels, uint32_t length) {
+        const float scale = 1.0f / 1024; //2^10 - max value of ADCs
+        uint32_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        float32x4_t scale4 = vdupq_n_f32(scale);
+        for(;i+4<=length;i+=4) {
+            uint32x4_t wide = vmovl_u16(vld1_u16(&samples[i]));
+            vst1q_f32(&levels[i], vmulq_f32(vcvtq_f32_u32(wide), scale4));
+        }
+#elif defined(__SSE2__)
+        __m128 scale4 = _mm_set1_ps(scale);
+        __m128i zero = _mm_setzero_si128();
+        for(;i+8<=length;i+=8) {
+            __m128i words = _mm_loadu_si128((const __m128i*) &samples[i]);
+            __m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+            __m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+            _mm_storeu_ps(&levels[i], _mm_mul_ps(low, scale4));
+            _mm_storeu_ps(&levels[i+4], _mm_mul_ps(high, scale4));
+        }
+#endif
+        for(;i<length;i++) levels[i] = (float) samples[i] * scale;
+    }
 
-        //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS1, length, clear,0);
+    //Raw samples are received straight into the caller's buffer
+    static void receive_photosense(uint8_t* send_buffer, uint16_t* samples, uint16_t length) {
+        write_SPI_read_wait_DONE(send_buffer, samples, length);
+    }
 
-        write_SPI_read_wait_DONE(&send_buffer[0], &buffer[0], length);
+    //Levels are received into a buffer kept for the thread (so nothing is allocated once it has
+    //grown to the longest read), then scaled
+    static void receive_photosense(uint8_t* send_buffer, float* levels, uint16_t length) {
+        static thread_local std::vector<uint16_t> samples;
+        if(samples.size() < length) samples.resize(length);
+
+        write_SPI_read_wait_DONE(send_buffer, samples.data(), length);
+        photosense_to_levels(samples.data(), levels, length);
     }
-	void pic_read_photosense2(uint16_t* buffer, uint16_t length, uint16_t clear) {
+
+    //One read path for all the photosensors, giving raw samples (uint16_t) or levels (float)
+    template<typename T>
+    static void read_photosense(command_t command, T* buffer, uint16_t length, uint16_t clear) {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS2, length, clear,0);
+        fill_buffer(&send_buffer[0], (uint16_t) command, length, clear,0);
+
+        receive_photosense(&send_buffer[0], buffer, length);
+    }
 
-        write_SPI_read_wait_DONE(&send_buffer[0], &buffer[0], length);
+	void pic_read_photosense1(uint16_t* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS1, buffer, length, clear);
+    }
+	void pic_read_photosense2(uint16_t* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS2, buffer, length, clear);
     }
 	void pic_read_photosense3(float* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS3, buffer, length, clear);
+    }
+	void pic_read_photosense4(float* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS4, buffer, length, clear);
+    }
+	void pic_read_photosense5(float* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS5, buffer, length, clear);
+    }
+	void pic_read_photosense6(float* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNS6, buffer, length, clear);
+    }
+	void pic_read_photosensecube(uint16_t* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNSCBE, buffer, length, clear);
+    }
+	void pic_read_photosensefront(uint16_t* buffer, uint16_t length, uint16_t clear) {
+        read_photosense(READ_PSNSFNT, buffer, length, clear);
+    }
+
+//LED------------------------------------------------------------------------
+
+	void pic_write_led(led_t mode, uint16_t period) {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS3, length, clear,0);
+        fill_buffer(&send_buffer[0], (uint16_t) WRITE_LED, (uint16_t) mode, period,0);
 
-        //create receive buffer of uint16 values
-        uint16_t* recbuf;
-        recbuf = new uint16_t [length];
+        //write command
+        write_SPI_wait_DONE(&send_buffer[0]); 	
+	}
 
-        write_SPI_read_wait_DONE(&send_buffer[0], (uint16_t*) &recbuf[0], length);
+//Rooms-------------------------------------------------------------------------
 
-        //Fill float buffer with converted uint16_t buffer
-        for(int i=0;i<length;i++) {
-            buffer[i] = ((float) recbuf[i]) / 1024; //2^10 - max value of ADCs
-        }
 
-        //remove temporary buffer
-        delete[] recbuf;
-    }
-	void pic_read_photosense4(float* buffer, uint16_t length, uint16_t clear) {
+    ERoom pic_read_roomtype() {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS4, length, clear,0);
+        fill_buffer(&send_buffer[0], (uint16_t) READ_ROOM, 0, 0,0);
 
-        //create receive buffer of uint16 values
-        uint16_t* recbuf;
-        recbuf = new uint16_t [length];
+        uint16_t result;
+        write_SPI_read_wait_DONE(&send_buffer[0], &result, 1);
 
-        write_SPI_read_wait_DONE(&send_buffer[0], (uint16_t*) &recbuf[0], length);
+        return (ERoom) result;   
+    }
 
-        //Fill float buffer with converted uint16_t buffer
-        for(int i=0;i<length;i++) {
-            buffer[i] = ((float) recbuf[i]) / 1024; //2^10 - max value of ADCs
-        }
 
-        //remove temporary buffer
-        delete[] recbuf;
-    }
-	void pic_read_photosense5(float* buffer, uint16_t length, uint16_t clear) {
+//SENSOR FRAMES-------------------------------------------------------------------
+
+    void pic_read_sensor_frame(sensor_frame_t* frame, uint16_t reset_encoders) {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS5, length, clear,0);
+        fill_buffer(&send_buffer[0], (uint16_t) READ_SENSOR_FRAME, reset_encoders, 0,0);
+
+        uint16_t result[SENSOR_FRAME_WORDS];
+        write_SPI_read_wait_DONE(&send_buffer[0], &result[0], SENSOR_FRAME_WORDS);
+
+        //Unpack, as laid out in pic_enums.h
+        frame->sequence = result[0];
+        frame->timestamp_us = ((uint32_t) result[1] << 16) | result[2];
+        frame->encoder_left = (int16_t) result[3];
+        frame->encoder_right = (int16_t) result[4];
+        frame->compass = result[5];
+        for(int i=0;i<8;i++) frame->photosensors[i] = result[6 + i];
+    }
 
-        //create receive buffer of uint16 values
-        uint16_t* recbuf;
-        recbuf = new uint16_t [length];
 
-        write_SPI_read_wait_DONE(&send_buffer[0], (uint16_t*) &recbuf[0], length);
+//STATES--------------------------------------------------------------------------
 
-        //Fill float buffer with converted uint16_t buffer
-        for(int i=0;i<length;i++) {
-            buffer[i] = ((float) recbuf[i]) / 1024; //2^10 - max value of ADCs
-        }
+    void pic_write_state(state_t state, condition_t termination, uint16_t termination_val, char stall) {
+        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
-        //remove temporary buffer
-        delete[] recbuf;
+        //command word first
+        fill_buffer(&send_buffer[0], (uint16_t) state, (uint16_t) termination, termination_val, stall ? 0 : 1);
+
+        if(stall) {
+            write_SPI_stall_DONE(&send_buffer[0]);
+        } else if(state == STOPPED) {
+            //Stopping discards the queued motions, whose DONEs will never come, and sends none itself
+            write_SPI(&send_buffer[0], false);
+            std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+            queued_motions.clear();
+        } else {
+            write_SPI(&send_buffer[0], true);
+        }
     }
-	void pic_read_photosense6(float* buffer, uint16_t length, uint16_t clear) {
+
+
+    //Queue a motion without stalling, and return the sequence number its DONE will carry
+    uint16_t pic_write_state_async(state_t state, condition_t termination, uint16_t termination_val) {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNS6, length, clear,0);
+        fill_buffer(&send_buffer[0], (uint16_t) state, (uint16_t) termination, termination_val, 1);
+
+        return write_SPI(&send_buffer[0], true);
+    }
 
-        //create receive buffer of uint16 values
-        uint16_t* recbuf;
-        recbuf = new uint16_t [length];
 
-        write_SPI_read_wait_DONE(&send_buffer[0], (uint16_t*) &recbuf[0], length);
+    //Collect the DONEs of queued motions without waiting: first those which came while waiting
+    //for other replies, then any waiting on the link, each ended with DONE. Their sequence
+    //numbers are put in finished (up to max of them), oldest first, and they are no longer
+    //waited for by Wait_Done. Returns how many finished.
+    uint32_t pic_poll_motions(uint16_t* finished, uint32_t max) {
+        std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+        uint32_t count = 0;
 
-        //Fill float buffer with converted uint16_t buffer
-        for(int i=0;i<length;i++) {
-            buffer[i] = ((float) recbuf[i]) / 1024; //2^10 - max value of ADCs
+        while(count < max && !completed_motions.empty()) {
+            uint16_t motion = completed_motions.front();
+            completed_motions.pop_front();
+            forget_queued_motion(motion);
+            finished[count++] = motion;
+        }
+
+        while(count < max && !queued_motions.empty()) {
+            //Read from SPI_LINK: [status, sequence number]
+            uint16_t receive_buffer[2];
+            receive_buffer[0] = 0;
+            receive_buffer[1] = 0;
+            spi_transfer(SPI_CHANNEL, (uint8_t*) &receive_buffer[0], 4);
+            if(receive_buffer[0] == DONE && is_awaited_motion(receive_buffer[1])) {
+                keep_done(receive_buffer[1]);
+                continue;
+            }
+            if(receive_buffer[0] != DONE || !is_queued_motion(receive_buffer[1])) break;
+
+            send_word(DONE);
+            forget_queued_motion(receive_buffer[1]);
+            finished[count++] = receive_buffer[1];
         }
 
-        //remove temporary buffer
-        delete[] recbuf;
+        return count;
     }
-	void pic_read_photosensecube(uint16_t* buffer, uint16_t length, uint16_t clear) {
-        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
-        //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNSCBE, length, clear,0);
 
-        write_SPI_read_wait_DONE(&send_buffer[0], &buffer[0], length);
+    //Whether a motion queued without stalling has neither finished nor been discarded
+    bool pic_motion_pending(uint16_t sequence) {
+        std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+        return is_queued_motion(sequence);
     }
-	void pic_read_photosensefront(uint16_t* buffer, uint16_t length, uint16_t clear) {
-        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
-        //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_PSNSFNT, length, clear,0);
 
-        write_SPI_read_wait_DONE(&send_buffer[0], &buffer[0], length);
+    //Stop following a motion queued without stalling, whether or not its DONE has come
+    void pic_forget_motion(uint16_t sequence) {
+        std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+        forget_queued_motion(sequence);
+        std::deque<uint16_t>::iterator motion = std::find(completed_motions.begin(), completed_motions.end(), sequence);
+        if(motion != completed_motions.end()) completed_motions.erase(motion);
     }
 
-//LED------------------------------------------------------------------------
 
-	void pic_write_led(led_t mode, uint16_t period) {
+    //Stop at once and discard the motions queued by pic_write_state without stalling. DONEs
+    //for discarded motions are never sent.
+    void pic_flush_motions() {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) WRITE_LED, (uint16_t) mode, period,0);
+        fill_buffer(&send_buffer[0], (uint16_t) FLUSH_MOTIONS, 0, 0,0);
 
         //write command
-        write_SPI_wait_DONE(&send_buffer[0]); 	
-	}
+        write_SPI_wait_DONE(&send_buffer[0]);
 
-//Rooms-------------------------------------------------------------------------
+        std::lock_guard<std::mutex> bus_lock(spi_bus_mutex);
+        queued_motions.clear();
+        completed_motions.clear();
+    }
 
 
-    ERoom pic_read_roomtype() {
+//BATCHES-------------------------------------------------------------------------
+
+    void pic_write_batch(const uint16_t* commands, uint16_t count, uint16_t* results, uint16_t result_length) {
+        if(count == 0) return;
+
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
+        fill_buffer(&send_buffer[0], (uint16_t) BATCH, count, result_length, 0);
 
-        //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) READ_ROOM, 0, 0,0);
+        //the commands, then their CRC
+        std::vector<uint8_t> payload(8*count + 2);
+        for(int i=0;i<count;i++) {
+            fill_command(&payload[8*i], commands[4*i], commands[4*i+1], commands[4*i+2], commands[4*i+3]);
+        }
+        uint16_t crc = spi_crc16(payload.data(), 8*count);
+        payload[8*count] = (uint8_t) (crc >> 8);
+        payload[8*count+1] = (uint8_t) (crc & 0x00FF);
 
-        uint16_t result;
-        write_SPI_read_wait_DONE(&send_buffer[0], &result, 1);
+        transact(&send_buffer[0], payload.data(), payload.size(), results, result_length, wait_policy.command_timeout_us, DATA, DONE);
+    }
 
-        return (ERoom) result;   
+
+//ROUTES--------------------------------------------------------------------------
+
+    //16-bit sum of the route words, sent in the header so the PIC can check the payload
+    uint16_t route_checksum(const uint16_t* program, uint16_t length) {
+        uint16_t sum = 0;
+        for(int i=0;i<length;i++) sum += program[i];
+        return sum;
     }
 
+    //Send a whole route program in one transfer. Returns false if the PIC rejected it.
+    bool pic_write_route(const uint16_t* program, uint16_t length) {
+        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
-//STATES--------------------------------------------------------------------------
+        //header first
+        fill_buffer(&send_buffer[0], (uint16_t) WRITE_ROUTE, length, route_checksum(program, length), 0);
 
-    void pic_write_state(state_t state, condition_t termination, uint16_t termination_val, char stall) {
+        //then the route words, MSB first as the command words
+        std::vector<uint8_t> payload(2*length);
+        for(int i=0;i<length;i++) {
+            payload[2*i] = (uint8_t) (program[i] >> 8);
+            payload[2*i+1] = (uint8_t) (program[i] & 0x00FF);
+        }
+
+        //Wait for the PIC to accept (DONE) or reject the route
+        return transact(&send_buffer[0], payload.data(), payload.size(), nullptr, 0, wait_policy.command_timeout_us, DONE, REJECT) == DONE;
+    }
+
+    route_status_t pic_read_route_progress(uint16_t* completed) {
         uint8_t send_buffer[16]; //for 16-bits = 8 bytes
 
         //command word first
-        fill_buffer(&send_buffer[0], (uint16_t) state, (uint16_t) termination, termination_val,0);
+        fill_buffer(&send_buffer[0], (uint16_t) READ_ROUTE_PROGRESS, 2, 0,0);
 
-        if(stall) {
-            write_SPI_stall_DONE(&send_buffer[0]);
-        } else {
-            write_SPI(&send_buffer[0]);
-        }
-    }
\ No newline at end of file
+        uint16_t result[2];
+        write_SPI_read_wait_DONE(&send_buffer[0], &result[0], 2);
+
+        *completed = result[1];
+        return (route_status_t) result[0];
+    }
+
+    void pic_abort_route() {
+        uint8_t send_buffer[16]; //for 16-bits = 8 bytes
+
+        //command word first
+        fill_buffer(&send_buffer[0], (uint16_t) ABORT_ROUTE, 0, 0,0);
+
+        //write command
+        write_SPI_wait_DONE(&send_buffer[0]);
+    }
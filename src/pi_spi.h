@@ -14,8 +14,125 @@
 
 //SPI-------------------------------------------------------------------------
 
+//Words sent by the PIC during the handshake. Each is sent as [word, sequence number of the frame it
+//answers], and the Pi ends with DONE (or RESEND, to have the reply sent again).
+const uint16_t DONE = 0xFFFE;
+const uint16_t DATA = 0xFFFD;
+const uint16_t REJECT = 0xFFFC;
+const uint16_t RESEND = 0xFFFB;		//The frame (or reply) was corrupted: send it again
+const uint16_t QUEUED = 0xFFFA;		//A motion sent without stalling has been queued
+
+//Frames are checked: the last two words of every command frame are its sequence number and the
+//CRC of the rest, and data replies end with [sequence number, CRC]. Corrupted frames are sent again
+//and corrupted replies asked for again; a frame sent again after a timeout keeps its sequence
+//number, so the PIC repeats its reply rather than carrying out the command twice.
+uint16_t spi_crc16(const uint8_t* data, uint32_t length);
+
+class CSPITransport;
+
+//Opens the link and starts a session (sequence numbers from 1, no motions queued)
 void init_spi();
 
+//The transport used for every SPI transfer (wiringPi unless replaced, e.g. by a PIC emulator for
+//testing). Passing nullptr restores wiringPi.
+void set_spi_transport(CSPITransport* transport);
+CSPITransport* get_spi_transport();
+
+//WAITING---------------------------------------------------------------------
+
+//How the Pi waits for the PIC to answer. It polls spin_polls times back to back, then waits on the
+//transport's ready line if it has one, or else sleeps between polls, starting at min_sleep_us and
+//doubling up to max_sleep_us. Commands time out after command_timeout_us, and motions (stalled
+//states and Wait_Done) after motion_timeout_us, since they take as long as the robot takes to
+//drive. A timeout of 0 waits for ever. Each timeout or corrupted frame is retried, up to
+//max_retries times per command.
+typedef struct {
+	uint32_t spin_polls;
+	uint32_t min_sleep_us;
+	uint32_t max_sleep_us;
+	uint32_t command_timeout_us;
+	uint32_t motion_timeout_us;
+	uint32_t max_retries;
+} spi_wait_policy_t;
+
+void set_spi_wait_policy(const spi_wait_policy_t& policy);
+spi_wait_policy_t get_spi_wait_policy();
+
+//Latency of each command, from sending it to reading the PIC's last word. The DONEs of motions
+//queued without stalling are recorded under SPI_QUEUED_MOTION.
+typedef struct {
+	uint32_t count;
+	uint32_t timeouts;
+	uint64_t polls;		//Reads made while waiting
+	uint32_t retries;	//Frames sent again and replies asked for again
+	uint32_t crc_errors;	//Frames the PIC could not read, and replies the Pi could not
+	double total_us;
+	double max_us;
+} spi_latency_stats_t;
+
+const uint16_t SPI_QUEUED_MOTION = 0x00;
+
+spi_latency_stats_t get_spi_latency_stats(uint16_t command);
+void reset_spi_latency_stats();
+
+//Tracing of every transaction, off until spi_trace_enable. Each transaction is recorded in a ring
+//of the last capacity records, and its time added to a histogram for its command. The ring and
+//histograms are allocated when tracing is enabled, so recording costs well under 1us.
+typedef struct {
+	uint64_t start_ns;		//CLOCK_MONOTONIC, when the command was sent
+	uint32_t duration_ns;	//Until the PIC's last word was read
+	uint32_t bytes;			//Transferred (each way, since SPI is full duplex)
+	uint32_t polls;			//Reads made while waiting
+	uint16_t command;		//SPI_QUEUED_MOTION for Wait_Done
+	uint16_t sequence;		//Of the frame, or of the motion waited for
+	uint16_t retries;
+	uint8_t crc_errors;
+	uint8_t timed_out;
+	uint8_t reserved[4];
+} spi_trace_record_t;
+
+//HDR-style histogram of latencies (ns): exact below 2^SPI_HISTOGRAM_SUB_BITS, then each power of two
+//split into 2^SPI_HISTOGRAM_SUB_BITS buckets (to within 6.25%), up to about 68s
+#define SPI_HISTOGRAM_SUB_BITS 4
+#define SPI_HISTOGRAM_BUCKETS (16 + 32*16)
+typedef struct {
+	uint64_t count;
+	uint64_t min_ns;
+	uint64_t max_ns;
+	uint32_t buckets[SPI_HISTOGRAM_BUCKETS];
+} spi_latency_histogram_t;
+
+//A trace file is this header followed by count records, in the Pi's byte order
+#define SPI_TRACE_VERSION 1
+typedef struct {
+	char magic[4];			//"SPIT"
+	uint16_t version;
+	uint16_t record_size;
+	uint32_t count;			//Records in the file (the newest, oldest first)
+	uint64_t recorded;		//Transactions recorded since tracing was enabled
+} spi_trace_header_t;
+
+void spi_trace_enable(uint32_t capacity);	//Also clears the records and histograms
+void spi_trace_disable();
+uint64_t spi_trace_count();
+uint32_t spi_trace_records(spi_trace_record_t* records, uint32_t max);	//The newest, oldest first
+spi_latency_histogram_t get_spi_latency_histogram(uint16_t command);
+uint64_t spi_histogram_percentile(const spi_latency_histogram_t& histogram, double percentile);
+bool spi_trace_dump(const char* path);
+
+//Thrown when the PIC does not answer within the timeout (after the retries), e.g. because the link
+//is down
+struct Exception_SPITimeout
+{
+	uint16_t mm_command;
+	double mm_waited_us;
+	uint32_t mm_polls;
+	Exception_SPITimeout(uint16_t command, double waited_us, uint32_t polls)
+			: mm_command { command }, mm_waited_us { waited_us }, mm_polls { polls }
+	{
+	}
+};
+
 //GRABBER---------------------------------------------------------------------
 
 	typedef enum {
@@ -50,6 +167,8 @@ void init_spi();
 
 //photosensors-----------------------------------------------------------------
 
+	//Photosensors 3-6 give levels from 0 to 1 (the 10-bit samples divided by 1024), the others the
+	//raw samples. Nothing is allocated per read.
 	void pic_read_photosense1(uint16_t* buffer, uint16_t length, uint16_t clear);
 	void pic_read_photosense2(uint16_t* buffer, uint16_t length, uint16_t clear);
 	void pic_read_photosense3(float* buffer, uint16_t length, uint16_t clear);
@@ -59,6 +178,9 @@ void init_spi();
 	void pic_read_photosensecube(uint16_t* buffer, uint16_t length, uint16_t clear);
 	void pic_read_photosensefront(uint16_t* buffer, uint16_t length, uint16_t clear);
 
+	//Scale samples to levels as pic_read_photosense3-6 do (with NEON or SSE2 where available)
+	void photosense_to_levels(const uint16_t* samples, float* levels, uint32_t length);
+
 //LED------------------------------------------------------------------------
 
 	typedef enum {
@@ -77,4 +199,45 @@ void init_spi();
 
 	void pic_write_state(state_t state, condition_t termination, uint16_t termination_val, char stall);
 	void Wait_Done();
+	void pic_flush_motions();
+
+	//Motions queued without stalling can be followed one by one instead of with Wait_Done (use
+	//one or the other): pic_write_state_async returns the sequence number the motion's DONE will
+	//carry, pic_poll_motions collects the DONEs which have come without waiting for any, and a
+	//motion no longer pending which was not collected was discarded (by STOPPED or a flush).
+	//pic_forget_motion stops following a motion which has been given up on (e.g. timed out), so
+	//that it is no longer pending and its DONE, if it comes, is ignored. See CMotionPoller.
+	uint16_t pic_write_state_async(state_t state, condition_t termination, uint16_t termination_val);
+	uint32_t pic_poll_motions(uint16_t* finished, uint32_t max);
+	bool pic_motion_pending(uint16_t sequence);
+	void pic_forget_motion(uint16_t sequence);
+
+//SENSOR FRAMES--------------------------------------------------------------
+
+	//All the sensors, sampled on the same PIC tick. The photosensors are the raw 10-bit ADC
+	//values, in the order of their READ_ commands (pic_read_photosense3-6 divide theirs by 1024).
+	typedef struct {
+		uint16_t sequence;			//Counts up by one per frame, so a missed frame can be spotted
+		uint32_t timestamp_us;		//PIC time the sensors were sampled
+		int16_t encoder_left;
+		int16_t encoder_right;
+		uint16_t compass;
+		uint16_t photosensors[8];
+	} sensor_frame_t;
+
+	void pic_read_sensor_frame(sensor_frame_t* frame, uint16_t reset_encoders);
+
+//BATCHES--------------------------------------------------------------------
+
+	//Send count commands (4 words each, as the command frames) in one transaction, and read
+	//result_length words of results back. See CCommandBatch.
+	void pic_write_batch(const uint16_t* commands, uint16_t count, uint16_t* results, uint16_t result_length);
+
+//ROUTES---------------------------------------------------------------------
+
+	//Route commands
+	uint16_t route_checksum(const uint16_t* program, uint16_t length);
+	bool pic_write_route(const uint16_t* program, uint16_t length);
+	route_status_t pic_read_route_progress(uint16_t* completed);
+	void pic_abort_route();
 #endif
@@ -12,6 +12,15 @@
 
 /////////////////////////////////////DEFINES////////////////////////////////////
 
+//Number of motions the PIC holds: the one being driven, plus those queued behind it
+#define PIC_MOTION_QUEUE_LENGTH 3
+
+//Most commands in one BATCH
+#define PIC_BATCH_LENGTH 8
+
+//Words in the reply to READ_SENSOR_FRAME
+#define SENSOR_FRAME_WORDS 14
+
 //////////////////////////////////GLOBAL VARIABLES//////////////////////////////
 
 //Enumerated Type for various states
@@ -92,9 +101,48 @@ typedef enum {
     READ_DIP = 0x16,
 
     //Read room type,
-    READ_ROOM = 0x17
+    READ_ROOM = 0x17,
+
+    //Route programs
+    WRITE_ROUTE = 0x18,          //Header [WRITE_ROUTE, length, checksum], then length route words
+    READ_ROUTE_PROGRESS = 0x19,  //Returns [route_status_t, route words completed]
+    ABORT_ROUTE = 0x1A,          //Stop the route at once
+
+    //Queued motions (states sent without stalling, with arg 3 set). The PIC answers QUEUED at
+    //once, drives them in order and sends one DONE as each finishes (carrying the sequence number
+    //of its frame), so the next can start without stopping.
+    FLUSH_MOTIONS = 0x1B,        //Stop at once, discarding queued motions and their unread DONEs
+
+    //Batches of commands in one transaction. The header frame holds [BATCH, commands, result
+    //words, 0]; the commands follow in one transfer, 4 words each, then their CRC. The PIC runs
+    //them in order and replies with DATA and all their results, then DONE (or just DONE if none of
+    //them has a result).
+    BATCH = 0x1C,
+
+    //Every sensor sampled on the same PIC tick, in one reply of SENSOR_FRAME_WORDS words:
+    //[sequence, timestamp (us, high word), timestamp (low word), encoder 1 sum, encoder 2 sum,
+    //compass, PSNS1-6, PSNSFNT, PSNSCBE]. The photosensors give their latest sample, which is not
+    //used up. Arg 1 resets the encoders after they are read.
+    READ_SENSOR_FRAME = 0x1D
 } command_t;
 
+//Route program words: the opcode is in the top 4 bits and the argument (distance in encoder
+//counts, for forward moves) in the bottom 12 bits
+typedef enum {
+    ROUTE_FORWARD       = 0x1, //Forward drive with the photosensors (as PSNS_FORWARD)
+    ROUTE_FORWARD_WATCH = 0x2, //Forward drive with the encoders, watching for junctions (as ECDR_FORWARD)
+    ROUTE_LEFT          = 0x3, //Left turn (90) on the spot (as COMP_LEFT)
+    ROUTE_RIGHT         = 0x4  //Right turn (90) on the spot (as COMP_RIGHT)
+} route_op_t;
+
+typedef enum {
+    ROUTE_IDLE      = 0x00, //No route has been sent
+    ROUTE_RUNNING   = 0x01, //Driving the route
+    ROUTE_COMPLETE  = 0x02, //Finished the route
+    ROUTE_ABORTED   = 0x03, //Stopped by ABORT_ROUTE
+    ROUTE_REJECTED  = 0x04  //The route failed its checksum and was not driven
+} route_status_t;
+
 typedef enum {
     TIME, DISTANCE, JUNCTION, NONE
 } condition_t;